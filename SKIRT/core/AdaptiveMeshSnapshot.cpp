@@ -12,6 +12,7 @@
 #include "StringUtils.hpp"
 #include "TextInFile.hpp"
 #include "Units.hpp"
+#include <functional>
 
 ////////////////////////////////////////////////////////////////////
 
@@ -27,8 +28,12 @@ namespace AdaptiveMesh_Private
         /* The constructor receives the node's extent, and reads the other node data from the
            following line in the specified input file. It then recursively constructs any child
            nodes. In addition to constructing the new node(s), the constructor also adds leaf node
-           pointers to the vector held by the AdaptiveMeshSnapshot class. */
-        Node(const Box& extent, TextInFile* infile, vector<Node*>& leafnodes) : Box(extent)
+           pointers to the vector held by the AdaptiveMeshSnapshot class, and passes the user
+           properties read for each leaf node to the specified storage function, so that the
+           storage index of these properties equals the index of the leaf node in that vector. */
+        Node(const Box& extent, TextInFile* infile, vector<Node*>& leafnodes,
+             const std::function<void(const Array&)>& storeProperties)
+            : Box(extent)
         {
             // if this is a nonleaf line, process it
             if (infile->readNonLeaf(_Nx, _Ny, _Nz))
@@ -44,7 +49,7 @@ namespace AdaptiveMesh_Private
                         {
                             Vec r0 = extent.fracPos(i, j, k, _Nx, _Ny, _Nz);
                             Vec r1 = extent.fracPos(i + 1, j + 1, k + 1, _Nx, _Ny, _Nz);
-                            _nodes[m++] = new Node(Box(r0, r1), infile, leafnodes);
+                            _nodes[m++] = new Node(Box(r0, r1), infile, leafnodes, storeProperties);
                         }
             }
 
@@ -56,8 +61,10 @@ namespace AdaptiveMesh_Private
                 _Nz = 0;
 
                 // read a leaf line and detect premature end-of file
-                if (!infile->readRow(_properties))
+                Array properties;
+                if (!infile->readRow(properties))
                     throw FATALERROR("Reached end of file in adaptive mesh data before all nodes were read");
+                storeProperties(properties);
 
                 // add this leaf node to the list
                 _m = leafnodes.size();
@@ -167,15 +174,10 @@ namespace AdaptiveMesh_Private
                 return nullptr;
         }
 
-        /* This function returns the user properties for leaf nodes; for nonleaf nodes the
-           returned array is empty. */
-        const Array& properties() { return _properties; }
-
     private:
         int _Nx, _Ny, _Nz;  // number of grid cells in each direction; zero for leaf nodes
         int _m;             // Morton order index for the cell represented by this leaf node; -1 for nonleaf nodes
         vector<const Node*> _nodes;  // pointers to children (nonleaf nodes) or neighbors (leaf nodes)
-        Array _properties;           // user-defined properties
     };
 }
 
@@ -198,12 +200,13 @@ void AdaptiveMeshSnapshot::readAndClose()
 {
     // construct the root node, and recursively all other nodes;
     // this also fills the _cells vector
-    _root = new Node(_extent, infile(), _cells);
+    _root = new Node(_extent, infile(), _cells, [this](const Array& row) { storeProperties(row); });
 
     // verify that all data was read and close the file
     Array dummy;
     if (infile()->readRow(dummy)) throw FATALERROR("Superfluous lines in adaptive mesh data after all nodes were read");
     Snapshot::readAndClose();
+    finishStoringProperties();
 
     // log nr of cells
     log()->info("  Number of leaf cells: " + std::to_string(_cells.size()));
@@ -228,17 +231,15 @@ void AdaptiveMeshSnapshot::readAndClose()
         int numIgnored = 0;
         for (size_t m = 0; m != n; ++m)
         {
-            const Array& prop = _cells[m]->properties();
-
             // original mass is zero if temperature is above cutoff or if imported mass/density is not positive
             double originalMass = 0.;
-            if (maxT && prop[temperatureIndex()] > maxT)
+            if (maxT && property(m, temperatureIndex()) > maxT)
                 numIgnored++;
             else
-                originalMass =
-                    max(0., massIndex() >= 0 ? prop[massIndex()] : prop[densityIndex()] * _cells[m]->volume());
+                originalMass = max(0., massIndex() >= 0 ? property(m, massIndex())
+                                                         : property(m, densityIndex()) * _cells[m]->volume());
 
-            double metallicMass = originalMass * (metallicityIndex() >= 0 ? prop[metallicityIndex()] : 1.);
+            double metallicMass = originalMass * (metallicityIndex() >= 0 ? property(m, metallicityIndex()) : 1.);
             double effectiveMass = metallicMass * multiplier();
 
             Mv[m] = effectiveMass;
@@ -327,8 +328,7 @@ Box AdaptiveMeshSnapshot::extent(int m) const
 
 Vec AdaptiveMeshSnapshot::velocity(int m) const
 {
-    const Array& prop = _cells[m]->properties();
-    return Vec(prop[velocityIndex() + 0], prop[velocityIndex() + 1], prop[velocityIndex() + 2]);
+    return Vec(property(m, velocityIndex() + 0), property(m, velocityIndex() + 1), property(m, velocityIndex() + 2));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -343,8 +343,7 @@ Vec AdaptiveMeshSnapshot::velocity(Position bfr) const
 
 double AdaptiveMeshSnapshot::velocityDispersion(int m) const
 {
-    const Array& prop = _cells[m]->properties();
-    return prop[velocityDispersionIndex()];
+    return property(m, velocityDispersionIndex());
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -359,8 +358,8 @@ double AdaptiveMeshSnapshot::velocityDispersion(Position bfr) const
 
 Vec AdaptiveMeshSnapshot::magneticField(int m) const
 {
-    const Array& prop = _cells[m]->properties();
-    return Vec(prop[magneticFieldIndex() + 0], prop[magneticFieldIndex() + 1], prop[magneticFieldIndex() + 2]);
+    return Vec(property(m, magneticFieldIndex() + 0), property(m, magneticFieldIndex() + 1),
+               property(m, magneticFieldIndex() + 2));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -377,8 +376,7 @@ void AdaptiveMeshSnapshot::parameters(int m, Array& params) const
 {
     int n = numParameters();
     params.resize(n);
-    const Array& prop = _cells[m]->properties();
-    for (int i = 0; i != n; ++i) params[i] = prop[parametersIndex() + i];
+    for (int i = 0; i != n; ++i) params[i] = property(m, parametersIndex() + i);
 }
 
 ////////////////////////////////////////////////////////////////////
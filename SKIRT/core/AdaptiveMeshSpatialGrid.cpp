@@ -68,6 +68,13 @@ double AdaptiveMeshSpatialGrid::diagonal(int m) const
 
 //////////////////////////////////////////////////////////////////////
 
+bool AdaptiveMeshSpatialGrid::hasCuboidalCells() const
+{
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
 int AdaptiveMeshSpatialGrid::cellIndex(Position bfr) const
 {
     return _mesh->cellIndex(bfr);
@@ -51,6 +51,10 @@ public:
     /** This function returns the diagonal of the cell with index \f$m\f$. */
     double diagonal(int m) const override;
 
+    /** This function returns true because all cells in this grid are cuboids aligned with the
+        coordinate axes. */
+    bool hasCuboidalCells() const override;
+
     /** This function returns the index \f$m\f$ of the cell that contains the position
         \f${\bf{r}}\f$. */
     int cellIndex(Position bfr) const override;
@@ -15,6 +15,7 @@ void BlackBodySED::setupSelfBefore()
 
     _planck = new PlanckFunction(temperature());
     _Ltot = _planck->cdf(_lambdav, _pv, _Pv, normalizationWavelengthRange());
+    _alias.initialize(_Pv);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -59,7 +60,7 @@ double BlackBodySED::integratedLuminosity(const Range& wavelengthRange) const
 
 double BlackBodySED::generateWavelength() const
 {
-    return random()->cdfLogLog(_lambdav, _pv, _Pv);
+    return random()->cdfLogLog(_lambdav, _pv, _Pv, _alias);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -6,6 +6,7 @@
 #ifndef BLACKBODYSED_HPP
 #define BLACKBODYSED_HPP
 
+#include "AliasTable.hpp"
 #include "Array.hpp"
 #include "SED.hpp"
 class PlanckFunction;
@@ -73,6 +74,7 @@ private:
     Array _lambdav;
     Array _pv;
     Array _Pv;
+    AliasTable _alias;
     double _Ltot{0};
 };
 
@@ -25,6 +25,13 @@ Range BlackBodySEDFamily::intrinsicWavelengthRange() const
 
 ////////////////////////////////////////////////////////////////////
 
+double BlackBodySEDFamily::luminosityScalingPower() const
+{
+    return 2.;
+}
+
+////////////////////////////////////////////////////////////////////
+
 double BlackBodySEDFamily::specificLuminosity(double wavelength, const Array& parameters) const
 {
     double R = parameters[0];
@@ -42,6 +42,10 @@ public:
         including all representable positive floating point values. */
     Range intrinsicWavelengthRange() const override;
 
+    /** This function returns 2 because the luminosity of a black body scales with the square of
+        its radius. */
+    double luminosityScalingPower() const override;
+
     /** This function returns the specific luminosity \f$L_\lambda\f$ (i.e. radiative power per
         unit of wavelength) for the %SED with the specified parameters at the specified wavelength,
         or zero if the wavelength is outside of the %SED's intrinsic wavelength range. The number
@@ -50,6 +50,13 @@ double CartesianSpatialGrid::diagonal(int m) const
 
 //////////////////////////////////////////////////////////////////////
 
+bool CartesianSpatialGrid::hasCuboidalCells() const
+{
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
 int CartesianSpatialGrid::cellIndex(Position bfr) const
 {
     int i = NR::locateFail(_xv, bfr.x());
@@ -55,6 +55,10 @@ public:
         (y_{j+1}-y_j)^2 + (z_{k+1}-z_k)^2 }\f$. */
     double diagonal(int m) const override;
 
+    /** This function returns true because all cells in this grid are cuboids aligned with the
+        coordinate axes. */
+    bool hasCuboidalCells() const override;
+
     /** This function returns the index \f$m\f$ of the cell that contains the position
         \f${\bf{r}}\f$. For a cartesian grid, the function determines the bin indices in the X, Y
         and Z directions and calculates the correct index based on these indices. */
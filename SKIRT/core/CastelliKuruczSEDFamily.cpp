@@ -42,6 +42,13 @@ Range CastelliKuruczSEDFamily::intrinsicWavelengthRange() const
 
 ////////////////////////////////////////////////////////////////////
 
+double CastelliKuruczSEDFamily::luminosityScalingPower() const
+{
+    return 2.;
+}
+
+////////////////////////////////////////////////////////////////////
+
 namespace
 {
     // force the gravity value inside the valid portion of the grid depending on the temperature
@@ -0,0 +1,127 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#include "CheckpointInFile.hpp"
+#include "FatalError.hpp"
+#include "System.hpp"
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    // the size of the items in the checkpoint file format
+    const size_t itemSize = 8;
+
+    // the tag and the byte order verification value at the start of a checkpoint file
+    const char* checkpointTag = "SKIRT R\n";
+    const size_t checkpointEndianness = 0x010203040A0BFEFF;
+}
+
+////////////////////////////////////////////////////////////////////
+
+CheckpointInFile::CheckpointInFile(string filepath) : _filepath(filepath)
+{
+    _in = System::ifstream(_filepath);
+    if (!_in) throw FATALERROR("Could not open the checkpoint file " + _filepath);
+
+    char tag[itemSize];
+    size_t endianness = 0;
+    _in.read(tag, itemSize);
+    _in.read(reinterpret_cast<char*>(&endianness), itemSize);
+    if (!_in || memcmp(tag, checkpointTag, itemSize) || endianness != checkpointEndianness)
+        throw FATALERROR("File does not have checkpoint format: " + _filepath);
+}
+
+////////////////////////////////////////////////////////////////////
+
+double CheckpointInFile::read(string label)
+{
+    double value = 0.;
+    readValues(readRecordHeader(label, 1), &value, 1);
+    return value;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointInFile::read(string label, Array& values)
+{
+    readValues(readRecordHeader(label, values.size()), begin(values), values.size());
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointInFile::read(string label, vector<float>& values)
+{
+    readValues(readRecordHeader(label, values.size()), values.data(), values.size());
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointInFile::close()
+{
+    if (_in.is_open()) _in.close();
+}
+
+////////////////////////////////////////////////////////////////////
+
+size_t CheckpointInFile::readRecordHeader(string label, size_t numValues)
+{
+    // read the label
+    size_t length = 0;
+    readBytes(reinterpret_cast<char*>(&length), itemSize);
+    string fileLabel;
+    if (_in && length < 1024)
+    {
+        fileLabel.resize(length);
+        readBytes(&fileLabel[0], length);
+    }
+
+    // read the value size and the number of values
+    size_t valueSize = 0;
+    size_t fileNumValues = 0;
+    readBytes(reinterpret_cast<char*>(&valueSize), itemSize);
+    readBytes(reinterpret_cast<char*>(&fileNumValues), itemSize);
+
+    // verify the header
+    if (!_in || fileLabel != label || fileNumValues != numValues
+        || (valueSize != sizeof(double) && valueSize != sizeof(float)))
+        throw FATALERROR("Checkpoint record '" + label + "' in file " + _filepath + " does not match the simulation");
+    return valueSize;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointInFile::readBytes(char* bytes, size_t numBytes)
+{
+    _in.read(bytes, numBytes);
+    _in.ignore((itemSize - numBytes % itemSize) % itemSize);
+}
+
+////////////////////////////////////////////////////////////////////
+
+template<class T> void CheckpointInFile::readValues(size_t valueSize, T* values, size_t numValues)
+{
+    // read values of the same type directly, otherwise convert them through a buffer
+    if (valueSize == sizeof(T))
+    {
+        readBytes(reinterpret_cast<char*>(values), numValues * sizeof(T));
+    }
+    else if (valueSize == sizeof(double))
+    {
+        vector<double> buffer(numValues);
+        readBytes(reinterpret_cast<char*>(buffer.data()), numValues * sizeof(double));
+        for (size_t i = 0; i != numValues; ++i) values[i] = buffer[i];
+    }
+    else
+    {
+        vector<float> buffer(numValues);
+        readBytes(reinterpret_cast<char*>(buffer.data()), numValues * sizeof(float));
+        for (size_t i = 0; i != numValues; ++i) values[i] = buffer[i];
+    }
+    if (!_in) throw FATALERROR("Could not read the checkpoint file " + _filepath);
+}
+
+////////////////////////////////////////////////////////////////////
@@ -0,0 +1,59 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#ifndef CHECKPOINTINFILE_HPP
+#define CHECKPOINTINFILE_HPP
+
+#include "Array.hpp"
+#include <fstream>
+
+////////////////////////////////////////////////////////////////////
+
+/** The CheckpointInFile class reads the state of a simulation from a binary checkpoint file
+    written by the CheckpointOutFile class; refer to that class for a description of the file
+    format. The records must be read in the order in which they were written. Each read function
+    verifies that the label of the next record in the file matches the specified label, and that
+    the record holds the expected number of values. If this is not the case, the function throws a
+    fatal error indicating that the checkpoint does not match the simulation. Values are converted
+    between single and double precision as needed. */
+class CheckpointInFile
+{
+public:
+    /** The constructor opens the checkpoint file with the specified path and verifies the file
+        header. */
+    explicit CheckpointInFile(string filepath);
+
+    /** This function reads a record with the specified label holding a single value, and returns
+        that value. */
+    double read(string label);
+
+    /** This function reads a record with the specified label into the specified array. The number
+        of values in the record must equal the size of the array. */
+    void read(string label, Array& values);
+
+    /** This function reads a record with the specified label into the specified vector. The number
+        of values in the record must equal the size of the vector. */
+    void read(string label, vector<float>& values);
+
+    /** This function closes the file. */
+    void close();
+
+private:
+    // reads the header of the next record, verifies the label and number of values, and returns the value size
+    size_t readRecordHeader(string label, size_t numValues);
+
+    // reads the specified number of bytes and skips the padding to a multiple of 8 bytes
+    void readBytes(char* bytes, size_t numBytes);
+
+    // reads values of the type indicated by the value size and converts them to the requested type
+    template<class T> void readValues(size_t valueSize, T* values, size_t numValues);
+
+    string _filepath;    // the path of the checkpoint file
+    std::ifstream _in;   // the input stream
+};
+
+////////////////////////////////////////////////////////////////////
+
+#endif
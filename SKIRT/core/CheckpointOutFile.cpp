@@ -0,0 +1,122 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#include "CheckpointOutFile.hpp"
+#include "FatalError.hpp"
+#include "System.hpp"
+#include <cstdio>
+
+////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    // the size of the items in the checkpoint file format
+    const size_t itemSize = 8;
+
+    static_assert((sizeof(size_t) == itemSize) & (sizeof(double) == itemSize),
+                  "Cannot properly represent items in checkpoint file format");
+
+    // the tag and the byte order verification value at the start of a checkpoint file
+    const char* checkpointTag = "SKIRT R\n";
+    const size_t checkpointEndianness = 0x010203040A0BFEFF;
+}
+
+////////////////////////////////////////////////////////////////////
+
+CheckpointOutFile::CheckpointOutFile(string filepath) : _filepath(filepath), _tempFilepath(filepath + ".tmp")
+{
+    _out = System::ofstream(_tempFilepath);
+    if (!_out) throw FATALERROR("Could not open the checkpoint file " + _tempFilepath);
+
+    writeBytes(checkpointTag, itemSize);
+    writeBytes(reinterpret_cast<const char*>(&checkpointEndianness), itemSize);
+}
+
+////////////////////////////////////////////////////////////////////
+
+CheckpointOutFile::~CheckpointOutFile()
+{
+    if (!_closed)
+    {
+        if (_out.is_open()) _out.close();
+        System::removeFile(_tempFilepath);
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointOutFile::write(string label, double value)
+{
+    writeRecordHeader(label, sizeof(double), 1);
+    writeBytes(reinterpret_cast<const char*>(&value), sizeof(double));
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointOutFile::write(string label, const Array& values)
+{
+    writeRecordHeader(label, sizeof(double), values.size());
+    writeBytes(reinterpret_cast<const char*>(begin(values)), values.size() * sizeof(double));
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointOutFile::write(string label, const vector<float>& values)
+{
+    writeRecordHeader(label, sizeof(float), values.size());
+    writeBytes(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointOutFile::close()
+{
+    if (_closed) return;
+
+    _out.close();
+    if (!_out) throw FATALERROR("Could not write the checkpoint file " + _tempFilepath);
+
+    // on some systems, renaming fails if the target file already exists; in that case, move the previous
+    // checkpoint aside rather than removing it, so that it stays intact until the new one is in place
+    if (std::rename(_tempFilepath.c_str(), _filepath.c_str()))
+    {
+        string oldFilepath = _filepath + ".old";
+        System::removeFile(oldFilepath);
+        if (std::rename(_filepath.c_str(), oldFilepath.c_str()))
+            throw FATALERROR("Could not rename the checkpoint file " + _filepath + " to " + oldFilepath);
+        if (std::rename(_tempFilepath.c_str(), _filepath.c_str()))
+        {
+            std::rename(oldFilepath.c_str(), _filepath.c_str());
+            throw FATALERROR("Could not rename the checkpoint file " + _tempFilepath + " to " + _filepath);
+        }
+        System::removeFile(oldFilepath);
+    }
+    _closed = true;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointOutFile::writeRecordHeader(string label, size_t valueSize, size_t numValues)
+{
+    size_t length = label.size();
+    writeBytes(reinterpret_cast<const char*>(&length), itemSize);
+    label.resize((length + itemSize - 1) / itemSize * itemSize, ' ');
+    writeBytes(label.c_str(), label.size());
+    writeBytes(reinterpret_cast<const char*>(&valueSize), itemSize);
+    writeBytes(reinterpret_cast<const char*>(&numValues), itemSize);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void CheckpointOutFile::writeBytes(const char* bytes, size_t numBytes)
+{
+    _out.write(bytes, numBytes);
+    size_t padding = (itemSize - numBytes % itemSize) % itemSize;
+    for (size_t i = 0; i != padding; ++i) _out.put(0);
+    if (!_out) throw FATALERROR("Could not write the checkpoint file " + _tempFilepath);
+    _numBytes += numBytes + padding;
+}
+
+////////////////////////////////////////////////////////////////////
@@ -0,0 +1,76 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#ifndef CHECKPOINTOUTFILE_HPP
+#define CHECKPOINTOUTFILE_HPP
+
+#include "Array.hpp"
+#include <fstream>
+
+////////////////////////////////////////////////////////////////////
+
+/** The CheckpointOutFile class writes the state of a simulation to a binary checkpoint file, so
+    that the simulation can later be resumed from that state using the CheckpointInFile class. The
+    file consists of a sequence of labeled records, each holding a list of double or single
+    precision floating point values. The reader verifies that the labels and the number of values
+    in the records match the expected state, so that a checkpoint file is never applied to a
+    simulation with a different configuration.
+
+    The binary format uses 8-byte items in the native byte order, in the same spirit as the binary
+    column format described for the TextInFile class. The file starts with a tag and a byte order
+    verification value. Each record then consists of the label (its length followed by the
+    characters, padded with spaces to a multiple of 8 bytes), a type indicator (8 for double and 4
+    for single precision values), the number of values, and the values themselves (padded with
+    zeros to a multiple of 8 bytes).
+
+    To avoid damaging an existing checkpoint when the program is interrupted while writing a new
+    one, the data is written to a temporary file, which replaces the file with the specified name
+    only when the close() function successfully completes. */
+class CheckpointOutFile
+{
+public:
+    /** The constructor opens a temporary file next to the checkpoint file with the specified path,
+        and writes the file header. */
+    explicit CheckpointOutFile(string filepath);
+
+    /** The destructor removes the temporary file if the close() function has not been called
+        successfully, for example because an exception was thrown while writing the checkpoint. */
+    ~CheckpointOutFile();
+
+    /** This function writes a record with the specified label and a single value. */
+    void write(string label, double value);
+
+    /** This function writes a record with the specified label and double precision values. */
+    void write(string label, const Array& values);
+
+    /** This function writes a record with the specified label and single precision values. */
+    void write(string label, const vector<float>& values);
+
+    /** This function closes the temporary file and renames it to the checkpoint file path
+        specified in the constructor, replacing any existing file with that name. If the system
+        does not allow renaming onto an existing file, the existing file is first renamed aside
+        and removed only after the new file has been put in place. */
+    void close();
+
+    /** This function returns the number of bytes written to the file so far. */
+    size_t numBytes() const { return _numBytes; }
+
+private:
+    // writes the header of a record with the specified label, value size, and number of values
+    void writeRecordHeader(string label, size_t valueSize, size_t numValues);
+
+    // writes the specified number of bytes and pads them to a multiple of 8 bytes
+    void writeBytes(const char* bytes, size_t numBytes);
+
+    string _filepath;       // the path of the checkpoint file
+    string _tempFilepath;   // the path of the temporary file being written
+    std::ofstream _out;     // the output stream
+    size_t _numBytes{0};    // the number of bytes written so far
+    bool _closed{false};    // becomes true when the file has been successfully closed and renamed
+};
+
+////////////////////////////////////////////////////////////////////
+
+#endif
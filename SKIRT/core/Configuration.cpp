@@ -83,9 +83,11 @@ void Configuration::setupSelfBefore()
     if (_hasMedium)
     {
         _numDensitySamples = ms->numDensitySamples();
+        _depositParticleMass = ms->depositParticleMass();
         _minWeightReduction = ms->photonPacketOptions()->minWeightReduction();
         _minScattEvents = ms->photonPacketOptions()->minScattEvents();
         _pathLengthBias = ms->photonPacketOptions()->pathLengthBias();
+        _maxPeelOffOpticalDepth = ms->photonPacketOptions()->maxPeelOffOpticalDepth();
     }
 
     // retrieve extinction-only options
@@ -117,8 +119,10 @@ void Configuration::setupSelfBefore()
             _hasStochasticDustEmission = true;
         }
         _includeHeatingByCMB = ms->dustEmissionOptions()->includeHeatingByCMB();
+        _tabulateEquilibriumEmission = ms->dustEmissionOptions()->tabulateEquilibriumEmission();
         _cellLibrary = ms->dustEmissionOptions()->cellLibrary();
         if (!_cellLibrary) _cellLibrary = new AllCellsLibrary(this);
+        _precalculateEmissionSpectra = ms->dustEmissionOptions()->precalculateEmissionSpectra();
         _radiationFieldWLG = ms->dustEmissionOptions()->radiationFieldWLG();
         _dustEmissionWLG = ms->dustEmissionOptions()->dustEmissionWLG();
         if (ms->dustEmissionOptions()->storeEmissionRadiationField())
@@ -132,6 +136,15 @@ void Configuration::setupSelfBefore()
         _secondaryWavelengthBiasDistribution = ms->dustEmissionOptions()->wavelengthBiasDistribution();
     }
 
+    // retrieve radiation field options
+    if (_hasRadiationField)
+    {
+        _radiationFieldAccumulationMode = ms->radiationFieldOptions()->accumulationMode();
+        _maxRadiationFieldBufferMemoryFraction = ms->radiationFieldOptions()->maxBufferMemoryFraction();
+        _maxSparseRadiationFieldBufferBins = ms->radiationFieldOptions()->maxSparseBufferBins();
+        _radiationFieldSinglePrecision = ms->radiationFieldOptions()->singlePrecision();
+    }
+
     // retrieve dust self-absorption options
     if (sim->simulationMode() == MonteCarloSimulation::SimulationMode::DustEmissionWithSelfAbsorption)
     {
@@ -283,6 +296,28 @@ void Configuration::setEmulationMode()
 
 ////////////////////////////////////////////////////////////////////
 
+void Configuration::setDataParallel()
+{
+    _dataParallel = true;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void Configuration::setCheckpointing()
+{
+    _checkpointing = true;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void Configuration::setRestart()
+{
+    _checkpointing = true;
+    _restart = true;
+}
+
+////////////////////////////////////////////////////////////////////
+
 namespace
 {
     // This function extends the specified wavelength range with the range of the specified wavelength grid
@@ -7,6 +7,7 @@
 #define CONFIGURATION_HPP
 
 #include "Array.hpp"
+#include "RadiationFieldOptions.hpp"
 #include "Range.hpp"
 #include "SimulationItem.hpp"
 class DisjointWavelengthGrid;
@@ -62,12 +63,40 @@ public:
         */
     void setEmulationMode();
 
+    /** This function enables data-parallel mode. Specifically, it sets a flag that can be queried
+        by other simulation items, causing the medium system to partition the radiation field over
+        the processes in a multi-process run. The function is intended to be called before setup,
+        and has no effect in single-process runs or in simulations that do not record the
+        radiation field. */
+    void setDataParallel();
+
+    /** This function enables checkpointing. Specifically, it sets a flag that can be queried by
+        other simulation items, causing the simulation to write a checkpoint of its state after
+        each emission segment. The function has no effect in emulation mode. */
+    void setCheckpointing();
+
+    /** This function causes the simulation to resume from the last checkpoint written by a
+        previous run with the same configuration, and enables checkpointing for the remaining
+        emission segments. */
+    void setRestart();
+
     //=========== Getters for configuration properties ============
 
 public:
     /** Returns true if the simulation has been put in emulation mode. */
     bool emulationMode() const { return _emulationMode; }
 
+    /** Returns true if data-parallel mode has been enabled. */
+    bool dataParallel() const { return _dataParallel; }
+
+    /** Returns true if checkpointing has been enabled, and the simulation is not in emulation
+        mode. */
+    bool checkpointing() const { return _checkpointing && !_emulationMode; }
+
+    /** Returns true if the simulation should resume from the last checkpoint, and the simulation
+        is not in emulation mode. */
+    bool restart() const { return _restart && !_emulationMode; }
+
     /** Returns the redshift at which the model resides, or zero if the model resides in the Local
         Universe. */
     double redshift() const { return _redshift; }
@@ -144,9 +173,18 @@ public:
         distribution. */
     double pathLengthBias() const { return _pathLengthBias; }
 
+    /** Returns the optical depth beyond which the calculation of the optical depth towards an
+        observer for a peel-off photon packet may be terminated, because the extinction factor
+        becomes negligible. */
+    double maxPeelOffOpticalDepth() const { return _maxPeelOffOpticalDepth; }
+
     /** Returns the number of random density samples for determining spatial cell mass. */
     int numDensitySamples() const { return _numDensitySamples; }
 
+    /** Returns true if the mass of smoothed particle media should be deposited directly into the
+        spatial cells rather than sampling the density distribution in random positions. */
+    bool depositParticleMass() const { return _depositParticleMass; }
+
     /** Returns true if the radiation field must be stored during the photon cycle, and false otherwise. */
     bool hasRadiationField() const { return _hasRadiationField; }
 
@@ -172,6 +210,10 @@ public:
         dust heating, and false otherwise. */
     bool includeHeatingByCMB() const { return _includeHeatingByCMB; }
 
+    /** Returns true if equilibrium dust emission spectra must be interpolated from precalculated
+        Planck spectra rather than calculated exactly, and false otherwise. */
+    bool tabulateEquilibriumEmission() const { return _tabulateEquilibriumEmission; }
+
     /** Returns true if dust self-absorption must be self-consistently calculated through
         iteration, and false otherwise. */
     bool hasDustSelfAbsorption() const { return _hasDustSelfAbsorption; }
@@ -179,6 +221,24 @@ public:
     /** Returns the wavelength grid to be used for storing the radiation field. */
     DisjointWavelengthGrid* radiationFieldWLG() const { return _radiationFieldWLG; }
 
+    /** Returns the mechanism used to accumulate the radiation field from parallel threads. */
+    RadiationFieldOptions::AccumulationMode radiationFieldAccumulationMode() const
+    {
+        return _radiationFieldAccumulationMode;
+    }
+
+    /** Returns the maximum fraction of the available memory used for dense thread-local radiation
+        field buffers in automatic accumulation mode. */
+    double maxRadiationFieldBufferMemoryFraction() const { return _maxRadiationFieldBufferMemoryFraction; }
+
+    /** Returns the maximum number of bins in a sparse thread-local radiation field buffer before
+        the buffer is flushed to the shared table. */
+    int maxSparseRadiationFieldBufferBins() const { return _maxSparseRadiationFieldBufferBins; }
+
+    /** Returns true if the radiation field tables must be stored in single precision, and false
+        if they must be stored in double precision. */
+    bool radiationFieldSinglePrecision() const { return _radiationFieldSinglePrecision; }
+
     /** Returns the wavelength grid to be used for calculating the dust emission spectrum. */
     DisjointWavelengthGrid* dustEmissionWLG() const { return _dustEmissionWLG; }
 
@@ -189,6 +249,11 @@ public:
     /** Returns the cell library mapping to be used for calculating the dust emission spectra. */
     SpatialCellLibrary* cellLibrary() const { return _cellLibrary; }
 
+    /** Returns true if the dust emission spectra for all cell library entries must be calculated
+        in advance, before launching any secondary photon packets, and false if they must be
+        calculated on the fly during the launch process. */
+    bool precalculateEmissionSpectra() const { return _precalculateEmissionSpectra; }
+
     /** Returns the fraction of secondary photon packets distributed uniformly across spatial
         cells. */
     double secondarySpatialBias() const { return _secondarySpatialBias; }
@@ -259,6 +324,9 @@ public:
 private:
     // general
     bool _emulationMode{false};
+    bool _dataParallel{false};
+    bool _checkpointing{false};
+    bool _restart{false};
 
     // cosmology parameters
     double _redshift{0.};
@@ -281,21 +349,30 @@ private:
     double _minWeightReduction{1e4};
     int _minScattEvents{0};
     double _pathLengthBias{0.5};
+    double _maxPeelOffOpticalDepth{100.};
     int _numDensitySamples{100};
+    bool _depositParticleMass{false};
 
     // radiation field
     bool _hasRadiationField{false};
     bool _hasPanRadiationField{false};
     bool _hasSecondaryRadiationField{false};
     DisjointWavelengthGrid* _radiationFieldWLG{nullptr};
+    RadiationFieldOptions::AccumulationMode _radiationFieldAccumulationMode{
+        RadiationFieldOptions::AccumulationMode::Shared};
+    double _maxRadiationFieldBufferMemoryFraction{0.25};
+    int _maxSparseRadiationFieldBufferBins{1000000};
+    bool _radiationFieldSinglePrecision{false};
 
     // emission
     bool _hasDustEmission{false};
     bool _hasStochasticDustEmission{false};
     bool _includeHeatingByCMB{false};
+    bool _tabulateEquilibriumEmission{false};
     bool _hasDustSelfAbsorption{false};
     DisjointWavelengthGrid* _dustEmissionWLG{nullptr};
     SpatialCellLibrary* _cellLibrary{nullptr};
+    bool _precalculateEmissionSpectra{false};
     bool _storeEmissionRadiationField{false};
     double _secondarySpatialBias{0.5};
     double _secondaryWavelengthBias{0.5};
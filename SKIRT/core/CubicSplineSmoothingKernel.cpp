@@ -50,7 +50,13 @@ double CubicSplineSmoothingKernel::density(double u) const
 
 double CubicSplineSmoothingKernel::generateRadius() const
 {
-    double X = random()->uniform();
+    return radiusForMassFraction(random()->uniform());
+}
+
+//////////////////////////////////////////////////////////////////////
+
+double CubicSplineSmoothingKernel::radiusForMassFraction(double X) const
+{
     int k = NR::locateClip(_Xv, X);
     double p = (X - _Xv[k]) / (_Xv[k + 1] - _Xv[k]);
     double u = (k + p) / _Nu;
@@ -45,6 +45,11 @@ public:
         on which we interpolate to solve this equation. */
     double generateRadius() const override;
 
+    /** This function returns the normalized radius \f$u\f$ of the sphere that contains the
+        specified fraction \f${\cal{X}}\f$ of the kernel mass. For the cubic spline smoothing
+        kernel, we interpolate on the precomputed grid. */
+    double radiusForMassFraction(double X) const override;
+
     //======================== Data Members ========================
 
 private:
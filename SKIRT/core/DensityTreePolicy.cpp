@@ -208,14 +208,18 @@ vector<TreeNode*> DensityTreePolicy::constructTree(TreeNode* root)
 
         // evaluate nodes at this level: value in the array becomes one for nodes that need to be subdivided
         // we parallelize this operation because it might be resource intensive (e.g. sampling densities)
+        // each node draws its density samples from its own random stream, if so configured
         Array divide(numEvalNodes);
+        _random->startSeries();
         parallel->call(numEvalNodes, [this, log, level, lbeg, &nodev, &divide](size_t firstIndex, size_t numIndices) {
             while (numIndices)
             {
                 size_t currentChunkSize = min(logEvalChunkSize, numIndices);
                 for (size_t l = firstIndex; l != firstIndex + currentChunkSize; ++l)
                 {
+                    _random->startStream(lbeg + l);
                     if (needsSubdivide(nodev[lbeg + l])) divide[l] = 1.;
+                    _random->endStream();
                 }
                 log->infoIfElapsed("Evaluation for level " + std::to_string(level) + ": ", currentChunkSize);
                 firstIndex += currentChunkSize;
@@ -37,11 +37,22 @@ class DustEmissionOptions : public SimulationItem, public SourceWavelengthRangeI
         ATTRIBUTE_DEFAULT_VALUE(includeHeatingByCMB, "false")
         ATTRIBUTE_DISPLAYED_IF(includeHeatingByCMB, "NonZeroRedshift")
 
+        PROPERTY_BOOL(tabulateEquilibriumEmission,
+                      "interpolate equilibrium emission spectra from precalculated Planck spectra")
+        ATTRIBUTE_DEFAULT_VALUE(tabulateEquilibriumEmission, "false")
+        ATTRIBUTE_RELEVANT_IF(tabulateEquilibriumEmission, "!StochasticDustEmission")
+        ATTRIBUTE_DISPLAYED_IF(tabulateEquilibriumEmission, "Level3")
+
         PROPERTY_ITEM(cellLibrary, SpatialCellLibrary, "the spatial cell grouping scheme for calculating dust emission")
         ATTRIBUTE_DEFAULT_VALUE(cellLibrary, "AllCellsLibrary")
         ATTRIBUTE_REQUIRED_IF(cellLibrary, "false")
         ATTRIBUTE_DISPLAYED_IF(cellLibrary, "Level2")
 
+        PROPERTY_BOOL(precalculateEmissionSpectra,
+                      "precalculate the emission spectra for all cell library entries before launching")
+        ATTRIBUTE_DEFAULT_VALUE(precalculateEmissionSpectra, "false")
+        ATTRIBUTE_DISPLAYED_IF(precalculateEmissionSpectra, "Level3")
+
         PROPERTY_ITEM(radiationFieldWLG, DisjointWavelengthGrid, "the wavelength grid for storing the radiation field")
         ATTRIBUTE_DEFAULT_VALUE(radiationFieldWLG, "LogWavelengthGrid")
 
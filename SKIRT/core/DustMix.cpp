@@ -264,6 +264,34 @@ double DustMix::asymmpar(double lambda) const
 
 ////////////////////////////////////////////////////////////////////
 
+double DustMix::sectionSca(double /*lambda*/, int ell) const
+{
+    return _sigmascav[ell];
+}
+
+////////////////////////////////////////////////////////////////////
+
+double DustMix::sectionExt(double /*lambda*/, int ell) const
+{
+    return _sigmaextv[ell];
+}
+
+////////////////////////////////////////////////////////////////////
+
+double DustMix::albedo(double /*lambda*/, int ell) const
+{
+    return _albedov[ell];
+}
+
+////////////////////////////////////////////////////////////////////
+
+double DustMix::asymmpar(double /*lambda*/, int ell) const
+{
+    return _asymmparv[ell];
+}
+
+////////////////////////////////////////////////////////////////////
+
 double DustMix::phaseFunctionValueForCosine(double lambda, double costheta) const
 {
     int ell = indexForLambda(lambda);
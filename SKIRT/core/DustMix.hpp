@@ -113,11 +113,6 @@ protected:
     //======== Private support functions =======
 
 protected:
-    /** This function returns the index in the private wavelength grid corresponding to the
-        specified wavelength. The parameters for converting a wavelength to the appropriate index
-        are stored in data members during setup. */
-    int indexForLambda(double lambda) const;
-
     /** This function returns the index in the private scattering angle grid corresponding to the
         specified scattering angle. The parameters for converting a scattering angle to the
         appropriate index are built-in constants. */
@@ -167,6 +162,30 @@ public:
         pre-computed during setup. */
     double asymmpar(double lambda) const override;
 
+    //======== Basic material properties for a resolved wavelength index =======
+
+public:
+    /** This function returns the index in the private wavelength grid corresponding to the
+        specified wavelength. The parameters for converting a wavelength to the appropriate index
+        are stored in data members during setup. */
+    int indexForLambda(double lambda) const override;
+
+    /** This function returns the scattering cross section per entity at wavelength
+        \f$\lambda\f$ from the pre-computed table entry with the given wavelength index. */
+    double sectionSca(double lambda, int ell) const override;
+
+    /** This function returns the total extinction cross section per entity at wavelength
+        \f$\lambda\f$ from the pre-computed table entry with the given wavelength index. */
+    double sectionExt(double lambda, int ell) const override;
+
+    /** This function returns the scattering albedo at wavelength \f$\lambda\f$ from the
+        pre-computed table entry with the given wavelength index. */
+    double albedo(double lambda, int ell) const override;
+
+    /** This function returns the scattering asymmetry parameter at wavelength \f$\lambda\f$ from
+        the pre-computed table entry with the given wavelength index. */
+    double asymmpar(double lambda, int ell) const override;
+
     //======== Scattering with material phase function =======
 
 public:
@@ -89,6 +89,27 @@ double ElectronMix::albedo(double /*lambda*/) const
 
 ////////////////////////////////////////////////////////////////////
 
+double ElectronMix::sectionSca(double /*lambda*/, int /*ell*/) const
+{
+    return Constants::sigmaThomson();
+}
+
+////////////////////////////////////////////////////////////////////
+
+double ElectronMix::sectionExt(double /*lambda*/, int /*ell*/) const
+{
+    return Constants::sigmaThomson();
+}
+
+////////////////////////////////////////////////////////////////////
+
+double ElectronMix::albedo(double /*lambda*/, int /*ell*/) const
+{
+    return 1.;
+}
+
+////////////////////////////////////////////////////////////////////
+
 double ElectronMix::phaseFunctionValueForCosine(double /*lambda*/, double costheta) const
 {
     return 0.75 * (costheta * costheta + 1.);
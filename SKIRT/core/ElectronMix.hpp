@@ -80,6 +80,18 @@ public:
         population, which is trivially equal to one for all wavelengths \f$\lambda\f$. */
     double albedo(double lambda) const override;
 
+    //======== Basic material properties for a resolved wavelength index =======
+
+public:
+    /** This function returns the Thomson cross section, ignoring the wavelength index. */
+    double sectionSca(double lambda, int ell) const override;
+
+    /** This function returns the Thomson cross section, ignoring the wavelength index. */
+    double sectionExt(double lambda, int ell) const override;
+
+    /** This function returns an albedo of one, ignoring the wavelength index. */
+    double albedo(double lambda, int ell) const override;
+
     //======== Scattering with material phase function =======
 
 public:
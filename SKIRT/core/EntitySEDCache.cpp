@@ -0,0 +1,88 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#include "EntitySEDCache.hpp"
+
+////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    // estimated memory overhead for each cached distribution, in addition to the array contents
+    const size_t entryOverhead = sizeof(EntitySEDCache::Distribution) + 128;
+}
+
+////////////////////////////////////////////////////////////////////
+
+size_t EntitySEDCache::bytes(const Distribution& distribution)
+{
+    return (distribution.lambdav.size() + distribution.pv.size() + distribution.Pv.size()) * sizeof(double)
+           + distribution.alias.bytes() + entryOverhead;
+}
+
+////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const EntitySEDCache::Distribution> EntitySEDCache::retrieve(int m)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto it = _map.find(m);
+    if (it == _map.end()) return nullptr;
+
+    // move the entity to the front of the usage list
+    _usage.splice(_usage.begin(), _usage, it->second.second);
+    return it->second.first;
+}
+
+////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const EntitySEDCache::Distribution>
+EntitySEDCache::store(int m, std::shared_ptr<const Distribution> distribution)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // if another thread stored this entity in the mean time, return the existing distribution
+    auto it = _map.find(m);
+    if (it != _map.end())
+    {
+        _usage.splice(_usage.begin(), _usage, it->second.second);
+        return it->second.first;
+    }
+
+    // evict the least recently used distributions until there is room for the new one
+    size_t numBytes = bytes(*distribution);
+    while (!_usage.empty() && _numBytes + numBytes > _maxBytes)
+    {
+        auto last = _map.find(_usage.back());
+        _numBytes -= bytes(*last->second.first);
+        _map.erase(last);
+        _usage.pop_back();
+    }
+
+    // store the new distribution, even if it is larger than the maximum size by itself
+    _usage.push_front(m);
+    _map.emplace(m, Entry(distribution, _usage.begin()));
+    _numBytes += numBytes;
+    return distribution;
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool EntitySEDCache::isFull() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // consider the cache to be full if the average distribution size would not fit any more
+    return !_map.empty() && _numBytes + _numBytes / _map.size() > _maxBytes;
+}
+
+////////////////////////////////////////////////////////////////////
+
+size_t EntitySEDCache::size() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _map.size();
+}
+
+////////////////////////////////////////////////////////////////////
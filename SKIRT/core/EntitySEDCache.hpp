@@ -0,0 +1,76 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#ifndef ENTITYSEDCACHE_HPP
+#define ENTITYSEDCACHE_HPP
+
+#include "AliasTable.hpp"
+#include "Array.hpp"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+////////////////////////////////////////////////////////////////////
+
+/** EntitySEDCache is a helper class for caching the normalized spectral distributions of the
+    entities imported by an ImportedSource object, so that the distribution for each entity needs
+    to be calculated from the %SED family only once. The cache is shared by all execution threads
+    in a process, and all functions are thread-safe.
+
+    The cache holds at most a given number of bytes. When storing a new distribution would exceed
+    this limit, the least recently used distributions are evicted from the cache. Distributions are
+    handed out through shared pointers, so that a distribution remains available to a thread that
+    is still using it even after it has been evicted from the cache. */
+class EntitySEDCache
+{
+public:
+    /** This data structure holds the normalized regular and cumulative spectral distribution for a
+        single entity, as returned by the SEDFamily::cdf() function, and the corresponding alias
+        table for sampling the distribution. */
+    struct Distribution
+    {
+        Array lambdav, pv, Pv;
+        AliasTable alias;
+    };
+
+    /** The constructor creates an empty cache that holds at most the specified number of bytes. */
+    explicit EntitySEDCache(size_t maxBytes) : _maxBytes(maxBytes) {}
+
+    /** This function returns the distribution for the entity with index \f$m\f$ if it is present in
+        the cache, or a null pointer if not. If the distribution is found, it is marked as most
+        recently used. */
+    std::shared_ptr<const Distribution> retrieve(int m);
+
+    /** This function stores the specified distribution for the entity with index \f$m\f$ in the
+        cache, evicting the least recently used distributions as needed, and returns a shared
+        pointer to the stored distribution. If the cache already holds a distribution for the
+        entity (because another thread stored it in the mean time), the function returns the
+        existing distribution instead. */
+    std::shared_ptr<const Distribution> store(int m, std::shared_ptr<const Distribution> distribution);
+
+    /** This function returns true if the cache currently holds the maximum number of bytes, or
+        close to it. */
+    bool isFull() const;
+
+    /** This function returns the number of distributions currently held in the cache. */
+    size_t size() const;
+
+private:
+    // returns the approximate number of bytes occupied by the specified distribution
+    static size_t bytes(const Distribution& distribution);
+
+    using Entry = std::pair<std::shared_ptr<const Distribution>, std::list<int>::iterator>;
+
+    size_t _maxBytes;                     // the maximum number of bytes held by the cache
+    size_t _numBytes{0};                  // the number of bytes currently held by the cache
+    std::unordered_map<int, Entry> _map;  // the cached distributions and their position in the usage list
+    std::list<int> _usage;                // the entity indices from most to least recently used
+    mutable std::mutex _mutex;            // guards access to the above data members
+};
+
+////////////////////////////////////////////////////////////////////
+
+#endif
@@ -53,10 +53,27 @@ void EquilibriumDustEmissionCalculator::precalculate(SimulationItem* item, const
 
         // build the temperature grid on which we store the Planck-integrated absorption cross sections
         NR::buildPowerLawGrid(_Tv, 0., 5000., 1000, 500.);
+
+        // if requested by the configuration, tabulate the Planck spectra on the dust emission wavelength grid
+        // for each temperature in the grid, leaving the spectrum for zero temperature at zero
+        if (config->tabulateEquilibriumEmission() && _emlambdav.size())
+        {
+            size_t numT = _Tv.size();
+            size_t numEm = _emlambdav.size();
+            _planckv.resize(numT * numEm);
+            for (size_t p = 1; p != numT; ++p)
+            {
+                PlanckFunction B(_Tv[p]);
+                for (size_t ell = 0; ell != numEm; ++ell) _planckv[p * numEm + ell] = B(_emlambdav[ell]);
+            }
+        }
     }
 
-    // interpolate the absorption cross sections on the radiation field wavelength grid
-    _rfsigmaabsvv.emplace_back(NR::resample<NR::interpolateLogLog>(_rflambdav, lambdav, sigmaabsv));
+    // interpolate the absorption cross sections on the radiation field wavelength grid,
+    // and multiply by the bin widths so that the energy balance integral becomes a simple sum
+    Array rfsigmaabsv = NR::resample<NR::interpolateLogLog>(_rflambdav, lambdav, sigmaabsv) * _rfdlambdav;
+    _cmbabsv.push_back((rfsigmaabsv * _Bcmbv).sum());
+    _rfsigmaabsvv.emplace_back(std::move(rfsigmaabsv));
 
     // interpolate the absorption cross sections on the dust emission field wavelength grid, if there is one
     if (_emlambdav.size())
@@ -102,6 +119,8 @@ size_t EquilibriumDustEmissionCalculator::allocatedBytes() const
     allocatedSize += _Bcmbv.size();
     allocatedSize += _emlambdav.size();
     allocatedSize += _Tv.size();
+    allocatedSize += _planckv.size();
+    allocatedSize += _cmbabsv.size();
     if (!_rfsigmaabsvv.empty()) allocatedSize += _rfsigmaabsvv.size() * _rfsigmaabsvv[0].size();
     if (!_emsigmaabsvv.empty()) allocatedSize += _emsigmaabsvv.size() * _emsigmaabsvv[0].size();
     if (!_planckabsvv.empty()) allocatedSize += _planckabsvv.size() * _planckabsvv[0].size();
@@ -119,8 +138,11 @@ int EquilibriumDustEmissionCalculator::numBins() const
 
 double EquilibriumDustEmissionCalculator::equilibriumTemperature(int b, const Array& Jv) const
 {
-    // integrate the input side of the energy balance equation
-    double inputabs = (_rfsigmaabsvv[b] * (Jv + _Bcmbv) * _rfdlambdav).sum();
+    // integrate the input side of the energy balance equation without creating temporary arrays
+    const Array& rfsigmaabsv = _rfsigmaabsvv[b];
+    size_t numWavelengths = rfsigmaabsv.size();
+    double inputabs = _cmbabsv[b];
+    for (size_t k = 0; k != numWavelengths; ++k) inputabs += rfsigmaabsv[k] * Jv[k];
 
     // find the temperature corresponding to this amount of emission on the output side of the equation
     if (inputabs > 0.)
@@ -140,10 +162,30 @@ Array EquilibriumDustEmissionCalculator::emissivity(const Array& Jv) const
     for (int b = 0; b != numBins; ++b)
     {
         double T = equilibriumTemperature(b, Jv);
-        PlanckFunction B(T);
-        for (int ell = 0; ell < numWavelengths; ell++)
+        const Array& emsigmaabsv = _emsigmaabsvv[b];
+
+        // interpolate between the tabulated Planck spectra bracketing the equilibrium temperature
+        if (_planckv.size())
         {
-            ev[ell] += _emsigmaabsvv[b][ell] * B(_emlambdav[ell]);
+            int p = NR::locateClip(_Tv, T);
+            double w1 = (T - _Tv[p]) / (_Tv[p + 1] - _Tv[p]);
+            double w0 = 1. - w1;
+            const double* B0 = &_planckv[p * numWavelengths];
+            const double* B1 = B0 + numWavelengths;
+            for (int ell = 0; ell < numWavelengths; ell++)
+            {
+                ev[ell] += emsigmaabsv[ell] * (w0 * B0[ell] + w1 * B1[ell]);
+            }
+        }
+
+        // or evaluate the Planck function for each wavelength
+        else
+        {
+            PlanckFunction B(T);
+            for (int ell = 0; ell < numWavelengths; ell++)
+            {
+                ev[ell] += emsigmaabsv[ell] * B(_emlambdav[ell]);
+            }
         }
     }
     return ev;
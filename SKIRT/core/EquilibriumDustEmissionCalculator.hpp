@@ -51,7 +51,19 @@ class SimulationItem;
     \f$J_\lambda\f$ can then be written as \f[ \varepsilon_\lambda = \sum_{b=0}^{N_{\text{bins}}-1}
     \varsigma_{\lambda,b}^{\text{abs}}\, B_\lambda(T_{\text{eq},b}) \f] with
     \f$\varsigma_{\lambda,b}^{\text{abs}}\f$ the absorption cross section of the \f$b\f$'th
-    representative grain and \f$T_{\text{eq},b}\f$ the equilibrium temperature of that grain. */
+    representative grain and \f$T_{\text{eq},b}\f$ the equilibrium temperature of that grain.
+
+    By default, the Planck function \f$B_\lambda(T_{\text{eq},b})\f$ is evaluated exactly for each
+    bin and for each wavelength in the dust emission wavelength grid. If the simulation's
+    configuration requests tabulated equilibrium emission, the calculator instead precalculates the
+    Planck spectra on the dust emission wavelength grid for each of the temperatures in the grid
+    used for the energy balance equation. The emissivity spectrum is then obtained by linear
+    interpolation between the two tabulated spectra bracketing the equilibrium temperature of each
+    bin, which avoids evaluating an exponential for each wavelength. Because the temperature grid
+    is fine (a relative spacing of about one percent in the relevant temperature range), the
+    interpolation error is negligible except in the far Wien tail of the spectrum, where the
+    emissivity is many orders of magnitude below its peak value. The table is shared by all bins,
+    so that the memory requirements do not depend on the number of bins. */
 class EquilibriumDustEmissionCalculator
 {
 public:
@@ -69,7 +81,9 @@ public:
         on some fine wavelength grid \f$\lambda_i\f$. The function stores the absorption cross
         sections interpolated on the radiation field and dust emission wavelength grids and it
         precalculates Planck-integrated absorption cross sections on an appropriate temperature
-        grid through integration over the fine wavelength grid specified as an argument. */
+        grid through integration over the fine wavelength grid specified as an argument. If so
+        requested by the configuration, the first invocation also tabulates the Planck spectra on
+        the dust emission wavelength grid for each temperature in the grid. */
     void precalculate(SimulationItem* item, const Array& lambdav, const Array& sigmaabsv);
 
     /** This function returns the size of the memory, in bytes, allocated by the precalculate()
@@ -106,8 +120,10 @@ private:
     Array _Bcmbv;       // cosmic microwave background radiation field, or zeroes -- indexed on k
     Array _emlambdav;   // dust emission wavelength grid (EMWLG) -- indexed on ell
     Array _Tv;          // temperature grid for the integrated absorption cross sections -- indexed on p
+    Array _planckv;     // tabulated Planck spectra on the EMWLG, or empty -- indexed on p*numEm+ell
 
-    vector<Array> _rfsigmaabsvv;  // absorption cross sections on the RFWLG for each bin -- indexed on b,k
+    vector<Array> _rfsigmaabsvv;  // absorption cross sections times RFWLG bin widths for each bin -- indexed on b,k
+    vector<double> _cmbabsv;      // CMB term of the energy balance equation for each bin, or zero -- indexed on b
     vector<Array> _emsigmaabsvv;  // absorption cross sections on the EMWLG for each bin -- indexed on b,ell
     vector<Array> _planckabsvv;   // Planck-integrated absorption cross sections for each bin -- indexed on b,p
 };
@@ -7,6 +7,7 @@
 #include "FatalError.hpp"
 #include "FilePaths.hpp"
 #include "Log.hpp"
+#include "OutputWriter.hpp"
 #include "ProcessManager.hpp"
 #include "System.hpp"
 #include "fitsio.h"
@@ -38,14 +39,27 @@ void FITSInOut::write(const SimulationItem* item, string description, string fil
     // Only write the FITS file if this process is the root
     if (ProcessManager::isRoot())
     {
-        // Determine the path of the output FITS file
+        // Determine the path of the output FITS file and the log message
         string filepath = item->find<FilePaths>()->output(filename + ".fits");
-
-        // Write the FITS file
-        FITSInOut::write(filepath, data, dataUnits, nx, ny, incx, incy, xc, yc, xyUnits, z, zUnits);
-
-        // Log the file path
-        item->find<Log>()->info(item->typeAndName() + " wrote " + description + " to FITS file " + filepath);
+        string message = item->typeAndName() + " wrote " + description + " to FITS file " + filepath;
+        Log* log = item->find<Log>();
+
+        // Convert the data to the single-precision format stored in the file, so that the caller can release
+        // or reuse its data while the file is being written
+        auto pixels = std::make_shared<vector<float>>(begin(data), end(data));
+
+        // Write the FITS file and log the file path, through the output writer if there is one
+        auto writer = item->find<OutputWriter>(false);
+        auto compression = writer ? writer->fitsCompression() : Compression::None;
+        auto task = [=]() {
+            FITSInOut::write(filepath, *pixels, dataUnits, nx, ny, incx, incy, xc, yc, xyUnits, z, zUnits,
+                             compression);
+            log->info(message);
+        };
+        if (writer)
+            writer->submit(task, pixels->size() * sizeof(float));
+        else
+            task();
     }
 }
 
@@ -53,9 +67,17 @@ void FITSInOut::write(const SimulationItem* item, string description, string fil
 
 namespace
 {
-    // mutex to guard the FITS input/output operations
+    // mutex to guard the FITS input/output operations if the cfitsio library is not reentrant
     std::mutex _mutex;
 
+    // returns a lock that guards the FITS input/output operations if the cfitsio library is not reentrant,
+    // i.e. if it was not built with the _REENTRANT flag, and an unlocked lock otherwise
+    std::unique_lock<std::mutex> lockIfNeeded()
+    {
+        if (fits_is_reentrant()) return std::unique_lock<std::mutex>(_mutex, std::defer_lock);
+        return std::unique_lock<std::mutex>(_mutex);
+    }
+
     // function to report cfitsio errors
     void report_error(string filepath, string action, int status)
     {
@@ -69,8 +91,8 @@ namespace
 
 void FITSInOut::read(string filepath, Array& data, int& nx, int& ny, int& nz)
 {
-    // Acquire a global lock since the cfitsio library is not guaranteed to be reentrant
-    std::unique_lock<std::mutex> lock(_mutex);
+    // Acquire a global lock if the cfitsio library is not reentrant
+    auto lock = lockIfNeeded();
 
     // Open the FITS file
     int status = 0;
@@ -104,8 +126,9 @@ void FITSInOut::read(string filepath, Array& data, int& nx, int& ny, int& nz)
 
 ////////////////////////////////////////////////////////////////////
 
-void FITSInOut::write(string filepath, const Array& data, string dataUnits, int nx, int ny, double incx, double incy,
-                      double xc, double yc, string xyUnits, const Array& z, string zUnits)
+void FITSInOut::write(string filepath, const vector<float>& data, string dataUnits, int nx, int ny, double incx,
+                      double incy, double xc, double yc, string xyUnits, const Array& z, string zUnits,
+                      Compression compression)
 {
     // Get the z-axis size
     //   0:  a single frame that is not part of a datacube
@@ -119,9 +142,9 @@ void FITSInOut::write(string filepath, const Array& data, string dataUnits, int
         throw FATALERROR("Inconsistent data size when creating FITS file " + filepath);
     long naxes[3] = {nx, ny, nz};
 
-    // Acquire a global lock since the cfitsio library is not guaranteed to be reentrant
-    // (only when it is built with ./configure --enable-reentrant; make)
-    std::unique_lock<std::mutex> lock(_mutex);
+    // Acquire a global lock if the cfitsio library is not reentrant
+    // (i.e. when it is not built with the _REENTRANT flag)
+    auto lock = lockIfNeeded();
 
     // Generate time stamp
     string stamp = System::timestamp(true);
@@ -136,7 +159,26 @@ void FITSInOut::write(string filepath, const Array& data, string dataUnits, int
     ffdkinit(&fptr, filepath.c_str(), &status);
     if (status) report_error(filepath, "creating", status);
 
-    // Create the primary image (32-bit floating point pixels)
+    // Request tile compression, if applicable
+    if (compression != Compression::None)
+    {
+        if (compression == Compression::Gzip)
+        {
+            // store the floating point values losslessly
+            fits_set_compression_type(fptr, GZIP_2, &status);
+            fits_set_quantize_level(fptr, 0.f, &status);
+        }
+        else
+        {
+            // quantize the floating point values, preserving the (many) zero values in Monte Carlo output
+            fits_set_compression_type(fptr, RICE_1, &status);
+            fits_set_quantize_level(fptr, 16.f, &status);
+            fits_set_quantize_method(fptr, SUBTRACTIVE_DITHER_2, &status);
+        }
+        if (status) report_error(filepath, "creating", status);
+    }
+
+    // Create the image (32-bit floating point pixels)
     ffcrim(fptr, FLOAT_IMG, (nz ? 3 : 2), naxes, &status);
     if (status) report_error(filepath, "creating", status);
 
@@ -161,7 +203,7 @@ void FITSInOut::write(string filepath, const Array& data, string dataUnits, int
     if (status) report_error(filepath, "writing", status);
 
     // Write the array of pixels to the image
-    ffpprd(fptr, 0, 1, nelements, const_cast<double*>(&data[0]), &status);
+    ffppre(fptr, 0, 1, nelements, const_cast<float*>(&data[0]), &status);
     if (status) report_error(filepath, "writing", status);
 
     // If the data has 3 dimensions, write a FITS table extension with the values of the third axis
@@ -189,8 +231,8 @@ void FITSInOut::write(string filepath, const Array& data, string dataUnits, int
 
 void FITSInOut::readColumn(string filepath, Array& data, int n)
 {
-    // Acquire a global lock since the cfitsio library is not guaranteed to be reentrant
-    std::unique_lock<std::mutex> lock(_mutex);
+    // Acquire a global lock if the cfitsio library is not reentrant
+    auto lock = lockIfNeeded();
 
     // Open the FITS file
     int status = 0;
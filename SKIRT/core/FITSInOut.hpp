@@ -12,10 +12,26 @@ class SimulationItem;
 ////////////////////////////////////////////////////////////////////
 
 /** The FITSInOut class offers static functions to read/write a 2D or 3D data stream from/to a
-    standard FITS file, with support for a basic set of metadata in the header. */
+    standard FITS file, with support for a basic set of metadata in the header.
+
+    When writing in the context of a simulation item hierarchy that includes an OutputWriter
+    instance, the data is handed to that writer so that the file is written by a background thread,
+    and the file is optionally tile-compressed as configured in the writer. Because the cfitsio
+    library is built for thread-safe operation when possible, independent files can then be
+    written in parallel. */
 class FITSInOut final
 {
 public:
+    /** This enumeration lists the supported compression types for FITS output files. With Gzip,
+        the image is tile-compressed losslessly using the GZIP_2 algorithm (gzip after shuffling
+        the bytes of the floating point values). With Rice, the floating point values in each tile
+        are first quantized to integers with a step size of 1/16 of the noise level estimated for
+        the tile (with subtractive dithering that preserves zero values) and then compressed using
+        the RICE_1 algorithm, which is faster and more effective but not lossless. In both cases,
+        the compressed image is stored in the first extension of the file rather than in the
+        primary data unit, as specified by the FITS tiled image compression convention. */
+    enum class Compression { None, Gzip, Rice };
+
     // ================== Read/write in the context of an item hierarchy ==================
 
     /** This function reads data from a FITS file in the context of the simulation item hierarchy
@@ -34,7 +50,12 @@ public:
         the simulation's output path. The output filename should \em not include the filename
         extension nor the simulation prefix. The remaining arguments of this function are the same
         as those described for the basic write() function in this class. Note that the arguments
-        describing the z-axis may be omitted when writing a 2D data frame. */
+        describing the z-axis may be omitted when writing a 2D data frame.
+
+        If the simulation hierarchy includes an OutputWriter instance, the data is converted to
+        single precision and handed to the writer together with a copy of the other arguments, so
+        that the function may return before the file has actually been written. The file is then
+        compressed as configured in the writer. */
     static void write(const SimulationItem* item, string description, string filename, const Array& data,
                       string dataUnits, int nx, int ny, double incx, double incy, double xc, double yc, string xyUnits,
                       const Array& z = Array(), string zUnits = string());
@@ -87,10 +108,12 @@ private:
         specify the number of values in each spatial direction, \em incx and \em incy specify the
         increment between subsequent grid points in each spatial direction, \em xc and \em yc
         specify the center of the frame(s), and \em xyUnits describes the units of the xy-grid
-        increments. Finally, \em z contains the z-axis grid points (often wavelengths), and \em
-        zUnits describes the units of these grid points. */
-    static void write(string filepath, const Array& data, string dataUnits, int nx, int ny, double incx, double incy,
-                      double xc, double yc, string xyUnits, const Array& z, string zUnits);
+        increments. Finally, \em z contains the z-axis grid points (often wavelengths), \em
+        zUnits describes the units of these grid points, and \em compression specifies the
+        compression type for the image. */
+    static void write(string filepath, const vector<float>& data, string dataUnits, int nx, int ny, double incx,
+                      double incy, double xc, double yc, string xyUnits, const Array& z, string zUnits,
+                      Compression compression);
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -15,6 +15,7 @@ void FamilySED::setupSelfBefore()
 
     _family = getFamilyAndParameters(_parameters);
     _Ltot = _family->cdf(_lambdav, _pv, _Pv, normalizationWavelengthRange(), _parameters);
+    _alias.initialize(_Pv);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -52,7 +53,7 @@ double FamilySED::integratedLuminosity(const Range& wavelengthRange) const
 
 double FamilySED::generateWavelength() const
 {
-    return random()->cdfLogLog(_lambdav, _pv, _Pv);
+    return random()->cdfLogLog(_lambdav, _pv, _Pv, _alias);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -6,6 +6,7 @@
 #ifndef FAMILYSED_HPP
 #define FAMILYSED_HPP
 
+#include "AliasTable.hpp"
 #include "Array.hpp"
 #include "SED.hpp"
 class SEDFamily;
@@ -68,6 +69,7 @@ private:
     Array _lambdav;
     Array _pv;
     Array _Pv;
+    AliasTable _alias;
     double _Ltot{0};
 };
 
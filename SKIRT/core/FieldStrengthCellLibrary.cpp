@@ -7,6 +7,7 @@
 #include "Configuration.hpp"
 #include "Log.hpp"
 #include "MediumSystem.hpp"
+#include "ProcessManager.hpp"
 #include "StringUtils.hpp"
 #include "WavelengthGrid.hpp"
 
@@ -29,24 +30,32 @@ vector<int> FieldStrengthCellLibrary::mapping(const Array& bv) const
     // the local radiation field in the Milky Way (Mathis et al. 1983) integrated over all wavelengths
     double JtotMW = 1.7623e-06;
 
-    // calculate the field strengths for all spatial cells and track the minimum and maximum values
-    double Umin = DBL_MAX;
-    double Umax = 0.0;
+    // calculate the field strengths for all spatial cells;
+    // in data-parallel mode, each process handles the cells for which it holds the radiation field
     Array Uv(numCells);
     for (int m = 0; m != numCells; ++m)
     {
         // ignore cells that won't be used by the caller
-        if (bv[m])
+        if (bv[m] && ms->isLocalCell(m))
         {
             double U = (ms->meanIntensity(m) * wavelengthGrid->dlambdav()).sum() / JtotMW;
             // ignore cells with extremely small radiation fields (compared to the average in the Milky Way)
             // to avoid wasting library grid points on fields that won't change simulation results anyway
-            if (U > 1e-6)
-            {
-                Uv[m] = U;
-                Umin = min(Umin, U);
-                Umax = max(Umax, U);
-            }
+            if (U > 1e-6) Uv[m] = U;
+        }
+    }
+    if (ms->isDataParallel()) ProcessManager::sumToAll(Uv);
+
+    // track the minimum and maximum values
+    double Umin = DBL_MAX;
+    double Umax = 0.0;
+    for (int m = 0; m != numCells; ++m)
+    {
+        double U = Uv[m];
+        if (U > 0.)
+        {
+            Umin = min(Umin, U);
+            Umax = max(Umax, U);
         }
     }
 
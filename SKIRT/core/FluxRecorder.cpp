@@ -4,10 +4,14 @@
 ///////////////////////////////////////////////////////////////// */
 
 #include "FluxRecorder.hpp"
+#include "CheckpointInFile.hpp"
+#include "CheckpointOutFile.hpp"
 #include "FITSInOut.hpp"
+#include "InstrumentSystem.hpp"
 #include "LockFree.hpp"
 #include "Log.hpp"
 #include "MediumSystem.hpp"
+#include "ParallelFactory.hpp"
 #include "PhotonPacket.hpp"
 #include "ProcessManager.hpp"
 #include "StringUtils.hpp"
@@ -38,6 +42,9 @@ namespace
     //  - thus, the number of detector arrays for statistics is this number plus one
     //  - these detector arrays do not need calibration!
     const int maxContributionPower = 4;
+
+    // the maximum number of entries in the sparse IFU staging buffers for a thread before they are merged
+    const size_t maxIfuStagingEntries = 1 << 16;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -121,6 +128,11 @@ void FluxRecorder::finalizeConfiguration()
     // do not try to record components if there is no medium
     _recordTotalOnly = !_recordComponents || !_hasMedium;
 
+    // stage IFU detections only if requested and if there are multiple threads that could contend
+    auto is = _parentItem->find<InstrumentSystem>(false);
+    _stageIfu = _includeSurfaceBrightness && is && is->stageIfuDetections()
+                && _parentItem->find<ParallelFactory>()->maxThreadCount() > 1;
+
     // allocate the appropriate number of flux detector arrays
     _sed.resize(PrimaryScatteredLevel + _numScatteringLevels);
     _ifu.resize(PrimaryScatteredLevel + _numScatteringLevels);
@@ -184,11 +196,25 @@ void FluxRecorder::finalizeConfiguration()
 
 ////////////////////////////////////////////////////////////////////
 
+void FluxRecorder::addIfu(StagingBuffer* buffer, int k, size_t lell, double w)
+{
+    if (_stageIfu)
+        buffer->addIfu(k, lell, w);
+    else
+        LockFree::add(_ifu[k][lell], w);
+}
+
+////////////////////////////////////////////////////////////////////
+
 void FluxRecorder::detect(PhotonPacket* pp, int l, double distance)
 {
     // abort if we're not recording integrated fluxes and the photon packet arrives outside of the frame
     if (!_includeFluxDensity && l < 0) return;
 
+    // get the staging buffer for this thread, initializing it if needed
+    StagingBuffer* buffer = _stagingBuffers.local();
+    if (!buffer->isInitialized()) buffer->initialize(_sed, _stageIfu ? _ifu.size() : 0);
+
     // get the photon packet's redshifted wavelength
     double wavelength = pp->wavelength() * (1. + _redshift);
 
@@ -221,7 +247,7 @@ void FluxRecorder::detect(PhotonPacket* pp, int l, double distance)
             }
             else
             {
-                tau = _ms->opticalDepth(pp, distance);
+                tau = _ms->observedOpticalDepth(pp, distance);
                 pp->setObservedOpticalDepth(tau);
             }
             Lext *= exp(-tau);
@@ -235,7 +261,7 @@ void FluxRecorder::detect(PhotonPacket* pp, int l, double distance)
         {
             if (_recordTotalOnly)
             {
-                LockFree::add(_sed[Total][ell], Lext);
+                buffer->addSed(Total, ell, Lext);
             }
             else
             {
@@ -243,29 +269,29 @@ void FluxRecorder::detect(PhotonPacket* pp, int l, double distance)
                 {
                     if (numScatt == 0)
                     {
-                        LockFree::add(_sed[Transparent][ell], L);
-                        LockFree::add(_sed[PrimaryDirect][ell], Lext);
+                        buffer->addSed(Transparent, ell, L);
+                        buffer->addSed(PrimaryDirect, ell, Lext);
                     }
                     else
                     {
-                        LockFree::add(_sed[PrimaryScattered][ell], Lext);
+                        buffer->addSed(PrimaryScattered, ell, Lext);
                         if (numScatt <= _numScatteringLevels)
-                            LockFree::add(_sed[PrimaryScatteredLevel + numScatt - 1][ell], Lext);
+                            buffer->addSed(PrimaryScatteredLevel + numScatt - 1, ell, Lext);
                     }
                 }
                 else
                 {
                     if (numScatt == 0)
-                        LockFree::add(_sed[SecondaryDirect][ell], Lext);
+                        buffer->addSed(SecondaryDirect, ell, Lext);
                     else
-                        LockFree::add(_sed[SecondaryScattered][ell], Lext);
+                        buffer->addSed(SecondaryScattered, ell, Lext);
                 }
             }
             if (_recordPolarization)
             {
-                LockFree::add(_sed[TotalQ][ell], Lext * pp->stokesQ());
-                LockFree::add(_sed[TotalU][ell], Lext * pp->stokesU());
-                LockFree::add(_sed[TotalV][ell], Lext * pp->stokesV());
+                buffer->addSed(TotalQ, ell, Lext * pp->stokesQ());
+                buffer->addSed(TotalU, ell, Lext * pp->stokesU());
+                buffer->addSed(TotalV, ell, Lext * pp->stokesV());
             }
         }
 
@@ -276,7 +302,7 @@ void FluxRecorder::detect(PhotonPacket* pp, int l, double distance)
 
             if (_recordTotalOnly)
             {
-                LockFree::add(_ifu[Total][lell], Lext);
+                addIfu(buffer, Total, lell, Lext);
             }
             else
             {
@@ -284,32 +310,35 @@ void FluxRecorder::detect(PhotonPacket* pp, int l, double distance)
                 {
                     if (numScatt == 0)
                     {
-                        LockFree::add(_ifu[Transparent][lell], L);
-                        LockFree::add(_ifu[PrimaryDirect][lell], Lext);
+                        addIfu(buffer, Transparent, lell, L);
+                        addIfu(buffer, PrimaryDirect, lell, Lext);
                     }
                     else
                     {
-                        LockFree::add(_ifu[PrimaryScattered][lell], Lext);
+                        addIfu(buffer, PrimaryScattered, lell, Lext);
                         if (numScatt <= _numScatteringLevels)
-                            LockFree::add(_ifu[PrimaryScatteredLevel + numScatt - 1][lell], Lext);
+                            addIfu(buffer, PrimaryScatteredLevel + numScatt - 1, lell, Lext);
                     }
                 }
                 else
                 {
                     if (numScatt == 0)
-                        LockFree::add(_ifu[SecondaryDirect][lell], Lext);
+                        addIfu(buffer, SecondaryDirect, lell, Lext);
                     else
-                        LockFree::add(_ifu[SecondaryScattered][lell], Lext);
+                        addIfu(buffer, SecondaryScattered, lell, Lext);
                 }
             }
             if (_recordPolarization)
             {
-                LockFree::add(_ifu[TotalQ][lell], Lext * pp->stokesQ());
-                LockFree::add(_ifu[TotalU][lell], Lext * pp->stokesU());
-                LockFree::add(_ifu[TotalV][lell], Lext * pp->stokesV());
+                addIfu(buffer, TotalQ, lell, Lext * pp->stokesQ());
+                addIfu(buffer, TotalU, lell, Lext * pp->stokesU());
+                addIfu(buffer, TotalV, lell, Lext * pp->stokesV());
             }
         }
 
+        // merge the sparse IFU staging buffers if they grow too large
+        if (_stageIfu && buffer->numIfuEntries() > maxIfuStagingEntries) mergeStagingBuffer(buffer, false);
+
         // record statistics for both SEDs and IFUs
         if (_recordStatistics)
         {
@@ -328,6 +357,9 @@ void FluxRecorder::detect(PhotonPacket* pp, int l, double distance)
 
 void FluxRecorder::flush()
 {
+    // merge the staging buffers from all threads
+    for (StagingBuffer* buffer : _stagingBuffers.all()) mergeStagingBuffer(buffer, true);
+
     // record the dangling contributions from all threads
     for (ContributionList* contributionList : _contributionLists.all())
     {
@@ -338,6 +370,33 @@ void FluxRecorder::flush()
 
 ////////////////////////////////////////////////////////////////////
 
+void FluxRecorder::mergeStagingBuffer(StagingBuffer* buffer, bool includeSed)
+{
+    if (includeSed)
+    {
+        auto& sed = buffer->sed();
+        for (size_t k = 0; k != sed.size(); ++k)
+        {
+            size_t size = sed[k].size();
+            for (size_t ell = 0; ell != size; ++ell)
+            {
+                if (sed[k][ell] != 0.)
+                {
+                    LockFree::add(_sed[k][ell], sed[k][ell]);
+                    sed[k][ell] = 0.;
+                }
+            }
+        }
+    }
+
+    auto& ifu = buffer->ifu();
+    for (size_t k = 0; k != ifu.size(); ++k)
+        for (const auto& bin : ifu[k]) LockFree::add(_ifu[k][bin.first], bin.second);
+    buffer->clearIfu();
+}
+
+////////////////////////////////////////////////////////////////////
+
 void FluxRecorder::calibrateAndWrite()
 {
     // collect recorded data from all processes
@@ -607,6 +666,13 @@ void FluxRecorder::recordContributions(ContributionList* contributionList)
             if (i + 1 == numContributions || contributions[i].ell() != contributions[i + 1].ell()
                 || contributions[i].l() != contributions[i + 1].l())
             {
+                // skip contributions from photon packets that arrived outside of the frame
+                if (contributions[i].l() < 0)
+                {
+                    w = 0;
+                    continue;
+                }
+
                 size_t lell = contributions[i].l() + contributions[i].ell() * _numPixelsInFrame;
                 double wn = 1.;
                 for (int k = 0; k <= maxContributionPower; ++k)
@@ -621,3 +687,23 @@ void FluxRecorder::recordContributions(ContributionList* contributionList)
 }
 
 ////////////////////////////////////////////////////////////////////
+
+void FluxRecorder::saveCheckpoint(CheckpointOutFile& out, string prefix) const
+{
+    for (size_t k = 0; k != _sed.size(); ++k) out.write(prefix + " sed " + std::to_string(k), _sed[k]);
+    for (size_t k = 0; k != _ifu.size(); ++k) out.write(prefix + " ifu " + std::to_string(k), _ifu[k]);
+    for (size_t k = 0; k != _wsed.size(); ++k) out.write(prefix + " wsed " + std::to_string(k), _wsed[k]);
+    for (size_t k = 0; k != _wifu.size(); ++k) out.write(prefix + " wifu " + std::to_string(k), _wifu[k]);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void FluxRecorder::restoreCheckpoint(CheckpointInFile& in, string prefix)
+{
+    for (size_t k = 0; k != _sed.size(); ++k) in.read(prefix + " sed " + std::to_string(k), _sed[k]);
+    for (size_t k = 0; k != _ifu.size(); ++k) in.read(prefix + " ifu " + std::to_string(k), _ifu[k]);
+    for (size_t k = 0; k != _wsed.size(); ++k) in.read(prefix + " wsed " + std::to_string(k), _wsed[k]);
+    for (size_t k = 0; k != _wifu.size(); ++k) in.read(prefix + " wifu " + std::to_string(k), _wifu[k]);
+}
+
+////////////////////////////////////////////////////////////////////
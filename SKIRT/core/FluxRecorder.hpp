@@ -9,6 +9,9 @@
 #include "Array.hpp"
 #include "ThreadLocalMember.hpp"
 #include <tuple>
+#include <unordered_map>
+class CheckpointInFile;
+class CheckpointOutFile;
 class MediumSystem;
 class PhotonPacket;
 class SimulationItem;
@@ -186,7 +189,16 @@ public:
         All other information is obtained directly or indirectly from the photon packet. If there
         is an obscuring medium, the optical depth from the photon packet's last interaction site to
         the instrument is determined and the corresponding extincton is applied to the packet's
-        contribution before detection. */
+        contribution before detection.
+
+        To avoid contention between parallel threads on the shared detector arrays, the detected
+        luminosities are accumulated in a staging buffer private to the calling thread: a dense
+        array for each SED and, if staging of IFU detections has been enabled in the instrument
+        system and there are multiple threads, a sparse map for each IFU cube. Otherwise the IFU
+        contributions are added to the shared detector arrays directly. The staging buffers are
+        merged into the shared detector arrays by the flush() function. If the number of entries in
+        the sparse IFU buffers for a thread grows beyond a fixed maximum, the buffers are merged
+        into the shared arrays immediately, so that the memory requirements remain bounded. */
     void detect(PhotonPacket* pp, int l, double distance = std::numeric_limits<double>::infinity());
 
     /** This function processes and clears any information that may have been buffered by the
@@ -207,6 +219,16 @@ public:
         documentation in the header of this class. */
     void calibrateAndWrite();
 
+    /** This function writes the uncalibrated detector arrays held by this process to the specified
+        checkpoint file, using the specified prefix for the record labels. It should be called from
+        a single thread after the flush() function has been called. */
+    void saveCheckpoint(CheckpointOutFile& out, string prefix) const;
+
+    /** This function restores the uncalibrated detector arrays held by this process from the
+        specified checkpoint file, which must have been written by the saveCheckpoint() function
+        for a recorder with the same configuration. */
+    void restoreCheckpoint(CheckpointInFile& in, string prefix);
+
     //================= Private Types and Functions ===============
 
 private:
@@ -249,6 +271,54 @@ private:
         specified list into the statistics arrays. */
     void recordContributions(ContributionList* contributionList);
 
+    /** Private data structure to accumulate detected luminosities in a given execution thread
+        before they are merged into the shared detector arrays. The SED buffers are dense arrays
+        with the same layout as the corresponding detector arrays; the IFU buffers, if any, are
+        sparse maps keyed on the detector array index. The data structure is initialized by the
+        first call to detect() in the thread. */
+    class StagingBuffer
+    {
+    public:
+        bool isInitialized() const { return !_sed.empty(); }
+        void initialize(const vector<Array>& sed, size_t numIfu)
+        {
+            _sed.resize(sed.size());
+            for (size_t k = 0; k != sed.size(); ++k) _sed[k].resize(sed[k].size());
+            _ifu.resize(numIfu);
+        }
+        void addSed(int k, int ell, double w) { _sed[k][ell] += w; }
+        void addIfu(int k, size_t lell, double w)
+        {
+            auto& map = _ifu[k];
+            auto size = map.size();
+            map[lell] += w;
+            _numIfuEntries += map.size() - size;
+        }
+        size_t numIfuEntries() const { return _numIfuEntries; }
+        vector<Array>& sed() { return _sed; }
+        vector<std::unordered_map<size_t, double>>& ifu() { return _ifu; }
+        void clearIfu()
+        {
+            for (auto& map : _ifu) map.clear();
+            _numIfuEntries = 0;
+        }
+
+    private:
+        vector<Array> _sed;
+        vector<std::unordered_map<size_t, double>> _ifu;
+        size_t _numIfuEntries{0};
+    };
+
+    /** This private helper function adds the specified luminosity contribution to the IFU
+        detector array with index \em k at bin \em lell, either through the specified staging
+        buffer or directly to the shared array depending on whether IFU staging is enabled. */
+    void addIfu(StagingBuffer* buffer, int k, size_t lell, double w);
+
+    /** This private helper function adds the contents of the specified staging buffer to the
+        shared detector arrays and clears the buffer. If \em includeSed is false, only the IFU
+        buffers are merged. The addition is thread-safe. */
+    void mergeStagingBuffer(StagingBuffer* buffer, bool includeSed);
+
     //======================== Data Members ========================
 
 private:
@@ -285,6 +355,7 @@ private:
     MediumSystem* _ms{nullptr};   // pointer to medium system, if present (used only if hasMedium is true)
     bool _recordTotalOnly{true};  // becomes false if recordComponents and hasMedium are both true
     size_t _numPixelsInFrame{0};  // number of pixels in a single IFU frame
+    bool _stageIfu{false};        // true if IFU detections are accumulated in thread-local staging buffers
 
     // detector arrays that need to be calibrated, initialized when configuration is finalized
     vector<Array> _sed;
@@ -296,6 +367,9 @@ private:
 
     // thread-local contribution list
     ThreadLocalMember<ContributionList> _contributionLists;
+
+    // thread-local staging buffers for the detector arrays that need to be calibrated
+    ThreadLocalMember<StagingBuffer> _stagingBuffers;
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -95,6 +95,10 @@ protected:
     /** The destructor deletes the snapshot object, if present. */
     ~ImportedMedium();
 
+    /** This function returns a pointer to the snapshot object imported during setup, for use by
+        subclasses. */
+    const Snapshot* snapshot() const { return _snapshot; }
+
     //======================== Other Functions =======================
 
 public:
@@ -6,6 +6,7 @@
 #include "ImportedSource.hpp"
 #include "Configuration.hpp"
 #include "Constants.hpp"
+#include "EntitySEDCache.hpp"
 #include "FatalError.hpp"
 #include "Log.hpp"
 #include "NR.hpp"
@@ -16,8 +17,11 @@
 #include "Random.hpp"
 #include "SEDFamily.hpp"
 #include "Snapshot.hpp"
+#include "StringUtils.hpp"
+#include "System.hpp"
 #include "VelocityInterface.hpp"
 #include "WavelengthGrid.hpp"
+#include <map>
 
 ////////////////////////////////////////////////////////////////////
 
@@ -72,15 +76,28 @@ void ImportedSource::setupSelfAfter()
 
     // construct a vector with the (normalized) luminosity for each entity
     int M = _snapshot->numEntities();
-    if (M)
+    if (M && useSEDLibrary())
     {
+        setupSEDLibrary();
+    }
+    else if (M)
+    {
+        auto log = find<Log>();
+
+        // create the SED cache if requested
+        if (cacheSEDs())
+        {
+            size_t maxBytes = maxSEDCacheMemoryFraction() * System::availableMemory();
+            _cache = new EntitySEDCache(maxBytes);
+            log->info("Caching the SEDs of imported entities in up to " + StringUtils::toMemSizeString(maxBytes)
+                      + " of memory");
+        }
+
         // integrating over the SED for each entity can be time-consuming, so we do this in parallel
         _Lv.resize(M);
-        auto log = find<Log>();
         log->info("Calculating luminosities for " + std::to_string(M) + " imported entities...");
         log->infoSetElapsed(M);
         find<ParallelFactory>()->parallelDistributed()->call(M, [this, log](size_t firstIndex, size_t numIndices) {
-            Array lambdav, pv, Pv;  // the contents of these arrays is not used, so this could be optimized if needed
             Array params;
 
             while (numIndices)
@@ -88,8 +105,16 @@ void ImportedSource::setupSelfAfter()
                 size_t currentChunkSize = min(logProgressChunkSize, numIndices);
                 for (size_t m = firstIndex; m != firstIndex + currentChunkSize; ++m)
                 {
+                    // calculate the distribution in a new object so that it can be handed to the cache
+                    auto distribution = std::make_shared<EntitySEDCache::Distribution>();
                     _snapshot->parameters(m, params);
-                    _Lv[m] = _sedFamily->cdf(lambdav, pv, Pv, _wavelengthRange, params);
+                    _Lv[m] = _sedFamily->cdf(distribution->lambdav, distribution->pv, distribution->Pv,
+                                             _wavelengthRange, params);
+                    if (_cache && !_cache->isFull())
+                    {
+                        distribution->alias.initialize(distribution->Pv);
+                        _cache->store(m, distribution);
+                    }
                 }
                 log->infoIfElapsed("Calculated luminosities: ", currentChunkSize);
                 firstIndex += currentChunkSize;
@@ -97,10 +122,211 @@ void ImportedSource::setupSelfAfter()
             }
         });
         ProcessManager::sumToAll(_Lv);
+        if (_cache) log->info("  Cached the SEDs of " + std::to_string(_cache->size()) + " entities in this process");
+    }
+
+    // remember the total luminosity and normalize the vector
+    _L = _Lv.sum();
+    if (_L) _Lv /= _L;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void ImportedSource::setupSEDLibrary()
+{
+    auto log = find<Log>();
+    int M = _snapshot->numEntities();
+    int D = _sedFamily->parameterInfo().size();
+    int numBins = numSEDLibraryBins();
+    double power = _sedFamily->luminosityScalingPower();
+
+    // determine the range of each binned parameter (i.e. all but the first one),
+    // using a logarithmic scale if all values are positive
+    vector<double> minv(D, DBL_MAX);
+    vector<double> maxv(D, -DBL_MAX);
+    Array params;
+    for (int m = 0; m != M; ++m)
+    {
+        _snapshot->parameters(m, params);
+        for (int d = 1; d < D; ++d)
+        {
+            minv[d] = min(minv[d], params[d]);
+            maxv[d] = max(maxv[d], params[d]);
+        }
+    }
+    vector<bool> logv(D);
+    for (int d = 1; d < D; ++d)
+    {
+        logv[d] = minv[d] > 0.;
+        if (logv[d])
+        {
+            minv[d] = log10(minv[d]);
+            maxv[d] = log10(maxv[d]);
+        }
+    }
+
+    // return the (possibly logarithmic) value of the given parameter, scaled to the unit interval
+    auto coordinate = [&minv, &maxv, &logv](int d, double value) {
+        double x = logv[d] ? log10(value) : value;
+        double width = maxv[d] - minv[d];
+        return width > 0. ? (x - minv[d]) / width : 0.;
+    };
+
+    // assign each entity to a library bin, numbering the occupied bins in order of first occurrence,
+    // and accumulate the first parameter and the (possibly logarithmic) other parameters for each bin
+    // (the bins are keyed on the list of per-parameter bin indices, because a flattened index could overflow)
+    _libraryIndexv.resize(M);
+    std::map<vector<int>, int> binIndices;  // map from per-parameter bin indices to library bin index
+    vector<int> key(D - 1);                 // per-parameter bin indices for the current entity
+    vector<double> sumv;                    // accumulated parameter values (indexed on bin, d)
+    vector<int> countv;                     // number of entities (indexed on bin)
+    for (int m = 0; m != M; ++m)
+    {
+        _snapshot->parameters(m, params);
+        for (int d = 1; d < D; ++d)
+            key[d - 1] = max(0, min(numBins - 1, static_cast<int>(coordinate(d, params[d]) * numBins)));
+        auto inserted = binIndices.emplace(key, countv.size());
+        int b = inserted.first->second;
+        if (inserted.second)
+        {
+            sumv.resize(sumv.size() + D);
+            countv.push_back(0);
+        }
+        _libraryIndexv[m] = b;
+        countv[b]++;
+        sumv[b * D] += params[0];
+        for (int d = 1; d < D; ++d) sumv[b * D + d] += logv[d] ? log10(params[d]) : params[d];
+    }
+    int numUsed = countv.size();
+    log->info("Assigned " + std::to_string(M) + " imported entities to " + std::to_string(numUsed)
+              + " occupied SED library bins");
+
+    // determine the representative parameter values for each bin
+    vector<double> repv(sumv.size());
+    for (int b = 0; b != numUsed; ++b)
+    {
+        repv[b * D] = sumv[b * D] / countv[b];
+        for (int d = 1; d < D; ++d)
+        {
+            double x = sumv[b * D + d] / countv[b];
+            repv[b * D + d] = logv[d] ? pow(10., x) : x;
+        }
+    }
+
+    // obtain the representative distribution and luminosity for each bin, distributing the work over processes
+    _libraryDistv.resize(numUsed);
+    Array repLv(numUsed);
+    log->info("Calculating SEDs for " + std::to_string(numUsed) + " library bins...");
+    log->infoSetElapsed(numUsed);
+    find<ParallelFactory>()->parallelDistributed()->call(
+        numUsed, [this, log, D, &repv, &repLv](size_t firstIndex, size_t numIndices) {
+            Array params(D);
+            for (size_t b = firstIndex; b != firstIndex + numIndices; ++b)
+            {
+                for (int d = 0; d != D; ++d) params[d] = repv[b * D + d];
+                auto distribution = std::make_shared<EntitySEDCache::Distribution>();
+                repLv[b] = _sedFamily->cdf(distribution->lambdav, distribution->pv, distribution->Pv,
+                                           _wavelengthRange, params);
+                distribution->alias.initialize(distribution->Pv);
+                _libraryDistv[b] = distribution;
+            }
+            log->infoIfElapsed("Calculated library SEDs: ", numIndices);
+        });
+    ProcessManager::sumToAll(repLv);
+    if (ProcessManager::isMultiProc()) communicateLibraryDistributions();
+
+    // calculate the luminosity of each entity by scaling the luminosity of the representative SED for its bin,
+    // and find the entity that deviates most from the representative parameter values in each bin
+    _Lv.resize(M);
+    _libraryLv.resize(numUsed);
+    vector<double> deviationv(numUsed, -1.);
+    vector<int> worstv(numUsed);
+    for (int m = 0; m != M; ++m)
+    {
+        _snapshot->parameters(m, params);
+        int b = _libraryIndexv[m];
+        double x0 = repv[b * D];
+        if (x0 > 0.)
+        {
+            double ratio = params[0] / x0;
+            _Lv[m] = repLv[b] * (power == 1. ? ratio : pow(ratio, power));
+        }
+        _libraryLv[b] += _Lv[m];
 
-        // remember the total luminosity and normalize the vector
-        _L = _Lv.sum();
-        if (_L) _Lv /= _L;
+        double deviation = 0.;
+        for (int d = 1; d < D; ++d)
+            deviation = max(deviation, abs(coordinate(d, params[d]) - coordinate(d, repv[b * D + d])));
+        if (deviation > deviationv[b])
+        {
+            deviationv[b] = deviation;
+            worstv[b] = m;
+        }
+    }
+
+    // calculate the relative luminosity error for the most deviating entity in each bin
+    Array errorv(numUsed);
+    find<ParallelFactory>()->parallelDistributed()->call(
+        numUsed, [this, &worstv, &errorv](size_t firstIndex, size_t numIndices) {
+            Array lambdav, pv, Pv;  // the contents of these arrays is not used
+            Array params;
+            for (size_t b = firstIndex; b != firstIndex + numIndices; ++b)
+            {
+                int m = worstv[b];
+                _snapshot->parameters(m, params);
+                double L = _sedFamily->cdf(lambdav, pv, Pv, _wavelengthRange, params);
+                if (L > 0.) errorv[b] = abs(_Lv[m] - L) / L;
+            }
+        });
+    ProcessManager::sumToAll(errorv);
+    log->info("  Luminosity error for the most deviating entity per bin: mean "
+              + StringUtils::toString(errorv.sum() / numUsed * 100., 'f', 2) + "%, max "
+              + StringUtils::toString(errorv.max() * 100., 'f', 2) + "%");
+}
+
+////////////////////////////////////////////////////////////////////
+
+void ImportedSource::communicateLibraryDistributions()
+{
+    int numUsed = _libraryDistv.size();
+
+    // determine the number of wavelengths in each distribution, which is known only by the calculating process
+    Array lengthv(numUsed);
+    for (int b = 0; b != numUsed; ++b)
+        if (_libraryDistv[b]) lengthv[b] = _libraryDistv[b]->lambdav.size();
+    ProcessManager::sumToAll(lengthv);
+
+    // determine the offset of each distribution in a flat array holding the three arrays for all distributions
+    vector<size_t> offsetv(numUsed + 1);
+    for (int b = 0; b != numUsed; ++b) offsetv[b + 1] = offsetv[b] + 3 * static_cast<size_t>(lengthv[b]);
+
+    // copy the locally calculated distributions into the flat array and sum it across processes
+    Array datav(offsetv[numUsed]);
+    for (int b = 0; b != numUsed; ++b)
+    {
+        if (_libraryDistv[b])
+        {
+            size_t n = lengthv[b];
+            double* target = begin(datav) + offsetv[b];
+            std::copy(begin(_libraryDistv[b]->lambdav), end(_libraryDistv[b]->lambdav), target);
+            std::copy(begin(_libraryDistv[b]->pv), end(_libraryDistv[b]->pv), target + n);
+            std::copy(begin(_libraryDistv[b]->Pv), end(_libraryDistv[b]->Pv), target + 2 * n);
+        }
+    }
+    ProcessManager::sumToAll(datav);
+
+    // construct the distributions calculated by other processes
+    for (int b = 0; b != numUsed; ++b)
+    {
+        if (!_libraryDistv[b])
+        {
+            size_t n = lengthv[b];
+            auto distribution = std::make_shared<EntitySEDCache::Distribution>();
+            distribution->lambdav = Array(begin(datav) + offsetv[b], n);
+            distribution->pv = Array(begin(datav) + offsetv[b] + n, n);
+            distribution->Pv = Array(begin(datav) + offsetv[b] + 2 * n, n);
+            distribution->alias.initialize(distribution->Pv);
+            _libraryDistv[b] = distribution;
+        }
     }
 }
 
@@ -109,6 +335,7 @@ void ImportedSource::setupSelfAfter()
 ImportedSource::~ImportedSource()
 {
     delete _snapshot;
+    delete _cache;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -157,6 +384,17 @@ double ImportedSource::specificLuminosity(double wavelength) const
 {
     if (!_wavelengthRange.containsFuzzy(wavelength)) return 0.;
 
+    // with a library, combine the normalized distribution for each bin with the total luminosity of the bin
+    if (!_libraryDistv.empty())
+    {
+        double sum = 0.;
+        int numUsed = _libraryDistv.size();
+        for (int b = 0; b != numUsed; ++b)
+            sum += _libraryLv[b] * NR::value<NR::interpolateLogLog>(wavelength, _libraryDistv[b]->lambdav,
+                                                                     _libraryDistv[b]->pv);
+        return sum;
+    }
+
     Array params;
     double sum = 0.;
     int M = _snapshot->numEntities();
@@ -203,33 +441,56 @@ namespace
     {
     private:
         // these two variables unambiguously identify a particular entity, even with multiple imported sources
-        int _m{-1};                          // entity index
-        const Snapshot* _snapshot{nullptr};  // snapshot
-        Array _lambdav, _pv, _Pv;            // normalized distributions
+        int _m{-1};                                                 // entity index
+        const Snapshot* _snapshot{nullptr};                         // snapshot
+        std::shared_ptr<const EntitySEDCache::Distribution> _dist;  // normalized distributions
 
     public:
         EntitySED() {}
 
-        // sets the normalized distributions from the SED family if this is a different entity or snapshot
-        void setIfNeeded(int m, const Snapshot* snapshot, const SEDFamily* family, Range range)
+        // sets the given normalized distributions if this is a different entity or snapshot
+        void setIfNeeded(int m, const Snapshot* snapshot,
+                         const std::shared_ptr<const EntitySEDCache::Distribution>& dist)
+        {
+            if (m != _m || snapshot != _snapshot)
+            {
+                _dist = dist;
+                _snapshot = snapshot;
+                _m = m;
+            }
+        }
+
+        // sets the normalized distributions if this is a different entity or snapshot, retrieving them from the
+        // given cache if possible, or otherwise calculating them from the SED family (and storing them in the cache)
+        void setIfNeeded(int m, const Snapshot* snapshot, const SEDFamily* family, Range range, EntitySEDCache* cache)
         {
             if (m != _m || snapshot != _snapshot)
             {
-                Array params;
-                snapshot->parameters(m, params);
-                family->cdf(_lambdav, _pv, _Pv, range, params);
+                _dist = cache ? cache->retrieve(m) : nullptr;
+                if (!_dist)
+                {
+                    auto distribution = std::make_shared<EntitySEDCache::Distribution>();
+                    Array params;
+                    snapshot->parameters(m, params);
+                    family->cdf(distribution->lambdav, distribution->pv, distribution->Pv, range, params);
+                    distribution->alias.initialize(distribution->Pv);
+                    _dist = cache ? cache->store(m, distribution) : distribution;
+                }
                 _snapshot = snapshot;
                 _m = m;
             }
         }
 
         // returns a random wavelength generated from the distribution
-        double generateWavelength(Random* random) const { return random->cdfLogLog(_lambdav, _pv, _Pv); }
+        double generateWavelength(Random* random) const
+        {
+            return random->cdfLogLog(_dist->lambdav, _dist->pv, _dist->Pv, _dist->alias);
+        }
 
         // returns the normalized specific luminosity for the given wavelength
         double specificLuminosity(double lambda) const
         {
-            return NR::value<NR::interpolateLogLog>(lambda, _lambdav, _pv);
+            return NR::value<NR::interpolateLogLog>(lambda, _dist->lambdav, _dist->pv);
         }
     };
 
@@ -280,7 +541,10 @@ void ImportedSource::launch(PhotonPacket* pp, size_t historyIndex, double L) con
     double ws = _Lv[m] / _Wv[m];
 
     // get the normalized regular and cumulative distributions for this entity, if not already available
-    t_sed.setIfNeeded(m, _snapshot, _sedFamily, _wavelengthRange);
+    if (_libraryDistv.empty())
+        t_sed.setIfNeeded(m, _snapshot, _sedFamily, _wavelengthRange, _cache);
+    else
+        t_sed.setIfNeeded(m, _snapshot, _libraryDistv[_libraryIndexv[m]]);
 
     // generate a random wavelength from the SED and/or from the bias distribution
     double lambda, w;
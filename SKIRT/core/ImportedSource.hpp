@@ -7,6 +7,7 @@
 #define IMPORTEDSOURCE_HPP
 
 #include "Array.hpp"
+#include "EntitySEDCache.hpp"
 #include "Range.hpp"
 #include "SEDFamily.hpp"
 #include "Source.hpp"
@@ -37,7 +38,30 @@ class Snapshot;
     for each entity. When this option is enabled, the appropriate Doppler shift is taken into
     account when launching photon packets. Apart from the anisotropy resulting from this optional
     Doppler shift, the radiation emitted by this primary source is always isotropic. It is also
-    always unpolarized. */
+    always unpolarized.
+
+    Snapshots often contain many entities with nearly identical %SED parameters. If the \em
+    useSEDLibrary flag is enabled, the entities are binned in parameter space, in a way similar to
+    the spatial cell libraries used for dust emission (see the SpatialCellLibrary class). Each of
+    the parameters listed by the %SED family, except for the first one, is divided into \em
+    numSEDLibraryBins bins spanning the range of values in the snapshot. The bins are logarithmic
+    if all values of the parameter are positive, and linear otherwise. For each occupied bin, a
+    single %SED is obtained from the family using representative parameter values, i.e. the mean
+    (logarithmic) values of the entities in the bin. The first parameter (usually a mass or some
+    other normalization) is not binned. Instead, the luminosity of each entity is obtained by
+    scaling the luminosity of the representative %SED with the first parameter value of the
+    entity, using the power returned by SEDFamily::luminosityScalingPower(). To give an indication
+    of the accuracy of this approximation, the setup logs the relative luminosity error for the
+    entity that deviates most from the representative parameter values in each bin.
+
+    Obtaining the discretized %SED for an entity from the %SED family can be time-consuming,
+    depending on the family. If the \em cacheSEDs flag is enabled, the normalized spectral
+    distribution calculated for each entity is kept in a cache shared by all execution threads in
+    the process (see the EntitySEDCache class), so that it is calculated at most once as long as it
+    remains in the cache. The cache is populated while calculating the entity luminosities during
+    setup, and subsequently when launching photon packets. The memory used by the cache is limited
+    to the fraction of the available memory specified by the \em maxSEDCacheMemoryFraction
+    property. When the cache is full, the least recently used distributions are evicted. */
 class ImportedSource : public Source
 {
     ITEM_ABSTRACT(ImportedSource, Source, "a primary source imported from snapshot data")
@@ -65,6 +89,30 @@ class ImportedSource : public Source
         PROPERTY_ITEM(sedFamily, SEDFamily, "the SED family for assigning spectra to the imported sources")
         ATTRIBUTE_DEFAULT_VALUE(sedFamily, "BlackBodySEDFamily")
 
+        PROPERTY_BOOL(useSEDLibrary, "use a library of SEDs binned in parameter space")
+        ATTRIBUTE_DEFAULT_VALUE(useSEDLibrary, "false")
+        ATTRIBUTE_DISPLAYED_IF(useSEDLibrary, "Level3")
+
+        PROPERTY_INT(numSEDLibraryBins, "the number of library bins for each binned SED parameter")
+        ATTRIBUTE_MIN_VALUE(numSEDLibraryBins, "1")
+        ATTRIBUTE_MAX_VALUE(numSEDLibraryBins, "10000")
+        ATTRIBUTE_DEFAULT_VALUE(numSEDLibraryBins, "50")
+        ATTRIBUTE_RELEVANT_IF(numSEDLibraryBins, "useSEDLibrary")
+        ATTRIBUTE_DISPLAYED_IF(numSEDLibraryBins, "Level3")
+
+        PROPERTY_BOOL(cacheSEDs, "cache the discretized SED of each imported entity")
+        ATTRIBUTE_DEFAULT_VALUE(cacheSEDs, "false")
+        ATTRIBUTE_RELEVANT_IF(cacheSEDs, "!useSEDLibrary")
+        ATTRIBUTE_DISPLAYED_IF(cacheSEDs, "Level3")
+
+        PROPERTY_DOUBLE(maxSEDCacheMemoryFraction,
+                        "the maximum fraction of the available memory used for caching SEDs")
+        ATTRIBUTE_MIN_VALUE(maxSEDCacheMemoryFraction, "]0")
+        ATTRIBUTE_MAX_VALUE(maxSEDCacheMemoryFraction, "1]")
+        ATTRIBUTE_DEFAULT_VALUE(maxSEDCacheMemoryFraction, "0.25")
+        ATTRIBUTE_RELEVANT_IF(maxSEDCacheMemoryFraction, "cacheSEDs")
+        ATTRIBUTE_DISPLAYED_IF(maxSEDCacheMemoryFraction, "Level3")
+
     ITEM_END()
 
     //============= Construction - Setup - Destruction =============
@@ -78,7 +126,10 @@ protected:
 
         Finally, the function constructs a vector with the luminosities (integrated over the
         primary source wavelength range) for all imported entities. This information is used when
-        deciding how many photon packets should be launched from each entity. */
+        deciding how many photon packets should be launched from each entity. If the \em cacheSEDs
+        flag is enabled, the spectral distributions calculated in the process are stored in the
+        %SED cache for later use, as long as the cache is not full. If the \em useSEDLibrary flag
+        is enabled, the function calls setupSEDLibrary() instead. */
     void setupSelfAfter() override;
 
     /** This function constructs a new Snapshot object of the type appropriate for the subclass,
@@ -86,7 +137,7 @@ protected:
         object is transferred to the caller. */
     virtual Snapshot* createAndOpenSnapshot() = 0;
 
-    /** The destructor deletes the snapshot object, if present. */
+    /** The destructor deletes the snapshot object and the %SED cache, if present. */
     ~ImportedSource();
 
     //======================== Other Functions =======================
@@ -115,7 +166,8 @@ public:
     /** This function returns the specific luminosity \f$L_\lambda\f$ (i.e. radiative power per
          unit of wavelength) of the source at the specified wavelength, or zero if the wavelength is
          outside the wavelength range of primary sources (configured for the source system as a
-         whole) or if the source simply does not emit at the wavelength. */
+         whole) or if the source simply does not emit at the wavelength. If the \em useSEDLibrary
+         flag is enabled, the specific luminosity is obtained from the library SEDs. */
     double specificLuminosity(double wavelength) const override;
 
     /** This function performs some preparations for launching photon packets. It is called in
@@ -146,7 +198,10 @@ public:
          family configured for this source. In fact, the function sets up a thread-local object
          that caches the spectral distribution for an entity between consecutive invocations of the
          launch() function. This works even if there are multiple sources of this type because each
-         thread handles a single photon packet at a time.
+         thread handles a single photon packet at a time. If the \em cacheSEDs flag is enabled, the
+         distribution is retrieved from the shared %SED cache, or calculated and stored in the cache
+         if it is not yet present. If the \em useSEDLibrary flag is enabled, the function simply
+         uses the distribution of the library bin for the entity.
 
          Subsequently, the function samples a wavelength from the entity's SED, properly handling
          the configured wavelength biasing, and asks the Snapshot object to generate a random
@@ -162,6 +217,17 @@ public:
     //======================== Data Members ========================
 
 private:
+    /** This function bins the imported entities in parameter space, obtains a representative %SED
+        for each occupied bin, and sets the luminosity of each entity by scaling the luminosity of
+        the representative %SED for its bin, as described in the class header. It also logs the
+        luminosity error for the most deviating entity in each bin. */
+    void setupSEDLibrary();
+
+    /** This function is called by setupSEDLibrary() in a multi-process run, after each process has
+        calculated the representative distributions for its share of the library bins. It sends the
+        distributions to all other processes, so that each process holds the complete library. */
+    void communicateLibraryDistributions();
+
     // wavelength information initialized during setup
     bool _oligochromatic{false};                         // true if the simulation is oligochromatic
     Range _wavelengthRange;                              // the wavelength range configured for all primary sources
@@ -171,8 +237,14 @@ private:
 
     // snapshot information initialized during setup
     Snapshot* _snapshot{nullptr};
-    double _L{0};  // the total bolometric luminosity of all entities (absolute number)
-    Array _Lv;     // the relative bolometric luminosity of each entity (normalized to unity)
+    double _L{0};                     // the total bolometric luminosity of all entities (absolute number)
+    Array _Lv;                        // the relative bolometric luminosity of each entity (normalized to unity)
+    EntitySEDCache* _cache{nullptr};  // the cache of spectral distributions, if enabled
+
+    // SED library information initialized during setup, if enabled
+    vector<int> _libraryIndexv;  // the library bin index for each entity
+    vector<std::shared_ptr<const EntitySEDCache::Distribution>> _libraryDistv;  // distribution for each bin
+    Array _libraryLv;  // the total bolometric luminosity of the entities in each bin (absolute number)
 
     // intialized by prepareForLaunch()
     Array _Wv;           // the relative launch weight for each entity (normalized to unity)
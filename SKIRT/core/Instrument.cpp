@@ -67,3 +67,17 @@ void Instrument::write()
 }
 
 ////////////////////////////////////////////////////////////////////
+
+void Instrument::saveCheckpoint(CheckpointOutFile& out) const
+{
+    _recorder->saveCheckpoint(out, instrumentName());
+}
+
+////////////////////////////////////////////////////////////////////
+
+void Instrument::restoreCheckpoint(CheckpointInFile& in)
+{
+    _recorder->restoreCheckpoint(in, instrumentName());
+}
+
+////////////////////////////////////////////////////////////////////
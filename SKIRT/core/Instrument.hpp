@@ -10,6 +10,8 @@
 #include "Position.hpp"
 #include "SimulationItem.hpp"
 #include "WavelengthGrid.hpp"
+class CheckpointInFile;
+class CheckpointOutFile;
 class FluxRecorder;
 class PhotonPacket;
 
@@ -100,6 +102,16 @@ public:
         with this instrument. */
     void write();
 
+    /** This function writes the detector arrays recorded by this instrument to the specified
+        checkpoint file. It simply calls the corresponding function of the FluxRecorder instance
+        associated with this instrument, using the instrument name as a label prefix. */
+    void saveCheckpoint(CheckpointOutFile& out) const;
+
+    /** This function restores the detector arrays recorded by this instrument from the specified
+        checkpoint file. It simply calls the corresponding function of the FluxRecorder instance
+        associated with this instrument. */
+    void restoreCheckpoint(CheckpointInFile& in);
+
     /** This function returns true if the receiving instrument has the same observer type, position
         and viewing direction as the preceding instrument in the instrument system. This
         information is determined and cached by the determineSameObserverAsPreceding() function,
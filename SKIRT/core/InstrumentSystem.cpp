@@ -36,3 +36,17 @@ void InstrumentSystem::write()
 }
 
 ////////////////////////////////////////////////////////////////////
+
+void InstrumentSystem::saveCheckpoint(CheckpointOutFile& out) const
+{
+    for (Instrument* instrument : _instruments) instrument->saveCheckpoint(out);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void InstrumentSystem::restoreCheckpoint(CheckpointInFile& in)
+{
+    for (Instrument* instrument : _instruments) instrument->restoreCheckpoint(in);
+}
+
+////////////////////////////////////////////////////////////////////
@@ -14,7 +14,13 @@
 /** An InstrumentSystem instance keeps a list of zero or more instruments and an optional default
     wavelength grid that will be used by an instrument unless it specifies its own wavelength grid.
     The instruments can be of various nature and do not need to be located at the same observing
-    position. */
+    position.
+
+    The \em stageIfuDetections flag specifies whether the surface brightness contributions detected
+    by the instruments are first accumulated in sparse buffers private to each execution thread
+    before being added to the shared IFU detector arrays. Staging may reduce contention between a
+    large number of parallel threads on the shared arrays, at the cost of a hash map lookup for each
+    detected contribution. By default, the contributions are added to the shared arrays directly. */
 class InstrumentSystem : public SimulationItem
 {
     ITEM_CONCRETE(InstrumentSystem, SimulationItem, "an instrument system")
@@ -25,6 +31,10 @@ class InstrumentSystem : public SimulationItem
         ATTRIBUTE_REQUIRED_IF(defaultWavelengthGrid, "!Level2")
         ATTRIBUTE_INSERT(defaultWavelengthGrid, "defaultWavelengthGrid:DefaultInstrumentWavelengthGrid")
 
+        PROPERTY_BOOL(stageIfuDetections, "accumulate detected surface brightness in per-thread buffers")
+        ATTRIBUTE_DEFAULT_VALUE(stageIfuDetections, "false")
+        ATTRIBUTE_DISPLAYED_IF(stageIfuDetections, "Level3")
+
         PROPERTY_ITEM_LIST(instruments, Instrument, "the instruments")
         ATTRIBUTE_DEFAULT_VALUE(instruments, "SEDInstrument")
         ATTRIBUTE_REQUIRED_IF(instruments, "false")
@@ -49,6 +59,15 @@ public:
     /** This function writes the recorded data for the complete instrument system to a set of
         files. It calls the write() function for each of the instruments. */
     void write();
+
+    /** This function writes the data recorded by the complete instrument system to the specified
+        checkpoint file. It calls the saveCheckpoint() function for each of the instruments. */
+    void saveCheckpoint(CheckpointOutFile& out) const;
+
+    /** This function restores the data recorded by the complete instrument system from the
+        specified checkpoint file. It calls the restoreCheckpoint() function for each of the
+        instruments. */
+    void restoreCheckpoint(CheckpointInFile& in);
 };
 
 ////////////////////////////////////////////////////////////////////
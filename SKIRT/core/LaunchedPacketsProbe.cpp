@@ -4,6 +4,8 @@
 ///////////////////////////////////////////////////////////////// */
 
 #include "LaunchedPacketsProbe.hpp"
+#include "CheckpointInFile.hpp"
+#include "CheckpointOutFile.hpp"
 #include "Configuration.hpp"
 #include "LockFree.hpp"
 #include "PhotonPacket.hpp"
@@ -72,3 +74,17 @@ void LaunchedPacketsProbe::probeRun()
 }
 
 ////////////////////////////////////////////////////////////////////
+
+void LaunchedPacketsProbe::saveCheckpoint(CheckpointOutFile& out) const
+{
+    out.write(itemName() + " counts", _counts.data());
+}
+
+////////////////////////////////////////////////////////////////////
+
+void LaunchedPacketsProbe::restoreCheckpoint(CheckpointInFile& in)
+{
+    in.read(itemName() + " counts", _counts.data());
+}
+
+////////////////////////////////////////////////////////////////////
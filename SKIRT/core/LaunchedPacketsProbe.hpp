@@ -52,6 +52,12 @@ public:
     /** This function outputs the photon packet counts after the simulation run. */
     void probeRun() override;
 
+    /** This function writes the photon packet counters to the specified checkpoint file. */
+    void saveCheckpoint(CheckpointOutFile& out) const override;
+
+    /** This function restores the photon packet counters from the specified checkpoint file. */
+    void restoreCheckpoint(CheckpointInFile& in) override;
+
     //======================== Data Members ========================
 
 private:
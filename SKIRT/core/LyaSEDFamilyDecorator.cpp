@@ -33,6 +33,13 @@ vector<SnapshotParameter> LyaSEDFamilyDecorator::parameterInfo() const
 
 //////////////////////////////////////////////////////////////////////
 
+double LyaSEDFamilyDecorator::luminosityScalingPower() const
+{
+    return sedFamilyOriginal()->luminosityScalingPower();
+}
+
+//////////////////////////////////////////////////////////////////////
+
 Range LyaSEDFamilyDecorator::intrinsicWavelengthRange() const
 {
     Range range = sedFamilyOriginal()->intrinsicWavelengthRange();
@@ -59,6 +59,11 @@ public:
         and a human-readable descripton for the parameter. */
     vector<SnapshotParameter> parameterInfo() const override;
 
+    /** This function passes on the luminosity scaling power of the original %SED family. Because
+        the decorated %SED is obtained by redistributing a fixed fraction of the original ionizing
+        luminosity, it scales with the first parameter in the same way as the original %SED. */
+    double luminosityScalingPower() const override;
+
     /** This function returns the intrinsic wavelength range of the %SED family. For this
         decorator, it returns the union of the intrinsic ranges of the original %SED family and the
         Lyman-alpha %SED configured by the user, even if the configured conversion fraction is
@@ -32,6 +32,41 @@ double MaterialMix::asymmpar(double /*lambda*/) const
 
 ////////////////////////////////////////////////////////////////////
 
+int MaterialMix::indexForLambda(double /*lambda*/) const
+{
+    return -1;
+}
+
+////////////////////////////////////////////////////////////////////
+
+double MaterialMix::sectionSca(double lambda, int /*ell*/) const
+{
+    return sectionSca(lambda);
+}
+
+////////////////////////////////////////////////////////////////////
+
+double MaterialMix::sectionExt(double lambda, int /*ell*/) const
+{
+    return sectionExt(lambda);
+}
+
+////////////////////////////////////////////////////////////////////
+
+double MaterialMix::albedo(double lambda, int /*ell*/) const
+{
+    return albedo(lambda);
+}
+
+////////////////////////////////////////////////////////////////////
+
+double MaterialMix::asymmpar(double lambda, int /*ell*/) const
+{
+    return asymmpar(lambda);
+}
+
+////////////////////////////////////////////////////////////////////
+
 double MaterialMix::phaseFunctionValueForCosine(double /*lambda*/, double /*costheta*/) const
 {
     return 1.;
@@ -206,6 +206,44 @@ public:
         implementation in this base class returns 0. */
     virtual double asymmpar(double lambda) const;
 
+    //======== Basic material properties for a resolved wavelength index =======
+
+public:
+    /** This function returns the index \f$\ell\f$ of the specified wavelength \f$\lambda\f$ in
+        the grid on which this material mix tabulates its basic optical properties, or -1 if these
+        properties are not tabulated on a wavelength grid. The index is specific to the material
+        mix on which the function is invoked. It can be passed to the index-based versions of the
+        functions returning the basic material properties, so that a caller needing multiple
+        properties for the same wavelength performs the (relatively expensive) wavelength lookup
+        only once. The default implementation in this base class returns -1. */
+    virtual int indexForLambda(double lambda) const;
+
+    /** This function returns the scattering cross section per entity
+        \f$\varsigma^{\text{sca}}_{\lambda}\f$ at wavelength \f$\lambda\f$, given the index
+        \f$\ell\f$ returned by the indexForLambda() function of this material mix for that same
+        wavelength. The default implementation in this base class ignores the index and returns
+        the value of sectionSca(double). */
+    virtual double sectionSca(double lambda, int ell) const;
+
+    /** This function returns the total extinction cross section per entity
+        \f$\varsigma^{\text{ext}}_{\lambda}\f$ at wavelength \f$\lambda\f$, given the index
+        \f$\ell\f$ returned by the indexForLambda() function of this material mix for that same
+        wavelength. The default implementation in this base class ignores the index and returns
+        the value of sectionExt(double). */
+    virtual double sectionExt(double lambda, int ell) const;
+
+    /** This function returns the scattering albedo \f$\varpi_\lambda\f$ at wavelength
+        \f$\lambda\f$, given the index \f$\ell\f$ returned by the indexForLambda() function of
+        this material mix for that same wavelength. The default implementation in this base class
+        ignores the index and returns the value of albedo(double). */
+    virtual double albedo(double lambda, int ell) const;
+
+    /** This function returns the scattering asymmetry parameter \f$g_\lambda\f$ at wavelength
+        \f$\lambda\f$, given the index \f$\ell\f$ returned by the indexForLambda() function of
+        this material mix for that same wavelength. The default implementation in this base class
+        ignores the index and returns the value of asymmpar(double). */
+    virtual double asymmpar(double lambda, int ell) const;
+
     //======== Scattering with material phase function =======
 
 public:
@@ -4,6 +4,8 @@
 ///////////////////////////////////////////////////////////////// */
 
 #include "MediumSystem.hpp"
+#include "CheckpointInFile.hpp"
+#include "CheckpointOutFile.hpp"
 #include "Configuration.hpp"
 #include "DensityInCellInterface.hpp"
 #include "DisjointWavelengthGrid.hpp"
@@ -14,11 +16,13 @@
 #include "NR.hpp"
 #include "Parallel.hpp"
 #include "ParallelFactory.hpp"
+#include "ParticleMedium.hpp"
 #include "PhotonPacket.hpp"
 #include "ProcessManager.hpp"
 #include "Random.hpp"
 #include "ShortArray.hpp"
 #include "StringUtils.hpp"
+#include "System.hpp"
 
 ////////////////////////////////////////////////////////////////////
 
@@ -26,6 +30,13 @@ namespace
 {
     // maximum number of cell densities calculated between two invocations of infoIfElapsed()
     const size_t logProgressChunkSize = 10000;
+
+    // number of particles per chunk and number of chunks per round when depositing particle masses into cells
+    const size_t depositChunkSize = 4096;
+    const size_t depositChunksPerRound = 256;
+
+    // maximum number of radiation field bins in a message forwarded to another process in data-parallel mode
+    const size_t maxForwardedBins = 1 << 16;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -47,39 +58,46 @@ void MediumSystem::setupSelfAfter()
     size_t allocatedBytes = 0;
     _state1v.resize(_numCells);
     allocatedBytes += _state1v.size() * sizeof(State1);
-    _state2vv.resize(_numCells * _numMedia);
-    allocatedBytes += _state2vv.size() * sizeof(State2);
+    _nvv.resize(_numCells * _numMedia);
+    allocatedBytes += _nvv.size() * sizeof(double);
+    for (auto medium : _media)
+        if (medium->hasVariableMix()) _hasMixPerCell = true;
+    _mixv.resize(_hasMixPerCell ? _numCells * _numMedia : _numMedia);
+    allocatedBytes += _mixv.size() * sizeof(const MaterialMix*);
 
-    // radiation field
-    if (_config->hasRadiationField())
-    {
-        _wavelengthGrid = _config->radiationFieldWLG();
-        _rf1.resize(_numCells, _wavelengthGrid->numBins());
-        allocatedBytes += _rf1.size() * sizeof(double);
+    // ----- calculate cell densities, bulk velocities, and volumes in parallel -----
 
-        if (_config->hasSecondaryRadiationField())
+    auto dic = _grid->interface<DensityInCellInterface>(0, false);  // optional fast-track interface for densities
+
+    // if requested, deposit the particle masses into the cells for smoothed particle media;
+    // for each medium, hold the number of material entities per cell, or an empty array if not deposited
+    vector<Array> depositedv(_numMedia);
+    bool needSamples = !dic;
+    if (!dic && _config->depositParticleMass())
+    {
+        needSamples = false;
+        for (int h = 0; h != _numMedia; ++h)
         {
-            _rf2.resize(_numCells, _wavelengthGrid->numBins());
-            _rf2c.resize(_numCells, _wavelengthGrid->numBins());
-            allocatedBytes += 2 * _rf2.size() * sizeof(double);
+            auto particleMedium = dynamic_cast<const ParticleMedium*>(_media[h]);
+            if (particleMedium)
+                depositParticles(particleMedium, depositedv[h]);
+            else
+                needSamples = true;
         }
     }
 
-    // inform user
-    log->info(typeAndName() + " allocated " + StringUtils::toMemSizeString(allocatedBytes) + " of memory");
-
-    // ----- calculate cell densities, bulk velocities, and volumes in parallel -----
-
     log->info("Calculating densities for " + std::to_string(_numCells) + " cells...");
-    auto dic = _grid->interface<DensityInCellInterface>(0, false);  // optional fast-track interface for densities
+    auto random = find<Random>();
     int numSamples = _config->numDensitySamples();
     bool oligo = _config->oligochromatic();
     int magneticindex = -1;
     for (int h = 0; h != _numMedia; ++h)
         if (_media[h]->hasMagneticField()) magneticindex = h;
     log->infoSetElapsed(_numCells);
+    random->startSeries();
     parfac->parallelDistributed()->call(
-        _numCells, [this, log, dic, numSamples, oligo, magneticindex](size_t firstIndex, size_t numIndices) {
+        _numCells, [this, log, dic, &depositedv, needSamples, random, numSamples, oligo,
+                    magneticindex](size_t firstIndex, size_t numIndices) {
             ShortArray<8> nsumv(_numMedia);
 
             while (numIndices)
@@ -87,21 +105,37 @@ void MediumSystem::setupSelfAfter()
                 size_t currentChunkSize = min(logProgressChunkSize, numIndices);
                 for (size_t m = firstIndex; m != firstIndex + currentChunkSize; ++m)
                 {
+                    // volume
+                    state(m).V = _grid->volume(m);
 
-                    // density: use optional fast-track interface or sample 100 random positions within the cell
+                    // density: use optional fast-track interface, deposited particle masses,
+                    //          and/or sample 100 random positions within the cell
                     if (dic)
                     {
-                        for (int h = 0; h != _numMedia; ++h) state(m, h).n = dic->numberDensity(h, m);
+                        for (int h = 0; h != _numMedia; ++h) density(m, h) = dic->numberDensity(h, m);
                     }
                     else
                     {
-                        nsumv.clear();
-                        for (int n = 0; n < numSamples; n++)
+                        if (needSamples)
+                        {
+                            nsumv.clear();
+                            random->startStream(m);
+                            for (int n = 0; n < numSamples; n++)
+                            {
+                                Position bfr = _grid->randomPositionInCell(m);
+                                for (int h = 0; h != _numMedia; ++h)
+                                    if (depositedv[h].size() == 0) nsumv[h] += _media[h]->numberDensity(bfr);
+                            }
+                            random->endStream();
+                        }
+                        for (int h = 0; h != _numMedia; ++h)
                         {
-                            Position bfr = _grid->randomPositionInCell(m);
-                            for (int h = 0; h != _numMedia; ++h) nsumv[h] += _media[h]->numberDensity(bfr);
+                            // guard against negative densities, as does the density interpolation for particles
+                            if (depositedv[h].size() != 0)
+                                density(m, h) = state(m).V > 0. ? max(0., depositedv[h][m] / state(m).V) : 0.;
+                            else
+                                density(m, h) = nsumv[h] / numSamples;
                         }
-                        for (int h = 0; h != _numMedia; ++h) state(m, h).n = nsumv[h] / numSamples;
                     }
 
                     // bulk velocity: weighted average at cell center; assumes densities have been calculated
@@ -113,8 +147,8 @@ void MediumSystem::setupSelfAfter()
                         Vec v;
                         for (int h = 0; h != _numMedia; ++h)
                         {
-                            n += state(m, h).n;
-                            v += state(m, h).n * _media[h]->bulkVelocity(bfr);
+                            n += density(m, h);
+                            v += density(m, h) * _media[h]->bulkVelocity(bfr);
                         }
                         if (n > 0.) state(m).v = v / n;  // leave bulk velocity at zero if cell has no material
                     }
@@ -125,9 +159,6 @@ void MediumSystem::setupSelfAfter()
                         Position bfr = _grid->centralPositionInCell(m);
                         state(m).B = _media[magneticindex]->magneticField(bfr);
                     }
-
-                    // volume
-                    state(m).V = _grid->volume(m);
                 }
                 log->infoIfElapsed("Calculated cell densities: ", currentChunkSize);
                 firstIndex += currentChunkSize;
@@ -142,15 +173,202 @@ void MediumSystem::setupSelfAfter()
 
     // ----- obtain the material mix pointers -----
 
-    for (int m = 0; m != _numCells; ++m)
+    if (_hasMixPerCell)
     {
-        Position bfr = _grid->centralPositionInCell(m);
-        for (int h = 0; h != _numMedia; ++h) state(m, h).mix = _media[h]->mix(bfr);
+        for (int m = 0; m != _numCells; ++m)
+        {
+            Position bfr = _grid->centralPositionInCell(m);
+            for (int h = 0; h != _numMedia; ++h) _mixv[m * _numMedia + h] = _media[h]->mix(bfr);
+        }
+    }
+    else
+    {
+        for (int h = 0; h != _numMedia; ++h) _mixv[h] = _media[h]->mix();
+    }
+
+    // ----- partition the radiation field over the processes in data-parallel mode -----
+
+    partitionCells();
+
+    // radiation field
+    bool single = _config->hasRadiationField() && _config->radiationFieldSinglePrecision();
+    size_t savedBytes = 0;
+    if (_config->hasRadiationField())
+    {
+        _wavelengthGrid = _config->radiationFieldWLG();
+        int numBins = _wavelengthGrid->numBins();
+        _rf1.resize(_firstLocalCell, _numLocalCells, numBins, single);
+        allocatedBytes += _rf1.allocatedBytes();
+
+        if (_config->hasSecondaryRadiationField())
+        {
+            _rf2.resize(_firstLocalCell, _numLocalCells, numBins, single);
+            _rf2c.resize(_firstLocalCell, _numLocalCells, numBins, single);
+            allocatedBytes += _rf2.allocatedBytes() + _rf2c.allocatedBytes();
+        }
+        if (single) savedBytes = (_rf1.size() + _rf2.size() + _rf2c.size()) * (sizeof(double) - sizeof(float));
+    }
+
+    // inform user
+    log->info(typeAndName() + " allocated " + StringUtils::toMemSizeString(allocatedBytes) + " of memory");
+    if (single)
+        log->info("  Storing the radiation field in single precision saved "
+                  + StringUtils::toMemSizeString(savedBytes) + " of memory");
+    if (_dataParallel)
+        log->info("  Storing the radiation field for " + std::to_string(_numLocalCells) + " out of "
+                  + std::to_string(_numCells) + " spatial cells in process " + std::to_string(ProcessManager::rank())
+                  + " out of " + std::to_string(ProcessManager::size()));
+
+    // ----- determine the radiation field accumulation mode -----
+
+    if (_config->hasRadiationField())
+    {
+        using Mode = RadiationFieldOptions::AccumulationMode;
+        _rfMode = _config->radiationFieldAccumulationMode();
+        _rfMaxSparseBins = _config->maxSparseRadiationFieldBufferBins();
+
+        // the maximum memory needed for dense buffers across all threads
+        // (only one table is targeted per segment, so each buffer has the size of a single table)
+        size_t numThreads = parfac->maxThreadCount();
+        size_t denseBytes = numThreads * _rf1.size() * sizeof(double);
+
+        // in automatic mode, select dense buffers if they fit in the memory budget
+        if (_rfMode == Mode::Automatic)
+        {
+            double budget = _config->maxRadiationFieldBufferMemoryFraction() * System::availableMemory();
+            _rfMode = denseBytes <= budget ? Mode::ThreadLocalDense : Mode::ThreadLocalSparse;
+        }
+
+        // there is no point in thread-local accumulation with a single thread,
+        // except when the shared tables have single precision, in which case we always need
+        // to accumulate contributions in double precision before adding them to the shared tables;
+        // in data-parallel mode, we always need sparse buffers because a dense buffer would cover all cells
+        if (_dataParallel)
+        {
+            _rfMode = Mode::ThreadLocalSparse;
+        }
+        else if (single)
+        {
+            if (_rfMode == Mode::Shared) _rfMode = Mode::ThreadLocalSparse;
+        }
+        else if (numThreads == 1)
+            _rfMode = Mode::Shared;
+
+        switch (_rfMode)
+        {
+            case Mode::Shared:
+                log->info("Radiation field contributions are accumulated in the shared table");
+                break;
+            case Mode::ThreadLocalDense:
+                log->info("Radiation field contributions are accumulated in dense per-thread buffers using up to "
+                          + StringUtils::toMemSizeString(denseBytes) + " of memory");
+                break;
+            case Mode::ThreadLocalSparse:
+            case Mode::Automatic:
+                _rfMode = Mode::ThreadLocalSparse;
+                log->info("Radiation field contributions are accumulated in sparse per-thread buffers with up to "
+                          + std::to_string(_rfMaxSparseBins) + " bins each");
+                break;
+        }
     }
 }
 
 ////////////////////////////////////////////////////////////////////
 
+void MediumSystem::partitionCells()
+{
+    _dataParallel = _config->hasRadiationField() && _config->dataParallel() && ProcessManager::isMultiProc();
+    _rfParentThread = std::this_thread::get_id();
+    int numProcs = _dataParallel ? ProcessManager::size() : 1;
+    if (numProcs > _numCells) throw FATALERROR("There are more processes than spatial cells in data-parallel mode");
+
+    // estimate the relative work for each cell as the sum of its fraction of the number of cells and
+    // its fraction of the total material mass; the latter is omitted if there is no material at all
+    Array cumWorkv(_numCells + 1);
+    if (numProcs > 1)
+    {
+        Array massv(_numCells);
+        for (int m = 0; m != _numCells; ++m)
+            for (int h = 0; h != _numMedia; ++h) massv[m] += massDensity(m, h) * volume(m);
+        double totalMass = massv.sum();
+        for (int m = 0; m != _numCells; ++m)
+            cumWorkv[m + 1] = cumWorkv[m] + 1. / _numCells + (totalMass > 0. ? massv[m] / totalMass : 0.);
+    }
+
+    // determine the boundaries so that each process receives a similar share of the work and at least one cell
+    _firstCellv.resize(numProcs + 1);
+    _firstCellv[0] = 0;
+    for (int k = 1; k < numProcs; ++k)
+    {
+        double work = cumWorkv[_numCells] * k / numProcs;
+        int m = std::lower_bound(begin(cumWorkv), end(cumWorkv), work) - begin(cumWorkv);
+        _firstCellv[k] = min(max(m, _firstCellv[k - 1] + 1), _numCells - (numProcs - k));
+    }
+    _firstCellv[numProcs] = _numCells;
+
+    int rank = _dataParallel ? ProcessManager::rank() : 0;
+    _firstLocalCell = _firstCellv[rank];
+    _numLocalCells = _firstCellv[rank + 1] - _firstCellv[rank];
+
+    // prepare the forwarding buffers
+    if (_dataParallel)
+    {
+        _rfOutv.resize(numProcs);
+        _rfNumSentv.resize(numProcs);
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::depositParticles(const ParticleMedium* medium, Array& numberv) const
+{
+    auto log = find<Log>();
+    auto parallel = find<ParallelFactory>()->parallelDuplicated();
+    int numSamples = _config->numDensitySamples();
+
+    size_t numParticles = medium->numSites();
+    log->info("Depositing " + std::to_string(numParticles) + " particles for medium " + medium->type() + " into "
+              + std::to_string(_numCells) + " cells...");
+    numberv.resize(_numCells);
+
+    // process the particles in rounds of chunks; calculate the contributions of the chunks in a round in parallel,
+    // and then add them to the result in chunk order so that the result does not depend on the parallelization
+    size_t numChunks = (numParticles + depositChunkSize - 1) / depositChunkSize;
+    vector<vector<std::pair<int, double>>> contributionsv(min(numChunks, depositChunksPerRound));
+    log->infoSetElapsed(numParticles);
+    for (size_t firstChunk = 0; firstChunk < numChunks; firstChunk += depositChunksPerRound)
+    {
+        size_t numRoundChunks = min(depositChunksPerRound, numChunks - firstChunk);
+        parallel->call(numRoundChunks, [this, medium, numSamples, numParticles, firstChunk,
+                                        &contributionsv](size_t firstIndex, size_t numIndices) {
+            vector<std::pair<int, double>> particlev;
+            for (size_t c = firstIndex; c != firstIndex + numIndices; ++c)
+            {
+                auto& contributions = contributionsv[c];
+                contributions.clear();
+                size_t first = (firstChunk + c) * depositChunkSize;
+                size_t last = min(first + depositChunkSize, numParticles);
+                for (size_t i = first; i != last; ++i)
+                {
+                    medium->cellNumbers(i, _grid, numSamples, particlev);
+                    contributions.insert(contributions.end(), particlev.begin(), particlev.end());
+                }
+            }
+        });
+
+        size_t numDone = 0;
+        for (size_t c = 0; c != numRoundChunks; ++c)
+        {
+            for (const auto& entry : contributionsv[c]) numberv[entry.first] += entry.second;
+            numDone += min(depositChunkSize, numParticles - (firstChunk + c) * depositChunkSize);
+        }
+        log->infoIfElapsed("Deposited particles: ", numDone);
+    }
+    log->info("Done depositing particles");
+}
+
+////////////////////////////////////////////////////////////////////
+
 void MediumSystem::communicateStates()
 {
     if (!ProcessManager::isMultiProc()) return;
@@ -179,13 +397,8 @@ void MediumSystem::communicateStates()
         state(m).B = Vec(data(m, 4), data(m, 5), data(m, 6));
     }
 
-    // densities
-    data.resize(_numCells, _numMedia);
-    for (int m = 0; m != _numCells; ++m)
-        for (int h = 0; h != _numMedia; ++h) data(m, h) = state(m, h).n;
-    ProcessManager::sumToAll(data.data());
-    for (int m = 0; m != _numCells; ++m)
-        for (int h = 0; h != _numMedia; ++h) state(m, h).n = data(m, h);
+    // densities (already stored in a contiguous array)
+    ProcessManager::sumToAll(_nvv);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -220,6 +433,14 @@ int MediumSystem::numCells() const
 
 ////////////////////////////////////////////////////////////////////
 
+int MediumSystem::cellProcess(int m) const
+{
+    if (!_dataParallel) return ProcessManager::rank();
+    return std::upper_bound(_firstCellv.cbegin(), _firstCellv.cend(), m) - _firstCellv.cbegin() - 1;
+}
+
+////////////////////////////////////////////////////////////////////
+
 double MediumSystem::volume(int m) const
 {
     return state(m).V;
@@ -244,7 +465,7 @@ Vec MediumSystem::magneticField(int m)
 bool MediumSystem::hasMaterialType(MaterialMix::MaterialType type) const
 {
     for (int h = 0; h != _numMedia; ++h)
-        if (state(0, h).mix->materialType() == type) return true;
+        if (cellMix(0, h)->materialType() == type) return true;
     return false;
 }
 
@@ -252,50 +473,73 @@ bool MediumSystem::hasMaterialType(MaterialMix::MaterialType type) const
 
 bool MediumSystem::isMaterialType(MaterialMix::MaterialType type, int h) const
 {
-    return state(0, h).mix->materialType() == type;
+    return cellMix(0, h)->materialType() == type;
 }
 
 ////////////////////////////////////////////////////////////////////
 
 double MediumSystem::numberDensity(int m, int h) const
 {
-    return state(m, h).n;
+    return density(m, h);
 }
 
 ////////////////////////////////////////////////////////////////////
 
 double MediumSystem::massDensity(int m, int h) const
 {
-    return state(m, h).n * state(m, h).mix->mass();
+    return density(m, h) * cellMix(m, h)->mass();
 }
 
 ////////////////////////////////////////////////////////////////////
 
 const MaterialMix* MediumSystem::mix(int m, int h) const
 {
-    return state(m, h).mix;
+    return cellMix(m, h);
 }
 
 ////////////////////////////////////////////////////////////////////
 
-const MaterialMix* MediumSystem::randomMixForScattering(Random* random, double lambda, int m) const
+int MediumSystem::randomMediumForScattering(Random* random, double lambda, int m, const int* ellv) const
 {
     int h = 0;
     if (_numMedia > 1)
     {
         Array Xv;
-        NR::cdf(Xv, _numMedia,
-                [this, lambda, m](int h) { return state(m, h).n * state(m, h).mix->sectionSca(lambda); });
+        NR::cdf(Xv, _numMedia, [this, lambda, m, ellv](int h) {
+            auto mix = cellMix(m, h);
+            return density(m, h) * (ellv ? mix->sectionSca(lambda, ellv[h]) : mix->sectionSca(lambda));
+        });
         h = NR::locateClip(Xv, random->uniform());
     }
-    return state(m, h).mix;
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////
+
+const int* MediumSystem::wavelengthIndices(const PhotonPacket* pp) const
+{
+    if (_config->hasMovingMedia() || _config->hasVariableMedia()) return nullptr;
+
+    if (!pp->hasMaterialIndices())
+    {
+        int* ellv = pp->storeMaterialIndices(_numMedia);
+        for (int h = 0; h != _numMedia; ++h) ellv[h] = cellMix(0, h)->indexForLambda(pp->wavelength());
+    }
+    return pp->materialIndices();
 }
 
 ////////////////////////////////////////////////////////////////////
 
 double MediumSystem::opacitySca(double lambda, int m, int h) const
 {
-    return state(m, h).n * state(m, h).mix->sectionSca(lambda);
+    return density(m, h) * cellMix(m, h)->sectionSca(lambda);
+}
+
+////////////////////////////////////////////////////////////////////
+
+double MediumSystem::opacitySca(double lambda, int ell, int m, int h) const
+{
+    return density(m, h) * cellMix(m, h)->sectionSca(lambda, ell);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -303,7 +547,7 @@ double MediumSystem::opacitySca(double lambda, int m, int h) const
 double MediumSystem::opacitySca(double lambda, int m) const
 {
     double result = 0.;
-    for (int h = 0; h != _numMedia; ++h) result += state(m, h).n * state(m, h).mix->sectionSca(lambda);
+    for (int h = 0; h != _numMedia; ++h) result += density(m, h) * cellMix(m, h)->sectionSca(lambda);
     return result;
 }
 
@@ -313,7 +557,7 @@ double MediumSystem::opacityAbs(double lambda, int m, MaterialMix::MaterialType
 {
     double result = 0.;
     for (int h = 0; h != _numMedia; ++h)
-        if (state(0, h).mix->materialType() == type) result += state(m, h).n * state(m, h).mix->sectionAbs(lambda);
+        if (cellMix(0, h)->materialType() == type) result += density(m, h) * cellMix(m, h)->sectionAbs(lambda);
     return result;
 }
 
@@ -321,7 +565,7 @@ double MediumSystem::opacityAbs(double lambda, int m, MaterialMix::MaterialType
 
 double MediumSystem::opacityExt(double lambda, int m, int h) const
 {
-    return state(m, h).n * state(m, h).mix->sectionExt(lambda);
+    return density(m, h) * cellMix(m, h)->sectionExt(lambda);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -329,7 +573,7 @@ double MediumSystem::opacityExt(double lambda, int m, int h) const
 double MediumSystem::opacityExt(double lambda, int m) const
 {
     double result = 0.;
-    for (int h = 0; h != _numMedia; ++h) result += state(m, h).n * state(m, h).mix->sectionExt(lambda);
+    for (int h = 0; h != _numMedia; ++h) result += density(m, h) * cellMix(m, h)->sectionExt(lambda);
     return result;
 }
 
@@ -339,7 +583,7 @@ double MediumSystem::opacityExt(double lambda, int m, MaterialMix::MaterialType
 {
     double result = 0.;
     for (int h = 0; h != _numMedia; ++h)
-        if (state(0, h).mix->materialType() == type) result += state(m, h).n * state(m, h).mix->sectionExt(lambda);
+        if (cellMix(0, h)->materialType() == type) result += density(m, h) * cellMix(m, h)->sectionExt(lambda);
     return result;
 }
 
@@ -347,21 +591,22 @@ double MediumSystem::opacityExt(double lambda, int m, MaterialMix::MaterialType
 
 double MediumSystem::albedo(double lambda, int m, int h) const
 {
-    return state(m, h).mix->albedo(lambda);
+    return cellMix(m, h)->albedo(lambda);
 }
 
 ////////////////////////////////////////////////////////////////////
 
-double MediumSystem::albedo(double lambda, int m) const
+double MediumSystem::albedo(double lambda, int m, const int* ellv) const
 {
     double ksca = 0.;
     double kext = 0.;
     for (int h = 0; h != _numMedia; ++h)
     {
-        double n = state(m, h).n;
-        auto mix = state(m, h).mix;
-        ksca += n * mix->sectionSca(lambda);
-        kext += n * mix->sectionExt(lambda);
+        double n = density(m, h);
+        auto mix = cellMix(m, h);
+        int ell = ellv ? ellv[h] : mix->indexForLambda(lambda);
+        ksca += n * mix->sectionSca(lambda, ell);
+        kext += n * mix->sectionExt(lambda, ell);
     }
     return kext > 0. ? ksca / kext : 0.;
 }
@@ -396,14 +641,16 @@ double MediumSystem::opticalDepth(PhotonPacket* pp, double distance)
     // no kinematics and material properties are spatially constant
     if (!_config->hasMovingMedia() && !_config->hasVariableMedia())
     {
+        const int* ellv = wavelengthIndices(pp);
+
         // single medium (no kinematics, spatially constant)
         if (_numMedia == 1)
         {
-            double section = state(0, 0).mix->sectionExt(pp->wavelength());
+            double section = cellMix(0, 0)->sectionExt(pp->wavelength(), ellv[0]);
             int i = 0;
             for (auto& segment : pp->segments())
             {
-                if (segment.m >= 0) tau += section * state(segment.m, 0).n * segment.ds;
+                if (segment.m >= 0) tau += section * density(segment.m, 0) * segment.ds;
                 pp->setOpticalDepth(i++, tau);
                 if (segment.s > distance) break;
             }
@@ -412,12 +659,17 @@ double MediumSystem::opticalDepth(PhotonPacket* pp, double distance)
         else
         {
             ShortArray<8> sectionv(_numMedia);
-            for (int h = 0; h != _numMedia; ++h) sectionv[h] = state(0, h).mix->sectionExt(pp->wavelength());
+            for (int h = 0; h != _numMedia; ++h) sectionv[h] = cellMix(0, h)->sectionExt(pp->wavelength(), ellv[h]);
             int i = 0;
             for (auto& segment : pp->segments())
             {
                 if (segment.m >= 0)
-                    for (int h = 0; h != _numMedia; ++h) tau += sectionv[h] * state(segment.m, h).n * segment.ds;
+                {
+                    const double* nv = densities(segment.m);
+                    double k = 0.;
+                    for (int h = 0; h != _numMedia; ++h) k += sectionv[h] * nv[h];
+                    tau += k * segment.ds;
+                }
                 pp->setOpticalDepth(i++, tau);
                 if (segment.s > distance) break;
             }
@@ -440,6 +692,63 @@ double MediumSystem::opticalDepth(PhotonPacket* pp, double distance)
 
 ////////////////////////////////////////////////////////////////////
 
+double MediumSystem::observedOpticalDepth(PhotonPacket* pp, double distance)
+{
+    // accumulate the optical depth and the cumulative distance cell by cell while traversing the path,
+    // terminating the traversal when the specified distance has been covered or the optical depth becomes large;
+    // as for the opticalDepth() function, we implement optimized versions for special cases
+    double tauMax = _config->maxPeelOffOpticalDepth();
+    double tau = 0.;
+    double s = 0.;
+
+    // no kinematics and material properties are spatially constant
+    if (!_config->hasMovingMedia() && !_config->hasVariableMedia())
+    {
+        const int* ellv = wavelengthIndices(pp);
+
+        // single medium (no kinematics, spatially constant)
+        if (_numMedia == 1)
+        {
+            double section = cellMix(0, 0)->sectionExt(pp->wavelength(), ellv[0]);
+            _grid->traversePath(pp, [this, section, distance, tauMax, &tau, &s](int m, double ds) {
+                if (m >= 0) tau += section * density(m, 0) * ds;
+                s += ds;
+                return s <= distance && tau <= tauMax;
+            });
+        }
+        // multiple media (no kinematics, spatially constant)
+        else
+        {
+            ShortArray<8> sectionv(_numMedia);
+            for (int h = 0; h != _numMedia; ++h) sectionv[h] = cellMix(0, h)->sectionExt(pp->wavelength(), ellv[h]);
+            _grid->traversePath(pp, [this, &sectionv, distance, tauMax, &tau, &s](int m, double ds) {
+                if (m >= 0)
+                {
+                    const double* nv = densities(m);
+                    double k = 0.;
+                    for (int h = 0; h != _numMedia; ++h) k += sectionv[h] * nv[h];
+                    tau += k * ds;
+                }
+                s += ds;
+                return s <= distance && tau <= tauMax;
+            });
+        }
+    }
+    // with kinematics and/or spatially variable material properties
+    else
+    {
+        _grid->traversePath(pp, [this, pp, distance, tauMax, &tau, &s](int m, double ds) {
+            if (m >= 0) tau += opacityExt(pp->perceivedWavelength(state(m).v), m) * ds;
+            s += ds;
+            return s <= distance && tau <= tauMax;
+        });
+    }
+
+    return tau;
+}
+
+////////////////////////////////////////////////////////////////////
+
 void MediumSystem::clearRadiationField(bool primary)
 {
     if (primary)
@@ -457,29 +766,268 @@ void MediumSystem::clearRadiationField(bool primary)
 
 void MediumSystem::storeRadiationField(bool primary, int m, int ell, double Lds)
 {
-    if (primary)
-        LockFree::add(_rf1(m, ell), Lds);
-    else
-        LockFree::add(_rf2c(m, ell), Lds);
+    using Mode = RadiationFieldOptions::AccumulationMode;
+    switch (_rfMode)
+    {
+        case Mode::Shared:
+        case Mode::Automatic:
+        {
+            if (primary)
+                _rf1.add(_rf1.index(m, ell), Lds);
+            else
+                _rf2c.add(_rf2c.index(m, ell), Lds);
+            break;
+        }
+        case Mode::ThreadLocalDense:
+        {
+            auto buffer = _rfBuffer.local();
+            if (buffer->primary != primary) flushRadiationFieldBuffer(buffer);
+            buffer->primary = primary;
+            if (!buffer->dense.size()) buffer->dense.resize(_rf1.size());
+            buffer->dense[_rf1.index(m, ell)] += Lds;
+            break;
+        }
+        case Mode::ThreadLocalSparse:
+        {
+            auto buffer = _rfBuffer.local();
+            if (buffer->primary != primary) flushRadiationFieldBuffer(buffer);
+            buffer->primary = primary;
+            buffer->sparse[_rf1.index(m, ell)] += Lds;
+            if (buffer->sparse.size() > _rfMaxSparseBins) flushRadiationFieldBuffer(buffer);
+            break;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::flushRadiationFieldBuffer(RadiationFieldBuffer* buffer)
+{
+    RadiationFieldTable& target = buffer->primary ? _rf1 : _rf2c;
+
+    // in data-parallel mode, move the contributions for cells owned by other processes to the forwarding messages
+    if (_dataParallel)
+    {
+        bool forward = false;
+        {
+            std::unique_lock<std::mutex> lock(_rfOutMutex);
+            size_t numBins = _wavelengthGrid->numBins();
+            for (auto bin = buffer->sparse.begin(); bin != buffer->sparse.end();)
+            {
+                if (target.contains(bin->first))
+                    ++bin;
+                else
+                {
+                    int rank = cellProcess(bin->first / numBins);
+                    auto& message = _rfOutv[rank];
+                    if (!message.empty() && message[0] != buffer->primary)
+                    {
+                        _rfOutbox.emplace_back(rank, std::move(message));
+                        message.clear();
+                    }
+                    if (message.empty()) message.push_back(buffer->primary);
+                    message.push_back(bin->first);
+                    message.push_back(bin->second);
+                    if (message.size() > 2 * maxForwardedBins)
+                    {
+                        _rfOutbox.emplace_back(rank, std::move(message));
+                        message.clear();
+                    }
+                    bin = buffer->sparse.erase(bin);
+                }
+            }
+            forward = !_rfOutbox.empty() && std::this_thread::get_id() == _rfParentThread;
+        }
+        if (forward) forwardRadiationField();
+    }
+
+    size_t size = buffer->dense.size();
+    for (size_t i = 0; i != size; ++i)
+    {
+        if (buffer->dense[i] != 0.)
+        {
+            target.add(i, buffer->dense[i]);
+            buffer->dense[i] = 0.;
+        }
+    }
+
+    for (const auto& bin : buffer->sparse) target.add(bin.first, bin.second);
+    buffer->sparse.clear();
 }
 
 ////////////////////////////////////////////////////////////////////
 
 void MediumSystem::communicateRadiationField(bool primary)
 {
-    if (primary)
-        ProcessManager::sumToAll(_rf1.data());
+    // reduce the thread-local buffers, if any, into the shared tables
+    if (_rfMode != RadiationFieldOptions::AccumulationMode::Shared)
+        for (auto buffer : _rfBuffer.all()) flushRadiationFieldBuffer(buffer);
+
+    if (_dataParallel)
+    {
+        // send the remaining messages, including those that are not full
+        {
+            std::unique_lock<std::mutex> lock(_rfOutMutex);
+            for (int rank = 0; rank != static_cast<int>(_rfOutv.size()); ++rank)
+            {
+                if (!_rfOutv[rank].empty())
+                {
+                    _rfOutbox.emplace_back(rank, std::move(_rfOutv[rank]));
+                    _rfOutv[rank].clear();
+                }
+            }
+        }
+        forwardRadiationField();
+
+        // determine the number of messages sent to this process by all processes during this segment,
+        // and receive the messages that have not yet arrived
+        Array numSentv = _rfNumSentv;
+        ProcessManager::sumToAll(numSentv);
+        size_t numExpected = static_cast<size_t>(numSentv[ProcessManager::rank()]);
+        vector<double> message;
+        while (_rfNumReceived < numExpected)
+        {
+            ProcessManager::receiveMessage(message, true);
+            addForwardedRadiationField(message);
+        }
+
+        // make sure that all messages have been delivered before the next segment starts
+        ProcessManager::completeMessages();
+        _rfNumSentv = 0.;
+        _rfNumReceived = 0;
+        ProcessManager::wait();
+    }
     else
     {
-        ProcessManager::sumToAll(_rf2c.data());
-        _rf2 = _rf2c;
+        RadiationFieldTable& target = primary ? _rf1 : _rf2c;
+        target.sumToAll();
     }
+    if (!primary) _rf2 = _rf2c;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::forwardRadiationField()
+{
+    if (!_dataParallel) return;
+
+    // send the full messages
+    while (true)
+    {
+        std::pair<int, vector<double>> outgoing;
+        {
+            std::unique_lock<std::mutex> lock(_rfOutMutex);
+            if (_rfOutbox.empty()) break;
+            outgoing = std::move(_rfOutbox.front());
+            _rfOutbox.pop_front();
+        }
+        _rfNumSentv[outgoing.first] += 1.;
+        ProcessManager::postMessage(outgoing.first, std::move(outgoing.second));
+    }
+
+    // add the contributions in the messages that have arrived
+    vector<double> message;
+    while (ProcessManager::receiveMessage(message, false)) addForwardedRadiationField(message);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::addForwardedRadiationField(const vector<double>& message)
+{
+    RadiationFieldTable& target = message[0] ? _rf1 : _rf2c;
+    for (size_t k = 1; k + 1 < message.size(); k += 2) target.add(static_cast<size_t>(message[k]), message[k + 1]);
+    _rfNumReceived++;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::saveRadiationField(CheckpointOutFile& out) const
+{
+    _rf1.save(out, "primary radiation field");
+    _rf2.save(out, "secondary radiation field");
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::restoreRadiationField(CheckpointInFile& in)
+{
+    _rf1.restore(in, "primary radiation field");
+    _rf2.restore(in, "secondary radiation field");
+    _rf2c = _rf2;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::RadiationFieldTable::resize(int firstCell, int numCells, int numBins, bool singlePrecision)
+{
+    _singlePrecision = singlePrecision;
+    _numBins = numBins;
+    _offset = static_cast<size_t>(firstCell) * numBins;
+    size_t size = static_cast<size_t>(numCells) * numBins;
+    if (singlePrecision)
+        _fv.assign(size, 0.f);
+    else
+        _dv.resize(size);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::RadiationFieldTable::setToZero()
+{
+    if (_singlePrecision)
+        std::fill(_fv.begin(), _fv.end(), 0.f);
+    else
+        _dv = 0.;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::RadiationFieldTable::add(size_t i, double value)
+{
+    i -= _offset;
+    if (_singlePrecision)
+        LockFree::add(_fv[i], static_cast<float>(value));
+    else
+        LockFree::add(_dv[i], value);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::RadiationFieldTable::sumToAll()
+{
+    if (_singlePrecision)
+        ProcessManager::sumToAll(_fv);
+    else
+        ProcessManager::sumToAll(_dv);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::RadiationFieldTable::save(CheckpointOutFile& out, string label) const
+{
+    if (_singlePrecision)
+        out.write(label, _fv);
+    else
+        out.write(label, _dv);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MediumSystem::RadiationFieldTable::restore(CheckpointInFile& in, string label)
+{
+    if (_singlePrecision)
+        in.read(label, _fv);
+    else
+        in.read(label, _dv);
 }
 
 ////////////////////////////////////////////////////////////////////
 
 double MediumSystem::radiationField(int m, int ell) const
 {
+    if (!isLocalCell(m))
+        throw FATALERROR("The radiation field for spatial cell " + std::to_string(m)
+                         + " is not available in this process in data-parallel mode");
     double rf = 0.;
     if (_rf1.size()) rf += _rf1(m, ell);
     if (_rf2.size()) rf += _rf2(m, ell);
@@ -495,12 +1043,20 @@ double MediumSystem::totalAbsorbedLuminosity(bool primary, MaterialMix::Material
     for (int ell = 0; ell != numWavelengths; ++ell)
     {
         double lambda = _wavelengthGrid->wavelength(ell);
-        for (int m = 0; m != _numCells; ++m)
+        for (int m = _firstLocalCell; m != _firstLocalCell + _numLocalCells; ++m)
         {
             double rf = primary ? _rf1(m, ell) : _rf2(m, ell);
             Labs += opacityAbs(lambda, m, type) * rf;
         }
     }
+
+    // in data-parallel mode, sum the contributions of the cells owned by each process
+    if (_dataParallel)
+    {
+        Array Labsv(Labs, 1);
+        ProcessManager::sumToAll(Labsv);
+        Labs = Labsv[0];
+    }
     return Labs;
 }
 
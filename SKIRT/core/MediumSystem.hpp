@@ -13,10 +13,19 @@
 #include "MaterialMix.hpp"
 #include "Medium.hpp"
 #include "PhotonPacketOptions.hpp"
+#include "RadiationFieldOptions.hpp"
 #include "SimulationItem.hpp"
 #include "SpatialGrid.hpp"
 #include "Table.hpp"
+#include "ThreadLocalMember.hpp"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+class CheckpointInFile;
+class CheckpointOutFile;
 class Configuration;
+class ParticleMedium;
 class PhotonPacket;
 class Random;
 class WavelengthGrid;
@@ -50,7 +59,28 @@ class WavelengthGrid;
     represents the radiation field to be used as input for calculations. There is a third,
     temporary table that serves as a target for storing the secondary radiation field so that the
     "stable" primary and secondary tables remain available for calculating secondary emission
-    spectra while shooting secondary photons through the grid. */
+    spectra while shooting secondary photons through the grid.
+
+    Depending on the options offered by the RadiationFieldOptions item, contributions to the
+    radiation field are either added directly to the shared tables, or first accumulated in a dense
+    or sparse buffer private to each execution thread. In the latter case, the thread-local buffers
+    are reduced into the shared tables by the communicateRadiationField() function. The shared
+    tables can be stored in double or single precision; in the latter case, contributions are
+    always accumulated in thread-local buffers (see the RadiationFieldOptions class).
+
+    In data-parallel mode (see Configuration::dataParallel()), the rows of the radiation field
+    tables are partitioned over the processes in contiguous ranges of spatial cells, so that each
+    process stores the radiation field only for the cells it owns. The range boundaries are chosen
+    so that each process receives a similar share of the estimated work, which is taken to be
+    proportional in equal parts to the number of cells and to the material mass in the cells. All
+    other medium state is still replicated in every process. Photon packets are traced through the
+    complete spatial grid by any process; contributions to the radiation field of cells owned by
+    another process are collected in a bounded message buffer for each destination process. Full
+    messages are sent point-to-point to the owning process by the forwardRadiationField()
+    function, which must be called regularly from the parent thread while photon packets are being
+    launched, and the remaining contributions are sent by the communicateRadiationField()
+    function. The functions that query the radiation field can then be invoked only for locally
+    owned cells. */
 class MediumSystem : public SimulationItem
 {
     ITEM_CONCRETE(MediumSystem, SimulationItem, "a medium system")
@@ -72,12 +102,21 @@ class MediumSystem : public SimulationItem
         ATTRIBUTE_DEFAULT_VALUE(dustSelfAbsorptionOptions, "DustSelfAbsorptionOptions")
         ATTRIBUTE_RELEVANT_IF(dustSelfAbsorptionOptions, "DustSelfAbsorption")
 
+        PROPERTY_ITEM(radiationFieldOptions, RadiationFieldOptions, "the radiation field options")
+        ATTRIBUTE_DEFAULT_VALUE(radiationFieldOptions, "RadiationFieldOptions")
+        ATTRIBUTE_RELEVANT_IF(radiationFieldOptions, "RadiationField")
+        ATTRIBUTE_DISPLAYED_IF(radiationFieldOptions, "Level3")
+
         PROPERTY_INT(numDensitySamples, "the number of random density samples for determining spatial cell mass")
         ATTRIBUTE_MIN_VALUE(numDensitySamples, "10")
         ATTRIBUTE_MAX_VALUE(numDensitySamples, "1000")
         ATTRIBUTE_DEFAULT_VALUE(numDensitySamples, "100")
         ATTRIBUTE_DISPLAYED_IF(numDensitySamples, "Level2")
 
+        PROPERTY_BOOL(depositParticleMass, "deposit the mass of smoothed particles directly into the spatial cells")
+        ATTRIBUTE_DEFAULT_VALUE(depositParticleMass, "false")
+        ATTRIBUTE_DISPLAYED_IF(depositParticleMass, "Level3")
+
         PROPERTY_ITEM_LIST(media, Medium, "the transfer media")
         ATTRIBUTE_DEFAULT_VALUE(media, "GeometricMedium")
         ATTRIBUTE_REQUIRED_IF(media, "!NoMedium")
@@ -95,7 +134,14 @@ protected:
         including the cell volume and the number density for each medium as defined by the input
         model. If needed for the simulation's configuration, it also allocates one or two radiation
         field data tables that have a bin for each spatial cell in the simulation and for each bin
-        in the wavelength grid returned by the Configuration::radiationFieldWLG() function. */
+        in the wavelength grid returned by the Configuration::radiationFieldWLG() function.
+
+        If the spatial grid offers the DensityInCellInterface, the cell densities are obtained
+        through that interface. Otherwise, if the \em depositParticleMass flag is enabled, the
+        densities for smoothed particle media are obtained by depositing the particle masses into
+        the cells (see the depositParticles() function), and the densities for any other media are
+        determined by sampling the density distribution in a number of random positions within
+        each cell. */
     void setupSelfAfter() override;
 
     //======================== Other Functions =======================
@@ -121,6 +167,29 @@ public:
         The returned value is valid only after setup has been performed. */
     int numCells() const;
 
+    /** This function returns true if the radiation field tables are partitioned over multiple
+        processes (data-parallel mode), and false otherwise. */
+    bool isDataParallel() const { return _dataParallel; }
+
+    /** This function returns the index of the first spatial cell for which the radiation field is
+        stored in this process. Without data parallelization, the function returns zero. */
+    int firstLocalCell() const { return _firstLocalCell; }
+
+    /** This function returns the number of consecutive spatial cells, starting at the index
+        returned by firstLocalCell(), for which the radiation field is stored in this process.
+        Without data parallelization, the function returns the total number of cells. */
+    int numLocalCells() const { return _numLocalCells; }
+
+    /** This function returns true if the radiation field for the spatial cell with index \f$m\f$
+        is stored in this process. Without data parallelization, the function always returns
+        true. */
+    bool isLocalCell(int m) const { return m >= _firstLocalCell && m < _firstLocalCell + _numLocalCells; }
+
+    /** This function returns the rank of the process that stores the radiation field for the
+        spatial cell with index \f$m\f$. Without data parallelization, the function returns the
+        rank of the calling process. */
+    int cellProcess(int m) const;
+
     /** This function returns the volume of the spatial cell with index \f$m\f$. */
     double volume(int m) const;
 
@@ -178,17 +247,34 @@ public:
         \f$h\f$ in spatial cell with index \f$m\f$. */
     const MaterialMix* mix(int m, int h) const;
 
-    /** This function randomly returns a material mix corresponding to one of the medium components
-        in spatial cell with index \f$m\f$. The sampling is weighted by the scattering opacity
-        \f$k=n_h\sigma_h^\text{sca}\f$ at wavelength \f$\lambda\f$ of each medium component with
-        index \f$h\f$ in the spatial cell with index \f$m\f$. */
-    const MaterialMix* randomMixForScattering(Random* random, double lambda, int m) const;
+    /** This function randomly returns the index \f$h\f$ of one of the medium components in
+        spatial cell with index \f$m\f$. The sampling is weighted by the scattering opacity
+        \f$k=n_h\sigma_h^\text{sca}\f$ at wavelength \f$\lambda\f$ of each medium component in
+        the spatial cell. If the \em ellv argument is not null, it must point to the material
+        wavelength indices for \f$\lambda\f$ returned by the wavelengthIndices() function. */
+    int randomMediumForScattering(Random* random, double lambda, int m, const int* ellv = nullptr) const;
+
+    /** This function returns the index \f$\ell\f$ of the current wavelength of the specified
+        photon packet in the wavelength grid of the material mix for each medium component (see
+        MaterialMix::indexForLambda()), or null if the indices are not the same for all spatial
+        cells. The latter happens for media with kinematics, because the perceived wavelength
+        differs between cells, and for spatially variable material mixes. The indices are resolved
+        only once for each wavelength and cached in the photon packet, so that the photon life
+        cycle can pass them to the index-based functions for every path segment and interaction.
+        */
+    const int* wavelengthIndices(const PhotonPacket* pp) const;
 
     /** This function returns the scattering opacity \f$k=n_h\sigma_h^\text{sca}\f$ at wavelength
         \f$\lambda\f$ of the medium component with index \f$h\f$ in spatial cell with index
         \f$m\f$. */
     double opacitySca(double lambda, int m, int h) const;
 
+    /** This function returns the scattering opacity \f$k=n_h\sigma_h^\text{sca}\f$ at wavelength
+        \f$\lambda\f$ of the medium component with index \f$h\f$ in spatial cell with index
+        \f$m\f$, given the index \f$\ell\f$ returned for that wavelength by the
+        MaterialMix::indexForLambda() function of the corresponding material mix. */
+    double opacitySca(double lambda, int ell, int m, int h) const;
+
     /** This function returns the scattering opacity \f$k=\sum_h n_h\sigma_h^\text{sca}\f$ summed
         over all medium components at wavelength \f$\lambda\f$ in spatial cell with index \f$m\f$.
         */
@@ -221,8 +307,11 @@ public:
 
     /** This function returns the weighted scattering albedo \f[\frac{\sum_h
         n_h\sigma_h^\text{sca}} {\sum_h n_h\sigma_h^\text{ext}}\f] over all medium components at
-        wavelength \f$\lambda\f$ in spatial cell with index \f$m\f$. */
-    double albedo(double lambda, int m) const;
+        wavelength \f$\lambda\f$ in spatial cell with index \f$m\f$. If the \em ellv argument is
+        not null, it must point to the material wavelength indices for \f$\lambda\f$ returned by
+        the wavelengthIndices() function. Otherwise, the wavelength is looked up once for each
+        medium component. */
+    double albedo(double lambda, int m, const int* ellv = nullptr) const;
 
     /** This function returns the optical depth at the specified wavelength along a path through
         the medium system, taking into account only medium components with the specified material
@@ -272,6 +361,21 @@ public:
         not store optical depth information in the photon packet for skipped path segments. */
     double opticalDepth(PhotonPacket* pp, double distance = std::numeric_limits<double>::infinity());
 
+    /** This function returns the optical depth along a path through the medium system defined by
+        the specified PhotonPacket object, limited to the specified distance along the path. It is
+        intended for calculating the extinction of a peel-off photon packet towards an observer,
+        for which only the total optical depth is needed.
+
+        The optical depth is calculated in the same way as for the opticalDepth(PhotonPacket*,
+        double) function, except that the path segments are not stored in the photon packet.
+        Instead, the function uses the SpatialGrid::traversePath() function to accumulate the
+        optical depth cell by cell while the path is being traversed. Furthermore, the traversal
+        is terminated as soon as the cumulative optical depth exceeds the value returned by the
+        Configuration::maxPeelOffOpticalDepth() function, because the corresponding extinction
+        factor is negligible. In that case, the function returns the optical depth accumulated up
+        to that point. */
+    double observedOpticalDepth(PhotonPacket* pp, double distance);
+
     /** This function initializes all values of the primary and/or secondary radiation field info
         tables to zero. In simulation modes that record the radiation field, the function should be
         called before starting a simulation segment (i.e. before a set of photon packets is
@@ -289,29 +393,64 @@ public:
         the temporary secondary table.
 
         The addition happens in a thread-safe way, so that this function can be called from
-        multiple parallel threads, even for the same spatial/wavelength bin. If any of the indices
-        are out of range, undefined behavior results. */
+        multiple parallel threads, even for the same spatial/wavelength bin. Depending on the
+        configured accumulation mode, the value is either added directly to the shared table using
+        a lock-free atomic operation, or it is added to a buffer private to the calling thread. In
+        the latter case, the contribution becomes visible in the shared table only after the
+        communicateRadiationField() function has been called. In data-parallel mode, contributions
+        to cells owned by another process are always buffered and forwarded to that process as
+        described in the class header. If any of the indices are out of range, undefined behavior
+        results. */
     void storeRadiationField(bool primary, int m, int ell, double Lds);
 
     /** This function accumulates the radiation field between multiple processes. In simulation
         modes that record the radiation field, the function should be called in serial code after
         finishing a simulation segment (i.e. after a before set of photon packets has been
-        launched) and before querying the radiation field's contents. If the \em primary flag is
-        true, the primary table is synchronized; otherwise the temporary secondary table is
-        synchronized and its contents is copied into the stable secondary table. */
+        launched) and before querying the radiation field's contents. The function first reduces
+        any thread-local buffers into the shared table. If the \em primary flag is true, the
+        primary table is synchronized; otherwise the temporary secondary table is synchronized and
+        its contents is copied into the stable secondary table. In data-parallel mode, the
+        contributions buffered for cells owned by other processes are sent to those processes
+        instead of summing the complete tables across processes, and the function waits until all
+        messages forwarded by the other processes during the segment have been received. */
     void communicateRadiationField(bool primary);
 
+    /** In data-parallel mode, this function sends the full forwarding messages with radiation
+        field contributions for cells owned by other processes to those processes, and adds the
+        contributions received from other processes to the local table. The function must be called
+        from the parent thread (i.e. the thread that performed setup), and it should be called
+        regularly while photon packets are being launched, so that the forwarding buffers remain
+        bounded. It is also called automatically whenever the parent thread itself fills a
+        forwarding message. Without data parallelization, the function does nothing. */
+    void forwardRadiationField();
+
+    /** This function writes the primary and stable secondary radiation field tables held by this
+        process to the specified checkpoint file. It should be called in serial code after the
+        communicateRadiationField() function has been called at the end of a simulation
+        segment. */
+    void saveRadiationField(CheckpointOutFile& out) const;
+
+    /** This function restores the primary and stable secondary radiation field tables held by this
+        process from the specified checkpoint file, which must have been written by the
+        saveRadiationField() function for a simulation with the same configuration. The temporary
+        secondary table receives a copy of the stable secondary table, reproducing the state after
+        the corresponding call to communicateRadiationField(). */
+    void restoreRadiationField(CheckpointInFile& in);
+
     /** This function returns the bolometric luminosity absorbed by media with the specified
         material type across the complete domain of the spatial grid, using the partial radiation
         field stored in the table indicated by the \em primary flag (true for the primary table,
         false for the stable secondary table). The bolometric absorbed luminosity in each cell is
-        calculated as described for the absorbedLuminosity() function. */
+        calculated as described for the absorbedLuminosity() function. In data-parallel mode, the
+        function must be called by all processes because each process sums the luminosity over the
+        cells it owns. */
     double totalAbsorbedLuminosity(bool primary, MaterialMix::MaterialType type) const;
 
 private:
     /** This function returns the sum of the values in both the primary and the stable secondary
         radiation field tables at the specified cell and wavelength indices. If a table is not
-        present, the value for that table is assumed to be zero. */
+        present, the value for that table is assumed to be zero. In data-parallel mode, the function
+        throws a fatal error if the specified cell is not owned by the calling process. */
     double radiationField(int m, int ell) const;
 
 public:
@@ -387,13 +526,6 @@ private:
         Vec B;     // magnetic field
     };
 
-    /** This data structure holds the information maintained per cell and per medium. */
-    struct State2
-    {
-        double n;                // the number density
-        const MaterialMix* mix;  // pointer to the material mix
-    };
-
     /** This function returns a writable reference to the state data structure for the given cell
         index. */
     State1& state(int m) { return _state1v[m]; }
@@ -402,13 +534,121 @@ private:
         index. */
     const State1& state(int m) const { return _state1v[m]; }
 
-    /** This function returns a writable reference to the state data structure for the given cell
-        and medium indices. */
-    State2& state(int m, int h) { return _state2vv[m * _numMedia + h]; }
+    /** This function returns a writable reference to the number density for the given cell and
+        medium indices. */
+    double& density(int m, int h) { return _nvv[m * _numMedia + h]; }
 
-    /** This function returns a read-only reference to the state data structure for the given cell
-        and medium indices. */
-    const State2& state(int m, int h) const { return _state2vv[m * _numMedia + h]; }
+    /** This function returns the number density for the given cell and medium indices. */
+    double density(int m, int h) const { return _nvv[m * _numMedia + h]; }
+
+    /** This function returns a pointer to the number densities of all media in the given cell,
+        stored contiguously and indexed on h. */
+    const double* densities(int m) const { return &_nvv[m * _numMedia]; }
+
+    /** This function returns the material mix for the given cell and medium indices. If none of
+        the media has a spatially variable material mix, the same mix is returned for all cells. */
+    const MaterialMix* cellMix(int m, int h) const { return _mixv[_hasMixPerCell ? m * _numMedia + h : h]; }
+
+    /** This class holds a radiation field table with an entry for each spatial cell in a
+        contiguous range and for each wavelength bin (indexed on m,ell), stored in either double or
+        single precision. The interface always uses double precision values, and the flat index for
+        a given cell and wavelength bin is the same in both cases. The flat index is defined
+        relative to the complete spatial grid, even if the table holds only a subrange of cells. */
+    class RadiationFieldTable
+    {
+    public:
+        /** This function resizes the table to hold the specified number of cells starting at the
+            specified cell index, using the specified precision, and sets all values to zero. */
+        void resize(int firstCell, int numCells, int numBins, bool singlePrecision);
+
+        /** This function returns the number of entries in the table. */
+        size_t size() const { return _singlePrecision ? _fv.size() : _dv.size(); }
+
+        /** This function returns the number of bytes allocated for the table. */
+        size_t allocatedBytes() const { return _dv.size() * sizeof(double) + _fv.size() * sizeof(float); }
+
+        /** This function sets all values in the table to zero. */
+        void setToZero();
+
+        /** This function returns the flat index for the specified cell and wavelength bin. */
+        size_t index(int m, int ell) const { return static_cast<size_t>(m) * _numBins + ell; }
+
+        /** This function returns true if the table holds the entry with the specified flat
+            index. */
+        bool contains(size_t i) const { return i - _offset < size(); }
+
+        /** This function returns the value for the specified cell and wavelength bin. */
+        double operator()(int m, int ell) const
+        {
+            size_t i = index(m, ell) - _offset;
+            return _singlePrecision ? _fv[i] : _dv[i];
+        }
+
+        /** This function adds the specified value to the entry with the specified flat index using
+            lock-free atomic operations. */
+        void add(size_t i, double value);
+
+        /** This function adds the values in the table element-wise across the different
+            processes. */
+        void sumToAll();
+
+        /** This function writes the values in the table to the specified checkpoint file as a
+            record with the specified label. */
+        void save(CheckpointOutFile& out, string label) const;
+
+        /** This function reads the values in the table from the record with the specified label
+            in the specified checkpoint file. */
+        void restore(CheckpointInFile& in, string label);
+
+    private:
+        bool _singlePrecision{false};
+        size_t _numBins{0};
+        size_t _offset{0};  // the flat index of the first entry held by the table
+        Array _dv;
+        vector<float> _fv;
+    };
+
+    /** This data structure holds the radiation field contributions accumulated by a single
+        thread in one of the thread-local accumulation modes. Depending on the mode, either the
+        dense array (indexed on m*numBins+ell) or the sparse map (keyed on the same index) is used.
+        The \em primary flag indicates the table targeted by the buffered contributions. */
+    struct RadiationFieldBuffer
+    {
+        bool primary{true};
+        Array dense;
+        std::unordered_map<size_t, double> sparse;
+    };
+
+    /** This function adds the contents of the specified thread-local radiation field buffer to the
+        corresponding shared table, and clears the buffer. The addition is performed using lock-free
+        atomic operations so that it is safe to call this function while other threads are
+        accumulating contributions into the shared table. In data-parallel mode, contributions for
+        cells owned by another process are moved to the forwarding message for that process. */
+    void flushRadiationFieldBuffer(RadiationFieldBuffer* buffer);
+
+    /** This function adds the radiation field contributions in the specified message, received
+        from another process in data-parallel mode, to the local table indicated by the message. */
+    void addForwardedRadiationField(const vector<double>& message);
+
+    /** This function partitions the spatial cells over the processes in data-parallel mode as
+        described in the class header, and determines the range of cells owned by this process.
+        Without data parallelization, all cells are owned by this process. The function must be
+        called after the cell densities and material mixes have been initialized. */
+    void partitionCells();
+
+    /** This function calculates the number of material entities in each spatial cell for the
+        specified smoothed particle medium by looping over the particles rather than over the
+        cells, and stores the result in the \em numberv array, indexed on m. For each particle, the
+        ParticleMedium::cellNumbers() function integrates the smoothing kernel over the cells it
+        overlaps.
+
+        The particles are processed in rounds of fixed-size chunks. Within a round, the
+        contributions for each chunk are calculated in parallel and collected in a separate list
+        per chunk. The lists are then added to the result in chunk order, so that the result does
+        not depend on the number of execution threads or on the order in which the chunks are
+        handled. Every process calculates the complete result, so that there is no need for
+        communication. */
+    void depositParticles(const ParticleMedium* medium, Array& numberv) const;
 
     /** This function communicates the cell states between multiple processes after the states have
         been initialized in parallel (i.e. each process initialized a subset of the states). */
@@ -423,7 +663,14 @@ private:
     int _numCells{0};          // index m
     int _numMedia{0};          // index h
     vector<State1> _state1v;   // state info for each cell (indexed on m)
-    vector<State2> _state2vv;  // state info for each cell and each medium (indexed on m,h)
+    // number density for each cell and each medium (indexed on m,h); the densities of all media in a cell are
+    // adjacent because each path segment reads them together for a random cell, which outperforms a medium-major
+    // block (indexed on h,m) for any number of media
+    Array _nvv;
+    // material mix for each medium (indexed on h), or for each cell and each medium (indexed on m,h)
+    // if at least one medium has a spatially variable mix
+    vector<const MaterialMix*> _mixv;
+    bool _hasMixPerCell{false};
 
     // relevant for any simulation mode that stores the radiation field
     WavelengthGrid* _wavelengthGrid{0};  // index ell
@@ -431,9 +678,29 @@ private:
     // - the sum of rf1 and rf2 represents the stable radiation field to be used as input for regular calculations
     // - rf2c serves as a target for storing the secondary radiation field so that rf1+rf2 remain available for
     //   calculating secondary emission spectra while already shooting photons through the grid
-    Table<2> _rf1;   // radiation field from primary sources
-    Table<2> _rf2;   // radiation field from secondary sources (copied from _rf2c at the appropriate time)
-    Table<2> _rf2c;  // radiation field currently being accumulated from secondary sources
+    RadiationFieldTable _rf1;   // radiation field from primary sources
+    RadiationFieldTable _rf2;   // radiation field from secondary sources (copied from _rf2c at the appropriate time)
+    RadiationFieldTable _rf2c;  // radiation field currently being accumulated from secondary sources
+
+    // thread-local accumulation of the radiation field, if enabled (mode is never Automatic after setup)
+    RadiationFieldOptions::AccumulationMode _rfMode{RadiationFieldOptions::AccumulationMode::Shared};
+    size_t _rfMaxSparseBins{0};                         // maximum number of bins in a sparse buffer
+    ThreadLocalMember<RadiationFieldBuffer> _rfBuffer;  // the thread-local buffers
+
+    // partitioning of the radiation field over processes in data-parallel mode
+    bool _dataParallel{false};  // true if the radiation field is partitioned over processes
+    int _firstLocalCell{0};     // index of the first cell owned by this process
+    int _numLocalCells{0};      // number of cells owned by this process
+    vector<int> _firstCellv;    // index of the first cell owned by each process (indexed on rank)
+
+    // forwarding of radiation field contributions for cells owned by other processes in data-parallel mode;
+    // each message holds the primary flag followed by (flat index, value) pairs
+    vector<vector<double>> _rfOutv;                        // message being filled for each process (indexed on rank)
+    std::deque<std::pair<int, vector<double>>> _rfOutbox;  // full messages waiting to be sent, with destination rank
+    std::mutex _rfOutMutex;                                // guards access to the messages being filled and the outbox
+    std::thread::id _rfParentThread;                       // the thread allowed to communicate with other processes
+    Array _rfNumSentv;         // number of messages sent to each process during the current segment (indexed on rank)
+    size_t _rfNumReceived{0};  // number of messages received during the current segment
 };
 
 ////////////////////////////////////////////////////////////////
@@ -4,8 +4,11 @@
 ///////////////////////////////////////////////////////////////// */
 
 #include "MonteCarloSimulation.hpp"
+#include "CheckpointInFile.hpp"
+#include "CheckpointOutFile.hpp"
 #include "DisjointWavelengthGrid.hpp"
 #include "FatalError.hpp"
+#include "FilePaths.hpp"
 #include "Log.hpp"
 #include "MaterialMix.hpp"
 #include "Parallel.hpp"
@@ -37,6 +40,9 @@ void MonteCarloSimulation::setupSimulation()
 
         // notify the probe system
         probeSystem()->probeSetup();
+
+        // wait for the output files being written in the background
+        outputWriter()->wait();
     }
 }
 
@@ -65,14 +71,19 @@ void MonteCarloSimulation::runSimulation()
     {
         TimeLogger logger(log(), "the run");
 
+        // restore the state from the last checkpoint, if requested
+        if (_config->restart()) readCheckpoint();
+
         // primary emission segment
-        runPrimaryEmission();
+        if (_checkpointStage < CheckpointStage::PrimaryEmission) runPrimaryEmission();
 
         // dust self-absorption iteration segments
-        if (_config->hasDustSelfAbsorption()) runDustSelfAbsorptionPhase();
+        if (_config->hasDustSelfAbsorption() && _checkpointStage < CheckpointStage::SelfAbsorptionPhase)
+            runDustSelfAbsorptionPhase();
 
         // secondary emission segment
-        if (_config->hasSecondaryEmission()) runSecondaryEmission();
+        if (_config->hasSecondaryEmission() && _checkpointStage < CheckpointStage::SecondaryEmission)
+            runSecondaryEmission();
     }
 
     // write final output
@@ -85,6 +96,9 @@ void MonteCarloSimulation::runSimulation()
         // write instrument output
         instrumentSystem()->flush();
         instrumentSystem()->write();
+
+        // wait for the output files being written in the background
+        outputWriter()->wait();
     }
 }
 
@@ -111,16 +125,27 @@ void MonteCarloSimulation::runPrimaryEmission()
     else
     {
         initProgress(segment, Npp);
+        random()->startSeries();
         sourceSystem()->prepareForLaunch(Npp);
-        auto parallel = find<ParallelFactory>()->parallelDistributed();
-        parallel->call(
-            Npp, [this](size_t i, size_t n) { performLifeCycle(i, n, true, true, _config->hasRadiationField()); });
+
+        // in data-parallel mode, each process launches the photon packets for an equal share of the history indices
+        size_t first = 0;
+        size_t num = Npp;
+        if (isDataParallel())
+        {
+            size_t rank = ProcessManager::rank();
+            size_t size = ProcessManager::size();
+            first = Npp * rank / size;
+            num = Npp * (rank + 1) / size - first;
+        }
+        launchPhotonPackets(first, num, true, true, _config->hasRadiationField());
         instrumentSystem()->flush();
     }
 
     // wait for all processes to finish and synchronize the radiation field
     wait(segment);
     if (_config->hasRadiationField()) mediumSystem()->communicateRadiationField(true);
+    writeCheckpoint(CheckpointStage::PrimaryEmission);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -137,21 +162,20 @@ void MonteCarloSimulation::runDustSelfAbsorptionPhase()
         return;
     }
 
-    // get the parallel engine
-    auto parallel = find<ParallelFactory>()->parallelDistributed();
-
     // get the parameters controlling the self-absorption iteration
     int minIters = _config->minIterations();
     int maxIters = _config->maxIterations();
     double fractionOfPrimary = _config->maxFractionOfPrimary();
     double fractionOfPrevious = _config->maxFractionOfPrevious();
 
-    // initialize the total absorbed luminosity in the previous iteration
-    double prevLabsdust = 0.;
+    // initialize the total absorbed luminosity in the previous iteration,
+    // continuing after the last completed iteration if the state was restored from a checkpoint
+    int firstIter = _checkpointIteration + 1;
+    double prevLabsdust = _checkpointPrevLabsdust;
 
     // iterate over the maximum number of iterations; the loop body returns from the function
     // when convergence is reached after the minimum number of iterations have been completed
-    for (int iter = 1; iter <= maxIters; iter++)
+    for (int iter = firstIter; iter <= maxIters; iter++)
     {
         string segment = "dust self-absorption iteration " + std::to_string(iter);
         {
@@ -169,7 +193,9 @@ void MonteCarloSimulation::runDustSelfAbsorptionPhase()
 
             // launch photon packets
             initProgress(segment, Npp);
-            parallel->call(Npp, [this](size_t i, size_t n) { performLifeCycle(i, n, false, false, true); });
+            random()->startSeries();
+            launchPhotonPackets(_secondarySourceSystem->firstLocalHistoryIndex(),
+                                _secondarySourceSystem->numLocalHistories(), false, false, true);
             instrumentSystem()->flush();
 
             // wait for all processes to finish and synchronize the radiation field
@@ -220,6 +246,7 @@ void MonteCarloSimulation::runDustSelfAbsorptionPhase()
                 || abs((Labsdust - prevLabsdust) / Labsdust) < fractionOfPrevious)
             {
                 log()->info("Convergence reached after " + std::to_string(iter) + " iterations");
+                writeCheckpoint(CheckpointStage::SelfAbsorptionPhase, iter, Labsdust);
                 return;  // end the iteration by returning from the function
             }
             else
@@ -228,10 +255,12 @@ void MonteCarloSimulation::runDustSelfAbsorptionPhase()
             }
         }
         prevLabsdust = Labsdust;
+        if (iter < maxIters) writeCheckpoint(CheckpointStage::SelfAbsorptionIteration, iter, Labsdust);
     }
 
     // if the loop runs out, convergence was not reached even after the maximum number of iterations
     log()->error("Convergence not yet reached after " + std::to_string(maxIters) + " iterations");
+    writeCheckpoint(CheckpointStage::SelfAbsorptionPhase, maxIters, prevLabsdust);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -257,14 +286,16 @@ void MonteCarloSimulation::runSecondaryEmission()
     else
     {
         initProgress(segment, Npp);
-        auto parallel = find<ParallelFactory>()->parallelDistributed();
-        parallel->call(Npp, [this, storeRF](size_t i, size_t n) { performLifeCycle(i, n, false, true, storeRF); });
+        random()->startSeries();
+        launchPhotonPackets(_secondarySourceSystem->firstLocalHistoryIndex(),
+                            _secondarySourceSystem->numLocalHistories(), false, true, storeRF);
         instrumentSystem()->flush();
     }
 
     // wait for all processes to finish and synchronize the radiation field if needed
     wait(segment);
     if (storeRF) mediumSystem()->communicateRadiationField(false);
+    writeCheckpoint(CheckpointStage::SecondaryEmission);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -280,6 +311,130 @@ void MonteCarloSimulation::wait(std::string scope)
 
 ////////////////////////////////////////////////////////////////////
 
+void MonteCarloSimulation::writeCheckpoint(CheckpointStage stage, int iteration, double prevLabsdust)
+{
+    if (!_config->checkpointing()) return;
+
+    // write the state to a new checkpoint file, which replaces the previous one only when complete
+    string filepath = checkpointFilePath();
+    CheckpointOutFile out(filepath);
+    out.write("number of processes", ProcessManager::size());
+    out.write("stage", static_cast<int>(stage));
+    out.write("iteration", iteration);
+    out.write("previous absorbed dust luminosity", prevLabsdust);
+    random()->saveCheckpoint(out);
+    if (_config->hasRadiationField()) mediumSystem()->saveRadiationField(out);
+    instrumentSystem()->saveCheckpoint(out);
+    probeSystem()->saveCheckpoint(out);
+    out.close();
+
+    log()->info("Wrote checkpoint (" + StringUtils::toMemSizeString(out.numBytes()) + ") to " + filepath);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MonteCarloSimulation::readCheckpoint()
+{
+    // read the state from the checkpoint file
+    string filepath = checkpointFilePath();
+    log()->info("Reading checkpoint from " + filepath + "...");
+    CheckpointInFile in(filepath);
+    if (static_cast<int>(in.read("number of processes")) != ProcessManager::size())
+        throw FATALERROR("Checkpoint file " + filepath + " was written by a run with a different number of processes");
+    int stage = static_cast<int>(in.read("stage"));
+    _checkpointIteration = static_cast<int>(in.read("iteration"));
+    _checkpointPrevLabsdust = in.read("previous absorbed dust luminosity");
+    random()->restoreCheckpoint(in);
+    if (_config->hasRadiationField()) mediumSystem()->restoreRadiationField(in);
+    instrumentSystem()->restoreCheckpoint(in);
+    probeSystem()->restoreCheckpoint(in);
+    in.close();
+
+    // verify that all processes resume from the same stage
+    Array stages = {static_cast<double>(stage), static_cast<double>(_checkpointIteration)};
+    ProcessManager::sumToAll(stages);
+    if (stages[0] != stage * ProcessManager::size() || stages[1] != _checkpointIteration * ProcessManager::size())
+        throw FATALERROR("The checkpoint files written by the different processes correspond to different stages");
+    _checkpointStage = static_cast<CheckpointStage>(stage);
+
+    // log the stage from which the simulation is resumed
+    switch (_checkpointStage)
+    {
+        case CheckpointStage::None: break;
+        case CheckpointStage::PrimaryEmission: log()->info("Resuming simulation after primary emission"); break;
+        case CheckpointStage::SelfAbsorptionIteration:
+            log()->info("Resuming simulation after dust self-absorption iteration "
+                        + std::to_string(_checkpointIteration));
+            break;
+        case CheckpointStage::SelfAbsorptionPhase:
+            log()->info("Resuming simulation after the dust self-absorption phase");
+            break;
+        case CheckpointStage::SecondaryEmission: log()->info("Resuming simulation after secondary emission"); break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+string MonteCarloSimulation::checkpointFilePath() const
+{
+    string name = "checkpoint";
+    if (!ProcessManager::isRoot()) name += "P" + StringUtils::padLeft(std::to_string(ProcessManager::rank()), 3, '0');
+    return find<FilePaths>()->output(name + ".dat");
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool MonteCarloSimulation::isDataParallel() const
+{
+    return _config->hasMedium() && mediumSystem()->isDataParallel();
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MonteCarloSimulation::launchPhotonPackets(size_t firstIndex, size_t numIndices, bool primary, bool peel,
+                                               bool store)
+{
+    auto target = [this, firstIndex, primary, peel, store](size_t i, size_t n) {
+        performLifeCycle(firstIndex + i, n, primary, peel, store);
+    };
+
+    // in data-parallel mode, use all threads of this process with independent random numbers in each process,
+    // and regularly forward the radiation field contributions for cells owned by other processes
+    auto parfac = find<ParallelFactory>();
+    if (isDataParallel())
+    {
+        auto parallel = parfac->parallelLocal();
+        random()->switchToArbitrary();
+        parallel->call(numIndices, target, [this]() { mediumSystem()->forwardRadiationField(); });
+        random()->switchToPredictable();
+        logLoadBalance(parallel);
+    }
+    else
+    {
+        auto parallel = parfac->parallelDistributed();
+        parallel->call(numIndices, target);
+        logLoadBalance(parallel);
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void MonteCarloSimulation::logLoadBalance(const Parallel* parallel)
+{
+    vector<double> fractions = parallel->busyFractions();
+    if (fractions.size() > 1)
+    {
+        double minFraction = *std::min_element(fractions.begin(), fractions.end());
+        double maxFraction = *std::max_element(fractions.begin(), fractions.end());
+        double avgFraction = std::accumulate(fractions.begin(), fractions.end(), 0.) / fractions.size();
+        log()->info("Threads were busy for " + StringUtils::toString(minFraction * 100., 'f', 1) + "% to "
+                    + StringUtils::toString(maxFraction * 100., 'f', 1) + "% (average "
+                    + StringUtils::toString(avgFraction * 100., 'f', 1) + "%) of the elapsed time");
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
 void MonteCarloSimulation::initProgress(string segment, size_t numTotal)
 {
     _segment = segment;
@@ -318,6 +473,7 @@ void MonteCarloSimulation::performLifeCycle(size_t firstIndex, size_t numIndices
         for (size_t historyIndex = firstIndex; historyIndex != firstIndex + currentChunkSize; ++historyIndex)
         {
             // launch a photon packet from the requested source
+            random()->startStream(historyIndex);
             if (primary)
                 sourceSystem()->launch(&pp, historyIndex);
             else
@@ -343,6 +499,7 @@ void MonteCarloSimulation::performLifeCycle(size_t firstIndex, size_t numIndices
                     }
                 }
             }
+            random()->endStream();
         }
 
         // log progress
@@ -472,7 +629,7 @@ void MonteCarloSimulation::simulatePropagation(PhotonPacket* pp)
     double albedo;
     if (!_config->hasMovingMedia())
     {
-        albedo = mediumSystem()->albedo(pp->wavelength(), m);
+        albedo = mediumSystem()->albedo(pp->wavelength(), m, mediumSystem()->wavelengthIndices(pp));
     }
     else
     {
@@ -529,21 +686,32 @@ void MonteCarloSimulation::peelOffScattering(const PhotonPacket* pp, PhotonPacke
         lambda = pp->perceivedWavelength(bfv);
     }
 
-    // determine the weighting factor for each medium component as its scattering opacity (n * sigma_sca)
+    // determine the weighting factor for each medium component as its scattering opacity (n * sigma_sca),
+    // and the asymmetry parameter for components using the Henyey-Greenstein phase function;
+    // because these values are the same for all instruments, we resolve the perceived wavelength
+    // in the wavelength grid of each medium component only once, or use the indices cached in the photon packet
+    const int* ellv = mediumSystem()->wavelengthIndices(pp);
     int numMedia = mediumSystem()->numMedia();
     ShortArray<8> wv(numMedia);
+    ShortArray<8> gv(numMedia);
+    double sum = 0.;
+    for (int h = 0; h != numMedia; ++h)
+    {
+        auto mix = mediumSystem()->mix(m, h);
+        int ell = ellv ? ellv[h] : mix->indexForLambda(lambda);
+        if (numMedia > 1)
+        {
+            wv[h] = mediumSystem()->opacitySca(lambda, ell, m, h);
+            sum += wv[h];
+        }
+        if (mix->scatteringMode() == MaterialMix::ScatteringMode::HenyeyGreenstein) gv[h] = mix->asymmpar(lambda, ell);
+    }
     if (numMedia == 1)
     {
         wv[0] = 1.;
     }
     else
     {
-        double sum = 0.;
-        for (int h = 0; h != numMedia; ++h)
-        {
-            wv[h] = mediumSystem()->opacitySca(lambda, m, h);
-            sum += wv[h];
-        }
         if (sum <= 0) return;  // abort peel-off if none of the media scatters
         for (int h = 0; h != numMedia; ++h) wv[h] /= sum;
     }
@@ -569,7 +737,7 @@ void MonteCarloSimulation::peelOffScattering(const PhotonPacket* pp, PhotonPacke
                     {
                         // calculate the value of the Henyey-Greenstein phase function
                         double costheta = Vec::dot(pp->direction(), bfkobs);
-                        double g = mix->asymmpar(lambda);
+                        double g = gv[h];
                         double t = 1.0 + g * g - 2 * g * costheta;
                         double value = (1.0 - g) * (1.0 + g) / sqrt(t * t * t);
 
@@ -649,8 +817,11 @@ void MonteCarloSimulation::simulateScattering(PhotonPacket* pp)
         lambda = pp->perceivedWavelength(bfv);
     }
 
-    // randomly select a material mix; the probability of each component is weighted by the scattering opacity
-    auto mix = mediumSystem()->randomMixForScattering(random(), lambda, m);
+    // randomly select a material mix; the probability of each component is weighted by the scattering opacity;
+    // without kinematics and for spatially constant media, use the material wavelength indices cached in the packet
+    const int* ellv = mediumSystem()->wavelengthIndices(pp);
+    int h = mediumSystem()->randomMediumForScattering(random(), lambda, m, ellv);
+    auto mix = mediumSystem()->mix(m, h);
 
     // now perform the scattering using this material mix
     //   - determine the new propagation direction
@@ -662,7 +833,7 @@ void MonteCarloSimulation::simulateScattering(PhotonPacket* pp)
         {
             // sample a scattering angle from the Henyey-Greenstein phase function
             // handle isotropic scattering separately because the HG sampling procedure breaks down in this case
-            double g = mix->asymmpar(lambda);
+            double g = ellv ? mix->asymmpar(lambda, ellv[h]) : mix->asymmpar(lambda);
             if (fabs(g) < 1e-6)
             {
                 bfknew = random()->direction();
@@ -14,6 +14,7 @@
 #include "Simulation.hpp"
 #include "SourceSystem.hpp"
 #include <atomic>
+class Parallel;
 class SecondarySourceSystem;
 
 //////////////////////////////////////////////////////////////////////
@@ -160,7 +161,12 @@ protected:
         performLifeCycle() function in appropriately parallelized code depending on the run-time
         environment and the command-line options. After each of the segments but the last one, the
         function also tells the medium system to synchronize the radiation field between processes
-        (in a multi-process environment). */
+        (in a multi-process environment).
+
+        If checkpointing has been enabled, the function writes a checkpoint of the simulation state
+        after each segment, and after each iteration in the dust self-absorption phase. If the
+        simulation should be resumed, the function first restores the state from the last
+        checkpoint, and then skips the segments that had been completed. */
     void runSimulation() override;
 
 private:
@@ -201,6 +207,55 @@ private:
         process, the function does nothing. */
     void wait(string scope);
 
+    /** This enumeration indicates the last simulation segment completed before a checkpoint was
+        written. */
+    enum class CheckpointStage {
+        None,
+        PrimaryEmission,
+        SelfAbsorptionIteration,
+        SelfAbsorptionPhase,
+        SecondaryEmission
+    };
+
+    /** If checkpointing has been enabled, this function writes the simulation state to the
+        checkpoint file for this process, replacing the previous checkpoint. The state includes the
+        radiation field, the data recorded by the instruments and the probes, and the random series
+        number, in addition to the specified last completed stage, the number of completed dust
+        self-absorption iterations, and the absorbed dust luminosity in the last iteration. The
+        function should be called in serial code after the radiation field has been synchronized
+        between processes. If checkpointing has not been enabled, the function does nothing. */
+    void writeCheckpoint(CheckpointStage stage, int iteration = 0, double prevLabsdust = 0.);
+
+    /** This function restores the simulation state from the checkpoint file for this process,
+        including the last completed stage and the information needed to resume the dust
+        self-absorption iteration, which is stored in data members. The function throws a fatal
+        error if the checkpoint does not match the simulation, or if the checkpoints written by
+        the different processes do not correspond to the same stage. */
+    void readCheckpoint();
+
+    /** This function returns the path of the checkpoint file for this process. */
+    string checkpointFilePath() const;
+
+    /** This function returns true if the radiation field is partitioned over the processes in
+        data-parallel mode (see MediumSystem::isDataParallel()), and false otherwise, including
+        when the simulation has no media. */
+    bool isDataParallel() const;
+
+    /** This function launches the photon packets with history indices in the specified range
+        through the performLifeCycle() function with the specified flags, in parallel, and logs the
+        load balancing statistics. Without data parallelization, the range is distributed over all
+        threads in all processes. In data-parallel mode, each process launches its own range with
+        all of its threads, using independent random numbers, while the parent thread regularly
+        forwards the radiation field contributions for cells owned by other processes. */
+    void launchPhotonPackets(size_t firstIndex, size_t numIndices, bool primary, bool peel, bool store);
+
+    /** This function logs the load balancing statistics of the most recent invocation of the
+        call() function on the specified Parallel instance, i.e. the range and average of the
+        fraction of the elapsed time during which each of the execution threads was busy. If no
+        statistics are available, or if there is only a single thread, the function does nothing.
+        */
+    void logLoadBalance(const Parallel* parallel);
+
     /** This function initializes the progress counter used in logprogress() for the specified
         segment and logs the number of photon packets to be processed. */
     void initProgress(string segment, size_t numTotal);
@@ -463,6 +518,11 @@ private:
 
     // data members used by the XXXprogress() functions in this class
     string _segment;  // a string identifying the photon shooting segment for use in the log message
+
+    // data members describing the last completed stage, restored from a checkpoint if the simulation is resumed
+    CheckpointStage _checkpointStage{CheckpointStage::None};
+    int _checkpointIteration{0};         // the number of completed dust self-absorption iterations
+    double _checkpointPrevLabsdust{0.};  // the absorbed dust luminosity in the last completed iteration
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -70,6 +70,9 @@ void MultiHybridParallel::call(size_t maxIndex, std::function<void(size_t, size_
         // Activate child threads
         activateThreads();
 
+        // Request a first chunk from the root process before any of the child threads needs it
+        ProcessManager::postChunkRequest();
+
         // Serve chunks to the child threads upon their request
         bool success = true;
         while (success)
@@ -80,9 +83,11 @@ void MultiHybridParallel::call(size_t maxIndex, std::function<void(size_t, size_
                 while (!_requests || _ready) _conditionParent.wait(lock);
             }
 
-            // Request a new chunk from the root process
+            // Obtain the chunk requested earlier from the root process, and if there was one,
+            // immediately request the next chunk so that it is in flight while the current one is being performed
             size_t firstIndex, numIndices;
-            success = ProcessManager::requestChunk(firstIndex, numIndices);
+            success = ProcessManager::completeChunkRequest(firstIndex, numIndices);
+            if (success) ProcessManager::postChunkRequest();
 
             // Serve the chunk to one of our child threads, or tell our child threads that there are no more chunks
             {
@@ -104,7 +109,7 @@ void MultiHybridParallel::call(size_t maxIndex, std::function<void(size_t, size_
 
 ////////////////////////////////////////////////////////////////////
 
-bool MultiHybridParallel::doSomeWork()
+bool MultiHybridParallel::doSomeWork(int /*threadIndex*/)
 {
     // In the root process, we share the chunk maker with the parent thread
     if (ProcessManager::isRoot())
@@ -16,9 +16,11 @@
     that purpose, while the parent thread is used for communication among the processes (the MPI
     functions should be called only from the main thread). In the root process, the parent thread
     serves chunks of work to the other processes. In the non-root processes, the parent thread
-    requests chunks from the root process for all of the local parallel threads. The extra thread
-    in each process is not counted towards the number of threads specified by the user because the
-    communication does not consume significant resources.
+    requests chunks from the root process for all of the local parallel threads. It always keeps
+    a request for the next chunk in flight, so that a child thread asking for work can usually be
+    served without waiting for a round trip to the root process. The extra thread in each process
+    is not counted towards the number of threads specified by the user because the communication
+    does not consume significant resources.
 
     This class uses the facilities offered by the MultiParallel base class. */
 class MultiHybridParallel : public MultiParallel
@@ -48,7 +50,7 @@ public:
 
 private:
     /** The function to do the actual work, one chunk at a time. */
-    bool doSomeWork() override;
+    bool doSomeWork(int threadIndex) override;
 
     //======================== Data Members ========================
 
@@ -8,6 +8,14 @@
 
 ////////////////////////////////////////////////////////////////////
 
+namespace
+{
+    // the time interval between invocations of the service function while waiting for the child threads
+    const auto serviceInterval = std::chrono::milliseconds(50);
+}
+
+////////////////////////////////////////////////////////////////////
+
 void MultiParallel::constructThreads(int numThreads)
 {
     // Remember the number of threads
@@ -17,6 +25,8 @@ void MultiParallel::constructThreads(int numThreads)
     {
         std::unique_lock<std::mutex> lock(_mutex);
         _active.assign(_numThreads, true);
+        _busyTimes.assign(_numThreads, 0.);
+        _activationTime = std::chrono::steady_clock::now();
         for (int index = 0; index != _numThreads; ++index)
         {
             _threads.push_back(std::thread(&MultiParallel::run, this, index));
@@ -50,6 +60,8 @@ void MultiParallel::activateThreads()
     std::unique_lock<std::mutex> lock(_mutex);
     _active.assign(_numThreads, true);
     _exception = nullptr;
+    _busyTimes.assign(_numThreads, 0.);
+    _activationTime = std::chrono::steady_clock::now();
     _conditionChildren.notify_all();
 }
 
@@ -57,10 +69,22 @@ void MultiParallel::activateThreads()
 
 void MultiParallel::waitForThreads()
 {
-    // Wait until all parallel threads are inactive
+    // Wait until all parallel threads are inactive, invoking the service function (if any) at regular intervals
     {
         std::unique_lock<std::mutex> lock(_mutex);
-        while (threadsActive()) _conditionParent.wait(lock);
+        while (threadsActive())
+        {
+            if (_service)
+            {
+                _conditionParent.wait_for(lock, serviceInterval);
+                lock.unlock();
+                _service();
+                lock.lock();
+            }
+            else
+                _conditionParent.wait(lock);
+        }
+        _elapsedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - _activationTime).count();
     }
 
     // Check for and process the exception, if any
@@ -102,7 +126,7 @@ void MultiParallel::run(int threadIndex)
         // Do work as long as some is available for this cycle, and handle exceptions
         try
         {
-            while (!_terminate && doSomeWork())
+            while (!_terminate && doSomeWork(threadIndex))
                 ;
         }
         catch (FatalError& error)
@@ -115,11 +139,25 @@ void MultiParallel::run(int threadIndex)
             // Create a fresh exception
             reportException(new FATALERROR("Unhandled exception (not of type FatalError) in a parallel thread"));
         }
+
+        // Remember the time until this thread ran out of work
+        _busyTimes[threadIndex] =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - _activationTime).count();
     }
 }
 
 ////////////////////////////////////////////////////////////////////
 
+vector<double> MultiParallel::busyFractions() const
+{
+    vector<double> result(_busyTimes.size());
+    for (size_t i = 0; i != result.size(); ++i)
+        result[i] = _elapsedTime > 0. ? min(1., _busyTimes[i] / _elapsedTime) : 1.;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////
+
 bool MultiParallel::threadsActive()
 {
     // Check for active threads
@@ -8,6 +8,7 @@
 
 #include "Parallel.hpp"
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -32,7 +33,11 @@ class FatalError;
     This class uses the standard low-level C++ multi-threading capabilities. It is designed to
     minimize the run-time overhead for handing out parallel tasks. Between invocations of the
     call() function, the parallel threads are put in wait so that they consume no CPU cycles (and
-    very little memory). */
+    very little memory).
+
+    The class also keeps track of the time between the activation of the child threads and the
+    moment each thread runs out of work, so that it can report load imbalance between the threads
+    through the busyFractions() function. */
 class MultiParallel : public Parallel
 {
     //============== Facilities offered by this class ==============
@@ -58,6 +63,12 @@ protected:
         thread) specified to constructThreads(). */
     int numThreads() { return _numThreads; }
 
+public:
+    /** This function returns, for each child thread, the fraction of the elapsed wall-clock time
+        between the most recent activation of the threads and the moment all threads became
+        inactive during which the thread was performing work. */
+    vector<double> busyFractions() const override;
+
 private:
     /** This function gets executed inside each of the parallel threads. */
     void run(int threadIndex);
@@ -74,8 +85,9 @@ private:
 
     /** The function to do the actual work; called from within run(). The function should perform
         some limited amount of work and then return true if more work might be available for this
-        cycle, and false if not. */
-    virtual bool doSomeWork() = 0;
+        cycle, and false if not. The argument specifies the index of the calling child thread, in
+        the range from zero to the number of child threads minus one. */
+    virtual bool doSomeWork(int threadIndex) = 0;
 
     //======================== Data Members ========================
 
@@ -95,6 +107,11 @@ private:
     FatalError* _exception{nullptr};      // a pointer to a heap-allocated copy of the exception thrown
                                           // ...  by a child thread or null if no exception was thrown
     std::atomic<bool> _terminate{false};  // becomes true when the child threads must exit
+
+    // load balancing statistics; each child thread writes only its own busy time
+    std::chrono::steady_clock::time_point _activationTime;  // the time of the most recent activation
+    double _elapsedTime{0.};                                 // the elapsed time until all threads became inactive
+    std::vector<double> _busyTimes;                          // busy time for each child thread
 };
 
 ////////////////////////////////////////////////////////////////////
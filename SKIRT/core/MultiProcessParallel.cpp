@@ -65,17 +65,23 @@ void MultiProcessParallel::call(size_t maxIndex, std::function<void(size_t, size
         waitForThreads();
     }
 
-    // In non-root processes, the parent (and only) thread performs work in a straightforward loop
+    // In non-root processes, the parent (and only) thread performs work in a straightforward loop,
+    // requesting the next chunk before performing the current one to hide the communication latency
     else
     {
         size_t firstIndex, numIndices;
-        while (ProcessManager::requestChunk(firstIndex, numIndices)) target(firstIndex, numIndices);
+        ProcessManager::postChunkRequest();
+        while (ProcessManager::completeChunkRequest(firstIndex, numIndices))
+        {
+            ProcessManager::postChunkRequest();
+            target(firstIndex, numIndices);
+        }
     }
 }
 
 ////////////////////////////////////////////////////////////////////
 
-bool MultiProcessParallel::doSomeWork()
+bool MultiProcessParallel::doSomeWork(int /*threadIndex*/)
 {
     return _chunkMaker.callForNext(_target);
 }
@@ -17,7 +17,9 @@
     processes (the MPI functions should be called only from the main thread). This extra thread is
     not counted towards the number of threads specified by the user because it does not consume
     significant resources. In the other (non-root) processes, there is no extra thread; the work is
-    performed in a loop that simply requests and performs new chunks.
+    performed in a loop that requests and performs new chunks. The request for the next chunk is
+    posted before performing the current chunk, so that the communication with the root process
+    overlaps with the actual work.
 
     This class uses the facilities offered by the MultiParallel base class. */
 class MultiProcessParallel : public MultiParallel
@@ -47,7 +49,7 @@ public:
 
 private:
     /** The function to do the actual work, one chunk at a time. */
-    bool doSomeWork() override;
+    bool doSomeWork(int threadIndex) override;
 
     //======================== Data Members ========================
 
@@ -36,9 +36,9 @@ void MultiThreadParallel::call(size_t maxIndex, std::function<void(size_t, size_
 
 ////////////////////////////////////////////////////////////////////
 
-bool MultiThreadParallel::doSomeWork()
+bool MultiThreadParallel::doSomeWork(int threadIndex)
 {
-    return _chunkMaker.callForNext(_target);
+    return _chunkMaker.callForNext(threadIndex, _target);
 }
 
 ////////////////////////////////////////////////////////////////////
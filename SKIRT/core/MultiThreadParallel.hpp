@@ -6,13 +6,14 @@
 #ifndef MULTITHREADPARALLEL_HPP
 #define MULTITHREADPARALLEL_HPP
 
-#include "ChunkMaker.hpp"
 #include "MultiParallel.hpp"
+#include "WorkStealingChunkMaker.hpp"
 
 ////////////////////////////////////////////////////////////////////
 
 /** This class implements the Parallel base class interface using multiple execution threads in a
-    single process. It uses the facilities offered by the MultiParallel base class. */
+    single process. It uses the facilities offered by the MultiParallel base class, and it
+    distributes the tasks over the threads using a WorkStealingChunkMaker instance. */
 class MultiThreadParallel : public MultiParallel
 {
     friend class ParallelFactory;  // so ParallelFactory can access our private constructor
@@ -37,13 +38,13 @@ public:
 
 protected:
     /** The function to do the actual work, one chunk at a time. */
-    bool doSomeWork() override;
+    bool doSomeWork(int threadIndex) override;
 
     //======================== Data Members ========================
 
 private:
     std::function<void(size_t, size_t)> _target;  // the target function to be called
-    ChunkMaker _chunkMaker;                       // the chunk maker
+    WorkStealingChunkMaker _chunkMaker;           // the chunk maker
 };
 
 ////////////////////////////////////////////////////////////////////
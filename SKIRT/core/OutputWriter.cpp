@@ -0,0 +1,161 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#include "OutputWriter.hpp"
+#include "FatalError.hpp"
+#include "Log.hpp"
+#include "ParallelFactory.hpp"
+#include "System.hpp"
+
+////////////////////////////////////////////////////////////////////
+
+OutputWriter::OutputWriter(SimulationItem* parent)
+{
+    parent->addChild(this);
+}
+
+////////////////////////////////////////////////////////////////////
+
+OutputWriter::~OutputWriter()
+{
+    // Ask the background threads to exit after completing the remaining tasks
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _terminate = true;
+        _conditionChildren.notify_all();
+    }
+
+    // Wait for them to do so
+    for (auto& thread : _threads) thread.join();
+
+    // Log any exception that has not been reported by the wait() function
+    if (_exception && _log)
+    {
+        _log->error("Error while writing output in the background");
+        for (string line : _exception->message()) _log->error(line);
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void OutputWriter::setNumThreads(int value)
+{
+    _numThreads = max(0, value);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void OutputWriter::setFITSCompression(FITSInOut::Compression value)
+{
+    _compression = value;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void OutputWriter::submit(std::function<void()> task, size_t numBytes)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        startThreads();
+
+        // Queue the task if there are background threads, waiting for memory to become available if needed
+        if (_numThreads)
+        {
+            while (_pendingBytes && _pendingBytes + numBytes > _maxPendingBytes) _conditionParent.wait(lock);
+            _tasks.emplace_back(std::move(task), numBytes);
+            _pendingBytes += numBytes;
+            _conditionChildren.notify_one();
+            return;
+        }
+    }
+
+    // Otherwise perform the task right away
+    task();
+}
+
+////////////////////////////////////////////////////////////////////
+
+void OutputWriter::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_tasks.empty() || _numBusy) _conditionParent.wait(lock);
+
+    // Check for and process the exception, if any
+    if (_exception)
+    {
+        FatalError error(*_exception);
+        _exception.reset();
+        throw error;
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void OutputWriter::startThreads()
+{
+    if (_numThreads < 0)
+    {
+        auto factory = find<ParallelFactory>(false);
+        _numThreads = factory ? factory->maxThreadCount() : 1;
+    }
+    if (_numThreads && _threads.empty())
+    {
+        // remember the log so that the destructor can report errors that have not been handled
+        _log = find<Log>(false);
+
+        // allow the pending tasks to hold a quarter of the physical memory (without limit if it is unknown)
+        size_t memory = System::availableMemory();
+        _maxPendingBytes = memory ? memory / 4 : std::numeric_limits<size_t>::max();
+        for (int index = 0; index != _numThreads; ++index) _threads.push_back(std::thread(&OutputWriter::run, this));
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void OutputWriter::run()
+{
+    while (true)
+    {
+        // Wait for a new task in a critical section
+        std::pair<std::function<void()>, size_t> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (_tasks.empty() && !_terminate) _conditionChildren.wait(lock);
+            if (_tasks.empty()) return;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+            _numBusy++;
+        }
+
+        // Perform the task, and remember the first exception
+        std::unique_ptr<FatalError> exception;
+        try
+        {
+            task.first();
+        }
+        catch (FatalError& error)
+        {
+            exception.reset(new FatalError(error));
+        }
+        catch (...)
+        {
+            exception.reset(new FATALERROR("Unhandled exception (not of type FatalError) while writing output"));
+        }
+
+        // Release the task's resources before reporting completion
+        task.first = nullptr;
+
+        // Report completion in a critical section
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (exception && !_exception) _exception = std::move(exception);
+            _numBusy--;
+            _pendingBytes -= task.second;
+            _conditionParent.notify_all();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////
@@ -0,0 +1,124 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#ifndef OUTPUTWRITER_HPP
+#define OUTPUTWRITER_HPP
+
+#include "FITSInOut.hpp"
+#include "SimulationItem.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+class FatalError;
+class Log;
+
+////////////////////////////////////////////////////////////////////
+
+/** An OutputWriter object manages a pool of background threads that write output files on behalf
+    of the simulation, so that the threads producing the output (and the other output files) do not
+    have to wait for each file to be written. The recommended use is to have a single OutputWriter
+    instance per simulation, hooked into the simulation hierarchy as a child of the Simulation
+    object so that it can be located with the find() function. Currently, the FITSInOut class
+    hands all FITS output files to the writer, if there is one.
+
+    A client submits a task that writes a single file, together with the number of bytes of data
+    held by the task. The tasks are performed in order of submission by the first available thread,
+    so that independent files are written in parallel. To limit the memory consumption, the
+    submit() function blocks as long as the data held by tasks that have not yet been completed
+    exceeds a fraction of the available memory. The wait() function blocks until all submitted tasks
+    have been completed; it should be called before the output is assumed to be present, e.g. at
+    the end of the simulation.
+
+    The number of background threads can be configured with the setNumThreads() function. If the
+    number of threads is zero, each task is performed immediately in the context of the submitting
+    thread. By default, the number of threads equals the maximum number of parallel threads
+    configured for the simulation. The threads are created when the first task is submitted.
+
+    When a task throws an exception, the other tasks are still performed, and the wait() function
+    throws a FatalError in the context of the calling thread. If the original exception was a
+    FatalError instance, the newly thrown exception is a copy thereof. Otherwise a fresh FatalError
+    instance is created with a generic error message.
+
+    The OutputWriter object also holds the compression type to be used for FITS output files, which
+    can be configured with the setFITSCompression() function. By default, FITS files are not
+    compressed. */
+class OutputWriter : public SimulationItem
+{
+    //============= Construction - Setup - Destruction =============
+
+public:
+    /** This constructor creates an output writer that is hooked up as a child to the specified
+        parent in the simulation hierarchy, so that it will automatically be deleted. */
+    explicit OutputWriter(SimulationItem* parent);
+
+    /** The destructor waits until all submitted tasks have been completed and releases the
+        background threads. If one of the tasks threw an exception that has not been reported by
+        the wait() function, for example because the simulation was aborted before reaching the
+        end, the error message is written to the simulation log. */
+    ~OutputWriter();
+
+    //====================== Other Functions =======================
+
+public:
+    /** Sets the number of background threads for writing output files. A value of zero causes all
+        tasks to be performed synchronously. The number of threads should not be changed after the
+        first task has been submitted. */
+    void setNumThreads(int value);
+
+    /** Sets the compression type for FITS output files. */
+    void setFITSCompression(FITSInOut::Compression value);
+
+    /** Returns the compression type for FITS output files. */
+    FITSInOut::Compression fitsCompression() const { return _compression; }
+
+    /** This function submits the specified task for execution by one of the background threads.
+        The second argument specifies the number of bytes of data held by the task, which is used
+        to limit the memory consumption of the tasks in the queue. If the number of background
+        threads is zero, the task is performed immediately in the context of the calling thread. */
+    void submit(std::function<void()> task, size_t numBytes);
+
+    /** This function blocks until all submitted tasks have been completed. If one of the tasks
+        threw an exception, the function throws a FatalError as described in the class header. */
+    void wait();
+
+private:
+    /** This function creates the background threads, if this has not yet been done. The caller
+        should lock the shared data members of this class instance. */
+    void startThreads();
+
+    /** This function gets executed inside each of the background threads. */
+    void run();
+
+    //======================== Data Members ========================
+
+private:
+    // configuration
+    int _numThreads{-1};  // the number of background threads, or -1 if not yet determined
+    FITSInOut::Compression _compression{FITSInOut::Compression::None};  // the compression type for FITS files
+    size_t _maxPendingBytes{0};  // the maximum amount of data held by tasks that have not been completed
+    Log* _log{nullptr};          // the simulation log, used to report unhandled errors from the destructor
+
+    // the threads
+    std::vector<std::thread> _threads;  // the background threads
+
+    // synchronization
+    std::mutex _mutex;                           // the mutex to synchronize the threads
+    std::condition_variable _conditionChildren;  // the wait condition used by the background threads
+    std::condition_variable _conditionParent;    // the wait condition used by the submitting threads
+
+    // data members shared by all threads; changes are protected by a mutex
+    std::deque<std::pair<std::function<void()>, size_t>> _tasks;  // the tasks that have not yet been started
+    size_t _pendingBytes{0};                 // the amount of data held by tasks that have not been completed
+    int _numBusy{0};                         // the number of tasks currently being performed
+    std::unique_ptr<FatalError> _exception;  // a copy of the first exception thrown by a task, or null
+    bool _terminate{false};                  // becomes true when the background threads must exit
+};
+
+////////////////////////////////////////////////////////////////////
+
+#endif
@@ -69,6 +69,45 @@ public:
          the available parallel resources, while still maximally reducing the overhead of handing
          out the chunks. */
     virtual void call(size_t maxIndex, std::function<void(size_t firstIndex, size_t numIndices)> target) = 0;
+
+    /** This function calls the specified target function in the same way as the call() function
+        with two arguments, and in addition invokes the specified \em service function from the
+        thread that called this function (the parent thread). Depending on the parallelization
+        scheme, the service function is invoked at regular time intervals while the parent thread
+        is waiting for child threads to perform the tasks. In any case, it is invoked once more
+        after all tasks handed to the calling process have been completed. This allows the client
+        to perform work that must be done from the parent thread, such as communicating with
+        other processes, while the tasks are in progress. */
+    void call(size_t maxIndex, std::function<void(size_t firstIndex, size_t numIndices)> target,
+              std::function<void()> service)
+    {
+        _service = service;
+        try
+        {
+            call(maxIndex, target);
+        }
+        catch (...)
+        {
+            _service = nullptr;
+            throw;
+        }
+        _service = nullptr;
+        service();
+    }
+
+    /** This function returns, for each execution thread employed by this Parallel instance, the
+        fraction of the elapsed wall-clock time of the most recent invocation of the call()
+        function during which the thread was busy performing tasks, as opposed to being idle while
+        waiting for the other threads to complete their tasks. These statistics reveal load
+        imbalance between the threads. The default implementation returns an empty list,
+        indicating that no statistics are available. */
+    virtual vector<double> busyFractions() const { return vector<double>(); }
+
+    //======================== Data Members ========================
+
+protected:
+    // the service function for the current invocation of the call() function, or empty if there is none
+    std::function<void()> _service;
 };
 
 ////////////////////////////////////////////////////////////////////
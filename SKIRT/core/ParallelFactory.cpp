@@ -61,7 +61,7 @@ Parallel* ParallelFactory::parallel(TaskMode mode, int maxThreadCount)
 
     // Determine the number of threads
     //  - limited by both the factory maximum and the maximum specified here as an argument
-    //  - reduced to one for Duplicated mode in multiprocessing environment
+    //  - reduced to one for Duplicated mode in multiprocessing environment (but not for Local mode)
     int numThreads = maxThreadCount > 0 ? std::min(maxThreadCount, _maxThreadCount) : _maxThreadCount;
     if (mode == TaskMode::Duplicated && ProcessManager::isMultiProc()) numThreads = 1;
 
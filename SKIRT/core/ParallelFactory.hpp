@@ -30,7 +30,7 @@ class Parallel;
     have a single ParallelFactory instance per simulation, and to use yet another ParallelFactory
     instance to run multiple simulations at the same time.
 
-    ParallelFactory clients can request a Parallel instance for one of the three task allocation
+    ParallelFactory clients can request a Parallel instance for one of the four task allocation
     modes described in the table below.
 
     Task mode | Description
@@ -38,6 +38,7 @@ class Parallel;
     Distributed | All threads in all processes perform the tasks in parallel
     Duplicated | Each process performs all tasks; the results should be identical on all processes
     RootOnly | All threads in the root process perform the tasks in parallel; the other processes ignore the tasks
+    Local | All threads in each process perform the tasks in parallel, independently of any other processes
 
     In support of these task modes, the Parallel class has several subclasses, each implementing
     a specific parallelization scheme as described in the table below.
@@ -59,6 +60,7 @@ class Parallel;
     Distributed  |  S    |  MT   |  MP#  |  MTP# |
     Duplicated   |  S    |  MT   |  S    |  S*   |
     RootOnly     |  S    |  MT   |  S/0  |  MT/0 |
+    Local        |  S    |  MT   |  S    |  MT   |
 
     (#) In Distributed mode with multiple processes, all threads require a different random number
         sequences. Therefore, the MultiProcessParallel and MultiHybridParallel classes swith the Random
@@ -67,6 +69,12 @@ class Parallel;
     (*) In Duplicated mode with multiple processes, all tasks are performed by a single thread
         (in each process) because parallel threads executing tasks in an unpredictable order would
         see different random number sequences, possibly causing differences in the calculated results.
+
+    The Local mode is intended for tasks that do not rely on the predictable random number sequence
+    and that produce results depending only on the task index (and not on the execution order), or
+    for tasks in which each process handles its own portion of the work, such as reading a file or
+    processing a subset of the data in a data-parallelized simulation. In these cases, the tasks can
+    safely be performed by multiple threads in each process even when there are multiple processes.
 */
 class ParallelFactory : public SimulationItem
 {
@@ -105,7 +113,7 @@ public:
 
     /** This enumeration includes a constant for each task allocation mode supported by ParallelFactory
      * and the Parallel subclasses. */
-    enum class TaskMode { Distributed, Duplicated, RootOnly };
+    enum class TaskMode { Distributed, Duplicated, RootOnly, Local };
 
     /** This function returns a Parallel subclass instance of the appropriate type and with an
         appropriate number of execution threads, depending on the requested task allocation mode,
@@ -127,6 +135,9 @@ public:
     /** This function calls the parallel() function for the RootOnly task allocation mode. */
     Parallel* parallelRootOnly(int maxThreadCount = 0) { return parallel(TaskMode::RootOnly, maxThreadCount); }
 
+    /** This function calls the parallel() function for the Local task allocation mode. */
+    Parallel* parallelLocal(int maxThreadCount = 0) { return parallel(TaskMode::Local, maxThreadCount); }
+
     //======================== Data Members ========================
 
 private:
@@ -28,3 +28,17 @@ Snapshot* ParticleMedium::createAndOpenSnapshot()
 }
 
 ////////////////////////////////////////////////////////////////////
+
+void ParticleMedium::cellNumbers(int m, const SpatialGrid* grid, int numSamples,
+                                 vector<std::pair<int, double>>& numberv) const
+{
+    auto particles = static_cast<const ParticleSnapshot*>(snapshot());
+    particles->cellMasses(m, grid, numSamples, numberv);
+    if (!numberv.empty() && !particles->holdsNumber())
+    {
+        double mass = mix(particles->position(m))->mass();
+        for (auto& entry : numberv) entry.second /= mass;
+    }
+}
+
+////////////////////////////////////////////////////////////////////
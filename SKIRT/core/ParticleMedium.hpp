@@ -8,6 +8,7 @@
 
 #include "ImportedMedium.hpp"
 #include "SmoothingKernel.hpp"
+class SpatialGrid;
 
 ////////////////////////////////////////////////////////////////////
 
@@ -73,6 +74,20 @@ protected:
         it, and finally returns a pointer to the object. Ownership of the Snapshot object is
         transferred to the caller. */
     Snapshot* createAndOpenSnapshot() override;
+
+    //======================== Other Functions =======================
+
+public:
+    /** This function determines the portions of the number of material entities represented by
+        the particle with index \em m that fall within each of the cells of the specified spatial
+        grid, and stores the result in the \em numberv vector as a list of (cell index, number)
+        pairs. It obtains the corresponding particle masses from the ParticleSnapshot::cellMasses()
+        function, which integrates the smoothing kernel over the cells using a quadrature with
+        approximately \em numSamples points. If the snapshot holds mass rather than number, the
+        function converts mass to number using the material mix at the particle position. The
+        particle index must be in the range given by the numSites() function; otherwise the
+        behavior is undefined. */
+    void cellNumbers(int m, const SpatialGrid* grid, int numSamples, vector<std::pair<int, double>>& numberv) const;
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -9,6 +9,7 @@
 #include "Random.hpp"
 #include "SmoothedParticleGrid.hpp"
 #include "SmoothingKernel.hpp"
+#include "SpatialGrid.hpp"
 #include "StringUtils.hpp"
 #include "TextInFile.hpp"
 #include "Units.hpp"
@@ -37,23 +38,24 @@ void ParticleSnapshot::readAndClose()
         else if (hasMassDensityPolicy() && row[massIndex()] == 0)
             numMassIgnored++;
         else
-            _propv.push_back(row);
+            storeProperties(row);
     }
 
     // close the file
     Snapshot::readAndClose();
+    finishStoringProperties();
 
     // log the number of particles
     if (!numTempIgnored && !numMassIgnored)
     {
-        log()->info("  Number of particles: " + std::to_string(_propv.size()));
+        log()->info("  Number of particles: " + std::to_string(numStoredEntities()));
     }
     else
     {
         if (numTempIgnored)
             log()->info("  Number of high-temperature particles ignored: " + std::to_string(numTempIgnored));
         if (numMassIgnored) log()->info("  Number of zero-mass particles ignored: " + std::to_string(numMassIgnored));
-        log()->info("  Number of particles retained: " + std::to_string(_propv.size()));
+        log()->info("  Number of particles retained: " + std::to_string(numStoredEntities()));
     }
 
     // we can calculate mass and densities only if a policy has been set
@@ -63,18 +65,16 @@ void ParticleSnapshot::readAndClose()
     double totalOriginalMass = 0;
     double totalMetallicMass = 0;
     double totalEffectiveMass = 0;
-    int numParticles = _propv.size();
+    int numParticles = numStoredEntities();
     _pv.reserve(numParticles);
     for (int m = 0; m != numParticles; ++m)
     {
-        const Array& prop = _propv[m];
-
-        double originalMass = prop[massIndex()];
-        double metallicMass = originalMass * (metallicityIndex() >= 0 ? prop[metallicityIndex()] : 1.);
+        double originalMass = property(m, massIndex());
+        double metallicMass = originalMass * (metallicityIndex() >= 0 ? property(m, metallicityIndex()) : 1.);
         double effectiveMass = metallicMass * multiplier();
 
-        _pv.emplace_back(m, prop[positionIndex() + 0], prop[positionIndex() + 1], prop[positionIndex() + 2],
-                         prop[sizeIndex()], effectiveMass);
+        _pv.emplace_back(m, property(m, positionIndex() + 0), property(m, positionIndex() + 1),
+                         property(m, positionIndex() + 2), property(m, sizeIndex()), effectiveMass);
 
         totalOriginalMass += originalMass;
         totalMetallicMass += metallicMass;
@@ -93,7 +93,7 @@ void ParticleSnapshot::readAndClose()
     if (totalOriginalMass < 0 || totalMetallicMass < 0 || totalEffectiveMass < 0)
     {
         log()->warning("  Total imported mass is negative; suppressing the complete mass distribution");
-        _propv.clear();
+        clearProperties();
         _pv.clear();
         return;  // abort
     }
@@ -130,7 +130,7 @@ void ParticleSnapshot::setSmoothingKernel(const SmoothingKernel* kernel)
 Box ParticleSnapshot::extent() const
 {
     // if there are no particles, return an empty box
-    if (_propv.empty()) return Box();
+    if (!numStoredEntities()) return Box();
 
     // if there is a particle grid, ask it to return the extent (it is already calculated)
     if (_grid) return _grid->extent();
@@ -142,14 +142,16 @@ Box ParticleSnapshot::extent() const
     double ymax = -std::numeric_limits<double>::infinity();
     double zmin = +std::numeric_limits<double>::infinity();
     double zmax = -std::numeric_limits<double>::infinity();
-    for (const Array& prop : _propv)
+    size_t numParticles = numStoredEntities();
+    for (size_t m = 0; m != numParticles; ++m)
     {
-        xmin = min(xmin, prop[positionIndex() + 0] - prop[sizeIndex()]);
-        xmax = max(xmax, prop[positionIndex() + 0] + prop[sizeIndex()]);
-        ymin = min(ymin, prop[positionIndex() + 1] - prop[sizeIndex()]);
-        ymax = max(ymax, prop[positionIndex() + 1] + prop[sizeIndex()]);
-        zmin = min(zmin, prop[positionIndex() + 2] - prop[sizeIndex()]);
-        zmax = max(zmax, prop[positionIndex() + 2] + prop[sizeIndex()]);
+        double h = property(m, sizeIndex());
+        xmin = min(xmin, property(m, positionIndex() + 0) - h);
+        xmax = max(xmax, property(m, positionIndex() + 0) + h);
+        ymin = min(ymin, property(m, positionIndex() + 1) - h);
+        ymax = max(ymax, property(m, positionIndex() + 1) + h);
+        zmin = min(zmin, property(m, positionIndex() + 2) - h);
+        zmax = max(zmax, property(m, positionIndex() + 2) + h);
     }
     return Box(xmin, ymin, zmin, xmax, ymax, zmax);
 }
@@ -158,21 +160,22 @@ Box ParticleSnapshot::extent() const
 
 int ParticleSnapshot::numEntities() const
 {
-    return _propv.size();
+    return numStoredEntities();
 }
 
 ////////////////////////////////////////////////////////////////////
 
 Position ParticleSnapshot::position(int m) const
 {
-    return Position(_propv[m][positionIndex() + 0], _propv[m][positionIndex() + 1], _propv[m][positionIndex() + 2]);
+    return Position(property(m, positionIndex() + 0), property(m, positionIndex() + 1),
+                    property(m, positionIndex() + 2));
 }
 
 ////////////////////////////////////////////////////////////////////
 
 Vec ParticleSnapshot::velocity(int m) const
 {
-    return Vec(_propv[m][velocityIndex() + 0], _propv[m][velocityIndex() + 1], _propv[m][velocityIndex() + 2]);
+    return Vec(property(m, velocityIndex() + 0), property(m, velocityIndex() + 1), property(m, velocityIndex() + 2));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -187,7 +190,7 @@ Vec ParticleSnapshot::velocity(Position bfr) const
 
 double ParticleSnapshot::velocityDispersion(int m) const
 {
-    return _propv[m][velocityDispersionIndex()];
+    return property(m, velocityDispersionIndex());
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -202,8 +205,8 @@ double ParticleSnapshot::velocityDispersion(Position bfr) const
 
 Vec ParticleSnapshot::magneticField(int m) const
 {
-    return Vec(_propv[m][magneticFieldIndex() + 0], _propv[m][magneticFieldIndex() + 1],
-               _propv[m][magneticFieldIndex() + 2]);
+    return Vec(property(m, magneticFieldIndex() + 0), property(m, magneticFieldIndex() + 1),
+               property(m, magneticFieldIndex() + 2));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -220,7 +223,7 @@ void ParticleSnapshot::parameters(int m, Array& params) const
 {
     int n = numParameters();
     params.resize(n);
-    for (int i = 0; i != n; ++i) params[i] = _propv[m][parametersIndex() + i];
+    for (int i = 0; i != n; ++i) params[i] = property(m, parametersIndex() + i);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -261,8 +264,8 @@ double ParticleSnapshot::mass() const
 Position ParticleSnapshot::generatePosition(int m) const
 {
     // get center position and size for this particle
-    Position rc(_propv[m][positionIndex() + 0], _propv[m][positionIndex() + 1], _propv[m][positionIndex() + 2]);
-    double h = _propv[m][sizeIndex()];
+    Position rc = position(m);
+    double h = property(m, sizeIndex());
 
     // sample random position inside the smoothed unit volume
     double u = _kernel->generateRadius();
@@ -276,7 +279,7 @@ Position ParticleSnapshot::generatePosition(int m) const
 Position ParticleSnapshot::generatePosition() const
 {
     // if there are no particles, return the origin
-    if (_propv.empty()) return Position();
+    if (!numStoredEntities()) return Position();
 
     // select a particle according to its mass contribution
     int m = NR::locateClip(_cumrhov, random()->uniform());
@@ -285,3 +288,66 @@ Position ParticleSnapshot::generatePosition() const
 }
 
 ////////////////////////////////////////////////////////////////////
+
+void ParticleSnapshot::cellMasses(int m, const SpatialGrid* grid, int numSamples,
+                                  vector<std::pair<int, double>>& massv) const
+{
+    massv.clear();
+
+    // get center position, size and mass for this particle
+    const SmoothedParticle& p = _pv[m];
+    Vec rc = p.center();
+    double h = p.radius();
+    double M = p.mass();
+
+    // if the grid cells are axis-aligned cuboids, and the center and the extreme points of the kernel
+    // along the coordinate axes lie in the same cell, the kernel is fully contained in that cell;
+    // this does not hold for other cell shapes, or when the points lie outside of the grid
+    if (grid->hasCuboidalCells())
+    {
+        int mc = grid->cellIndex(Position(rc));
+        bool sameCell = mc >= 0;
+        for (Vec d : {Vec(h, 0, 0), Vec(-h, 0, 0), Vec(0, h, 0), Vec(0, -h, 0), Vec(0, 0, h), Vec(0, 0, -h)})
+        {
+            if (sameCell && grid->cellIndex(Position(rc + d)) != mc) sameCell = false;
+        }
+        if (sameCell)
+        {
+            massv.emplace_back(mc, M);
+            return;
+        }
+    }
+
+    // otherwise, integrate the kernel over the cells using equal-mass quadrature points
+    // distributed over concentric shells, each holding the same fraction of the kernel mass
+    int numShells = max(2, static_cast<int>(std::cbrt(numSamples)));
+    int numDirections = max(1, numSamples / numShells);
+    double dM = M / (numShells * numDirections);
+    const double goldenAngle = M_PI * (3. - sqrt(5.));
+    for (int i = 0; i != numShells; ++i)
+    {
+        double u = _kernel->radiusForMassFraction((i + 0.5) / numShells);
+
+        // spread the points over the shell following a Fibonacci lattice, rotated for each shell
+        for (int j = 0; j != numDirections; ++j)
+        {
+            double cosTheta = 1. - (2. * j + 1.) / numDirections;
+            double sinTheta = sqrt(max(0., 1. - cosTheta * cosTheta));
+            double phi = goldenAngle * (j + i * numDirections);
+            Vec k(sinTheta * cos(phi), sinTheta * sin(phi), cosTheta);
+            int mi = grid->cellIndex(Position(rc + k * (u * h)));
+            if (mi < 0) continue;
+
+            // accumulate the mass in the entry for this cell, adding an entry if needed
+            auto entry = std::find_if(massv.begin(), massv.end(), [mi](const std::pair<int, double>& e) {
+                return e.first == mi;
+            });
+            if (entry != massv.end())
+                entry->second += dM;
+            else
+                massv.emplace_back(mi, dM);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////
@@ -11,6 +11,7 @@
 #include "Snapshot.hpp"
 class SmoothedParticleGrid;
 class SmoothingKernel;
+class SpatialGrid;
 
 ////////////////////////////////////////////////////////////////////
 
@@ -132,15 +133,32 @@ public:
         behavior is undefined. */
     Position generatePosition() const override;
 
+    /** This function determines the portions of the mass of the particle with index \em m that
+        fall within each of the cells of the specified spatial grid, and stores the result in the
+        \em massv vector as a list of (cell index, mass) pairs, with a single entry per cell. Mass
+        falling outside of the spatial grid is omitted. If no density policy has been set or no
+        mass information is being imported, or if the index is out of range, the behavior is
+        undefined.
+
+        If the grid has cuboidal cells aligned with the coordinate axes, and the center of the
+        particle and the six points on the boundary of its smoothing kernel along the coordinate
+        axes all lie in the same cell, the kernel is fully contained in that cell and the complete
+        particle mass is assigned to it. For other cell shapes, this test does not guarantee
+        containment, so it is not performed. Otherwise, the function integrates the smoothing
+        kernel over the grid cells using a deterministic quadrature with approximately \em
+        numSamples points of equal mass. The points are arranged on concentric spherical shells
+        that each hold the same fraction of the kernel mass, and the points on each shell are
+        spread evenly over the sphere following a Fibonacci lattice. In contrast to sampling the
+        density in random positions within each cell, this procedure conserves the mass of the
+        particle and produces reproducible results. */
+    void cellMasses(int m, const SpatialGrid* grid, int numSamples, vector<std::pair<int, double>>& massv) const;
+
     //======================== Data Members ========================
 
 private:
     // data members initialized during configuration
     const SmoothingKernel* _kernel{nullptr};
 
-    // data members initialized when reading the input file
-    vector<Array> _propv;  // particle properties as imported
-
     // data members initialized when reading the input file, but only if a density policy has been set
     vector<SmoothedParticle> _pv;          // compact particle objects in the same order
     SmoothedParticleGrid* _grid{nullptr};  // smart grid for locating smoothed particles
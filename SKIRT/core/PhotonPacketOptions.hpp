@@ -35,6 +35,12 @@ class PhotonPacketOptions : public SimulationItem
         ATTRIBUTE_DEFAULT_VALUE(pathLengthBias, "0.5")
         ATTRIBUTE_DISPLAYED_IF(pathLengthBias, "Level3")
 
+        PROPERTY_DOUBLE(maxPeelOffOpticalDepth,
+                        "the optical depth beyond which a peel-off photon packet is considered to be extinguished")
+        ATTRIBUTE_MIN_VALUE(maxPeelOffOpticalDepth, "[10")
+        ATTRIBUTE_DEFAULT_VALUE(maxPeelOffOpticalDepth, "100")
+        ATTRIBUTE_DISPLAYED_IF(maxPeelOffOpticalDepth, "Level3")
+
     ITEM_END()
 };
 
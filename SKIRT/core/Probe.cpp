@@ -21,3 +21,11 @@ void Probe::probeSetup() {}
 void Probe::probeRun() {}
 
 ////////////////////////////////////////////////////////////////////
+
+void Probe::saveCheckpoint(CheckpointOutFile& /*out*/) const {}
+
+////////////////////////////////////////////////////////////////////
+
+void Probe::restoreCheckpoint(CheckpointInFile& /*in*/) {}
+
+////////////////////////////////////////////////////////////////////
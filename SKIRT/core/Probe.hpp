@@ -7,6 +7,8 @@
 #define PROBE_HPP
 
 #include "SimulationItem.hpp"
+class CheckpointInFile;
+class CheckpointOutFile;
 
 ////////////////////////////////////////////////////////////////////
 
@@ -51,6 +53,17 @@ public:
         the user configuration. The implementation in this base class does nothing. Each Probe
         subclass has the opportunity to override this function and output something useful. */
     virtual void probeRun();
+
+    /** This function writes any information accumulated by the probe while photon packets are
+        being launched to the specified checkpoint file, so that it can be restored when the
+        simulation is resumed from the checkpoint. The implementation in this base class does
+        nothing. Probe subclasses that accumulate such information should override this function
+        and the restoreCheckpoint() function. */
+    virtual void saveCheckpoint(CheckpointOutFile& out) const;
+
+    /** This function restores the information written by the saveCheckpoint() function from the
+        specified checkpoint file. The implementation in this base class does nothing. */
+    virtual void restoreCheckpoint(CheckpointInFile& in);
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -20,3 +20,17 @@ void ProbeSystem::probeRun()
 }
 
 ////////////////////////////////////////////////////////////////////
+
+void ProbeSystem::saveCheckpoint(CheckpointOutFile& out) const
+{
+    for (auto probe : probes()) probe->saveCheckpoint(out);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void ProbeSystem::restoreCheckpoint(CheckpointInFile& in)
+{
+    for (auto probe : probes()) probe->restoreCheckpoint(in);
+}
+
+////////////////////////////////////////////////////////////////////
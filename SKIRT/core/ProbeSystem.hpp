@@ -77,6 +77,15 @@ public:
         been emitted and detected. It invokes the function of the same name on all probes in the
         probe system. */
     void probeRun();
+
+    /** This function writes the information accumulated by the probes to the specified checkpoint
+        file. It invokes the function of the same name on all probes in the probe system. */
+    void saveCheckpoint(CheckpointOutFile& out) const;
+
+    /** This function restores the information accumulated by the probes from the specified
+        checkpoint file. It invokes the function of the same name on all probes in the probe
+        system. */
+    void restoreCheckpoint(CheckpointInFile& in);
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -0,0 +1,87 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#ifndef RADIATIONFIELDOPTIONS_HPP
+#define RADIATIONFIELDOPTIONS_HPP
+
+#include "SimulationItem.hpp"
+
+////////////////////////////////////////////////////////////////////
+
+/** The RadiationFieldOptions class simply offers a number of configuration options related to the
+    way in which the radiation field is accumulated during the photon packet life cycle. These
+    options are relevant only when the simulation records the radiation field.
+
+    By default, the contributions of all execution threads are added directly to the shared
+    radiation field tables using lock-free atomic operations. With many parallel threads, and in
+    particular for models in which most photon packets traverse a limited number of (dense) cells,
+    contention between threads on these shared memory locations can severely limit scaling. The
+    options offered here allow each thread to accumulate its contributions in a private buffer
+    instead. The thread-local buffers are reduced into the shared tables at the end of each
+    simulation segment.
+
+    A \em dense thread-local buffer has a bin for each spatial cell and for each wavelength in the
+    radiation field wavelength grid, i.e. it has the same size as the shared table. This offers
+    optimal performance but requires an additional amount of memory proportional to the number of
+    threads. A \em sparse thread-local buffer stores a bin only for the cell/wavelength
+    combinations that have actually been visited by the thread. When the number of bins in a sparse
+    buffer exceeds a given maximum, the buffer is flushed to the shared table, so that the memory
+    requirements for sparse buffers are bounded. In \em automatic mode, dense buffers are used if
+    the memory required for these buffers for all threads does not exceed a given fraction of the
+    available physical memory; otherwise sparse buffers are used.
+
+    For models with a very large number of spatial cells and/or wavelength bins, the shared
+    radiation field tables themselves may not fit in the available memory. The \em singlePrecision
+    option causes these tables to be stored in single precision, cutting their memory
+    requirements in half. Adding many small contributions directly to a single-precision value
+    would seriously degrade the accuracy of the result, so in this case the contributions are
+    always accumulated in double precision in thread-local buffers (sparse buffers if the \em Shared
+    accumulation mode is requested), and added to the shared tables only when a buffer is flushed.
+    As a result, each value in the shared tables receives a limited number of additions, and the
+    relative precision of the radiation field is close to that of a single-precision number. */
+class RadiationFieldOptions : public SimulationItem
+{
+    /** The enumeration type indicating the mechanism used to accumulate the radiation field
+        contributions from parallel execution threads. */
+    ENUM_DEF(AccumulationMode, Shared, ThreadLocalDense, ThreadLocalSparse, Automatic)
+        ENUM_VAL(AccumulationMode, Shared, "add directly to the shared table using atomic operations")
+        ENUM_VAL(AccumulationMode, ThreadLocalDense, "accumulate in a dense buffer per thread")
+        ENUM_VAL(AccumulationMode, ThreadLocalSparse, "accumulate in a sparse buffer per thread")
+        ENUM_VAL(AccumulationMode, Automatic, "select the thread buffer type based on the memory budget")
+    ENUM_END()
+
+    ITEM_CONCRETE(RadiationFieldOptions, SimulationItem,
+                  "a set of options related to accumulating the radiation field")
+
+        PROPERTY_ENUM(accumulationMode, AccumulationMode,
+                      "the mechanism used to accumulate the radiation field from parallel threads")
+        ATTRIBUTE_DEFAULT_VALUE(accumulationMode, "Shared")
+        ATTRIBUTE_DISPLAYED_IF(accumulationMode, "Level3")
+
+        PROPERTY_DOUBLE(maxBufferMemoryFraction,
+                        "the maximum fraction of the available memory used for dense thread-local buffers")
+        ATTRIBUTE_MIN_VALUE(maxBufferMemoryFraction, "]0")
+        ATTRIBUTE_MAX_VALUE(maxBufferMemoryFraction, "1]")
+        ATTRIBUTE_DEFAULT_VALUE(maxBufferMemoryFraction, "0.25")
+        ATTRIBUTE_RELEVANT_IF(maxBufferMemoryFraction, "accumulationModeAutomatic")
+        ATTRIBUTE_DISPLAYED_IF(maxBufferMemoryFraction, "Level3")
+
+        PROPERTY_INT(maxSparseBufferBins, "the maximum number of bins in a sparse thread-local buffer before flushing")
+        ATTRIBUTE_MIN_VALUE(maxSparseBufferBins, "1000")
+        ATTRIBUTE_MAX_VALUE(maxSparseBufferBins, "100000000")
+        ATTRIBUTE_DEFAULT_VALUE(maxSparseBufferBins, "1000000")
+        ATTRIBUTE_RELEVANT_IF(maxSparseBufferBins, "accumulationModeThreadLocalSparse|accumulationModeAutomatic")
+        ATTRIBUTE_DISPLAYED_IF(maxSparseBufferBins, "Level3")
+
+        PROPERTY_BOOL(singlePrecision, "store the radiation field in single precision to reduce memory usage")
+        ATTRIBUTE_DEFAULT_VALUE(singlePrecision, "false")
+        ATTRIBUTE_DISPLAYED_IF(singlePrecision, "Level3")
+
+    ITEM_END()
+};
+
+////////////////////////////////////////////////////////////////////
+
+#endif
@@ -4,10 +4,15 @@
 ///////////////////////////////////////////////////////////////// */
 
 #include "Random.hpp"
+#include "AliasTable.hpp"
 #include "Box.hpp"
+#include "CheckpointInFile.hpp"
+#include "CheckpointOutFile.hpp"
+#include "Log.hpp"
 #include "NR.hpp"
 #include "Position.hpp"
 #include "SpecialFunctions.hpp"
+#include <cstdint>
 #include <random>
 
 //////////////////////////////////////////////////////////////////////
@@ -34,11 +39,14 @@ namespace
             _generator.seed(seedseq);
         }
 
-        // turn into predictable generator, seeded with fixed sequence depending on given seed
-        void setState(int seed)
+        // turn into predictable generator, seeded with fixed sequence depending on given seed and variant;
+        // a nonzero variant selects a sequence that differs from the one for the same seed and variant zero
+        void setState(int seed, int variant = 0)
         {
-            std::seed_seq seedseq{979364188u + seed, 871244425u + seed, 1693909487u + seed, 1290454318u + seed,
-                                  210509498u + seed, 542237529u + seed, 3429911442u + seed, 3321294726u + seed};
+            vector<uint32_t> seeds{979364188u + seed, 871244425u + seed, 1693909487u + seed, 1290454318u + seed,
+                                   210509498u + seed, 542237529u + seed, 3429911442u + seed, 3321294726u + seed};
+            if (variant) seeds.push_back(static_cast<uint32_t>(variant));
+            std::seed_seq seedseq(seeds.begin(), seeds.end());
             _generator.seed(seedseq);
         }
 
@@ -46,11 +54,96 @@ namespace
         double get() { return _distribution(_generator); }
     };
 
+    // This helper class represents a Philox4x32-10 counter-based pseudo-random generator (Salmon et al. 2011).
+    // The generator is keyed on the seed and series number, and the counter is composed of the stream index
+    // and the block number within the stream. Random values are generated in blocks of numValues at once,
+    // processing the counters for numLanes consecutive blocks side by side so that the compiler can vectorize.
+    class Philox
+    {
+    private:
+        static constexpr int numLanes = 4;               // number of Philox blocks generated simultaneously
+        static constexpr int numValues = 2 * numLanes;  // each Philox block yields two double values
+        static constexpr double scale = 1. / 9007199254740992.;  // 2^-53
+        uint32_t _key0{0}, _key1{0};                    // the key
+        uint64_t _index{0};                             // the stream index
+        uint64_t _block{0};                             // the Philox block number of the next refill
+        double _buffer[numValues];                      // the values in the current refill
+        int _next{numValues};                           // the index in the buffer of the next value to be drawn
+
+        // generate the next numValues random values into the buffer
+        void refill()
+        {
+            uint32_t x0[numLanes], x1[numLanes], x2[numLanes], x3[numLanes];
+            for (int l = 0; l != numLanes; ++l)
+            {
+                uint64_t block = _block + l;
+                x0[l] = static_cast<uint32_t>(block);
+                x1[l] = static_cast<uint32_t>(block >> 32);
+                x2[l] = static_cast<uint32_t>(_index);
+                x3[l] = static_cast<uint32_t>(_index >> 32);
+            }
+            uint32_t k0 = _key0;
+            uint32_t k1 = _key1;
+            for (int round = 0; round != 10; ++round)
+            {
+                for (int l = 0; l != numLanes; ++l)
+                {
+                    uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * x0[l];
+                    uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * x2[l];
+                    uint32_t y0 = static_cast<uint32_t>(p1 >> 32) ^ x1[l] ^ k0;
+                    uint32_t y2 = static_cast<uint32_t>(p0 >> 32) ^ x3[l] ^ k1;
+                    x1[l] = static_cast<uint32_t>(p1);
+                    x3[l] = static_cast<uint32_t>(p0);
+                    x0[l] = y0;
+                    x2[l] = y2;
+                }
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            // convert each pair of 32-bit words to a double in the open interval (0,1) using 53 random bits
+            for (int l = 0; l != numLanes; ++l)
+            {
+                uint64_t u0 = ((static_cast<uint64_t>(x0[l]) << 32) | x1[l]) >> 11;
+                uint64_t u1 = ((static_cast<uint64_t>(x2[l]) << 32) | x3[l]) >> 11;
+                _buffer[2 * l] = (u0 + 0.5) * scale;
+                _buffer[2 * l + 1] = (u1 + 0.5) * scale;
+            }
+            _block += numLanes;
+            _next = 0;
+        }
+
+    public:
+        // position the generator at the given number of values from the start of the stream with the given index
+        void setState(int seed, int series, uint64_t index, uint64_t numDrawn)
+        {
+            _key0 = 979364188u + static_cast<uint32_t>(seed);
+            _key1 = static_cast<uint32_t>(series);
+            _index = index;
+            _block = (numDrawn / numValues) * numLanes;
+            refill();
+            _next = numDrawn % numValues;
+        }
+
+        // return the number of values drawn from the current stream
+        uint64_t numDrawn() const { return (_block / numLanes - 1) * numValues + _next; }
+
+        // get uniform deviate
+        double get()
+        {
+            if (_next == numValues) refill();
+            return _buffer[_next++];
+        }
+    };
+
     // allocate two random generators for each thread, and a pointer to the current generator
     // (these objects are constructed and initialized when the thread is created)
     thread_local Rand _predictable;
     thread_local Rand _arbitrary;
     thread_local Rand* _rand = &_arbitrary;
+
+    // allocate a counter-based generator for each thread, and a flag indicating whether it is being used
+    thread_local Philox _philox;
+    thread_local bool _inStream = false;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -82,9 +175,72 @@ void Random::switchToPredictable()
 
 //////////////////////////////////////////////////////////////////////
 
+void Random::startSeries()
+{
+    _series++;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void Random::startStream(size_t index)
+{
+    resumeStream(index, 0);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void Random::resumeStream(size_t index, size_t numDrawn)
+{
+    if (streams() == Streams::Counter)
+    {
+        _philox.setState(seed(), _series, index, numDrawn);
+        _inStream = true;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+
+size_t Random::numDrawnInStream() const
+{
+    return _inStream ? _philox.numDrawn() : 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void Random::endStream()
+{
+    _inStream = false;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void Random::saveCheckpoint(CheckpointOutFile& out) const
+{
+    out.write("random series", _series);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void Random::restoreCheckpoint(CheckpointInFile& in)
+{
+    _series = static_cast<int>(in.read("random series"));
+
+    // the state of the thread-local generators is not saved, so reseed the predictable generator
+    // to avoid replaying the random sequence that was already consumed before the checkpoint
+    if (streams() == Streams::Thread)
+    {
+        _predictable.setState(seed(), _series);
+        auto log = find<Log>();
+        log->warning("Resuming with thread-based random streams; results will differ from an uninterrupted run");
+        log->warning("  Set the random streams property to Counter for reproducible resumed simulations");
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+
 double Random::uniform()
 {
-    return _rand->get();
+    return _inStream ? _philox.get() : _rand->get();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -203,3 +359,13 @@ double Random::cdfLogLog(const Array& xv, const Array& pv, const Array& Pv)
 }
 
 //////////////////////////////////////////////////////////////////////
+
+double Random::cdfLogLog(const Array& xv, const Array& pv, const Array& Pv, const AliasTable& alias)
+{
+    double t;
+    int i = alias.sample(uniform(), t);
+    double alpha = log(pv[i + 1] / pv[i]) / log(xv[i + 1] / xv[i]);
+    return xv[i] * SpecialFunctions::gexp(-alpha, t * (Pv[i + 1] - Pv[i]) / (pv[i] * xv[i]));
+}
+
+//////////////////////////////////////////////////////////////////////
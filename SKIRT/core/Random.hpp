@@ -8,7 +8,10 @@
 
 #include "Array.hpp"
 #include "SimulationItem.hpp"
+class AliasTable;
 class Box;
+class CheckpointInFile;
+class CheckpointOutFile;
 class Direction;
 class Position;
 
@@ -59,10 +62,43 @@ class Position;
     run-time hierarchy will then call the switchToArbitrary() and switchToPredictable() functions
     at the appropriate times.
 
-    All rng's used in this class are based on the 64-bit Mersenne twister, which offers a
-    sufficiently long period and acceptable spectral properties for most purposes. */
+    The generators described above are based on the 64-bit Mersenne twister, which offers a
+    sufficiently long period and acceptable spectral properties for most purposes.
+
+    <b>Counter-based streams</b>
+
+    Even with a fixed seed, the results of a simulation using multiple threads or processes
+    depend on the order in which tasks are handed to the execution threads, because each thread
+    consumes its own random sequence. To allow reproducible multi-threaded and multi-process runs,
+    the user can set the \em streams property to \c Counter. In that case, tasks that are
+    identified by an index that does not depend on the parallelization, such as the history
+    index of a photon packet, can draw their random numbers from a dedicated stream. The caller
+    announces the start of a new series of tasks (e.g., a simulation segment) by calling the
+    startSeries() function from the parent thread, and brackets the work for each task with calls
+    to the startStream() and endStream() functions. In between, all random numbers for the
+    calling thread are drawn from a Philox4x32-10 counter-based generator (Salmon et al. 2011, SC
+    '11), keyed on the seed and the series number and with a counter composed of the task index
+    and the sequence number of the random block within the task. The generated sequence thus
+    depends only on the seed, the series, the task index and the number of values drawn so far,
+    and not on the thread executing the task. The resumeStream() and numDrawnInStream() functions
+    allow interleaving the work for multiple tasks in the same thread. Random numbers are
+    generated in blocks of several values at once by a loop that lends itself to vectorization.
+
+    When the \em streams property has its default value \c Thread, or outside of a
+    startStream() / endStream() bracket, the stream functions have no effect and random numbers
+    are drawn from the thread-local generators described above. Note that results obtained with
+    counter-based streams remain subject to round-off differences caused by the order in which
+    contributions from parallel threads are accumulated. */
 class Random : public SimulationItem
 {
+    /** The enumeration type indicating the source of the random numbers used for tasks that are
+        identified by an index independent of the parallelization, such as photon packet
+        histories. */
+    ENUM_DEF(Streams, Thread, Counter)
+        ENUM_VAL(Streams, Thread, "a Mersenne twister generator for each execution thread")
+        ENUM_VAL(Streams, Counter, "a counter-based generator keyed on the task index (reproducible)")
+    ENUM_END()
+
     ITEM_CONCRETE(Random, SimulationItem, "the default random generator")
 
         PROPERTY_INT(seed, "the seed for the random generator")
@@ -71,6 +107,10 @@ class Random : public SimulationItem
         ATTRIBUTE_DEFAULT_VALUE(seed, "0")
         ATTRIBUTE_DISPLAYED_IF(seed, "Level3")
 
+        PROPERTY_ENUM(streams, Streams, "the random number source for photon packet histories and similar tasks")
+        ATTRIBUTE_DEFAULT_VALUE(streams, "Thread")
+        ATTRIBUTE_DISPLAYED_IF(streams, "Level3")
+
     ITEM_END()
 
     //============= Construction - Setup - Destruction =============
@@ -92,6 +132,47 @@ public:
         only from the parent thread, i.e. the thread that called setup() on this instance. */
     void switchToPredictable();
 
+    //======================== Counter-based streams =======================
+
+public:
+    /** This function starts a new series of tasks that will draw their random numbers from
+        counter-based streams, as described in the class header. It should be called only from the
+        parent thread, before the tasks in the series are performed. */
+    void startSeries();
+
+    /** If counter-based streams are enabled, this function causes the calling thread to draw
+        random numbers from the stream for the task with the specified index in the current series,
+        starting at the beginning of the stream. Otherwise the function does nothing. */
+    void startStream(size_t index);
+
+    /** If counter-based streams are enabled, this function causes the calling thread to draw
+        random numbers from the stream for the task with the specified index in the current series,
+        skipping the specified number of values that have already been drawn from that stream.
+        Otherwise the function does nothing. */
+    void resumeStream(size_t index, size_t numDrawn);
+
+    /** This function returns the number of random values drawn by the calling thread from the
+        current counter-based stream since it was started, or zero if the calling thread is not
+        drawing from a counter-based stream. */
+    size_t numDrawnInStream() const;
+
+    /** This function causes the calling thread to resume drawing random numbers from its regular
+        thread-local generator. */
+    void endStream();
+
+    /** This function writes the current series number to the specified checkpoint file, so that
+        the counter-based streams for the remaining series can be reproduced when the simulation is
+        resumed from the checkpoint. */
+    void saveCheckpoint(CheckpointOutFile& out) const;
+
+    /** This function restores the current series number from the specified checkpoint file. The
+        state of the thread-local generators is not saved in the checkpoint. Therefore, if the \em
+        streams property has the value \c Thread, the function reseeds the predictable generator
+        of the calling thread with a sequence depending on the series number, so that the resumed
+        simulation does not replay the random numbers used before the checkpoint, and it logs a
+        warning that the results will differ from those of an uninterrupted run. */
+    void restoreCheckpoint(CheckpointInFile& in);
+
     //======================== Other Functions =======================
 
 public:
@@ -171,6 +252,20 @@ public:
         generalized exponential, defined in the description of respectively the
         SpecialFunctions::gln() and SpecialFunctions::gexp() functions. */
     double cdfLogLog(const Array& xv, const Array& pv, const Array& Pv);
+
+    /** This function generates a random number drawn from an arbitrary probability distribution
+        in the same way as the cdfLogLog() function without the \em alias argument, except that the
+        bin containing the random number is selected in constant time using the specified alias
+        table rather than through a binary search in the cdf. The alias table must have been
+        initialized from the same cdf \f$P_i\f$. The uniform deviate returned by the alias table
+        for the selected bin determines the value \f$\mathcal{X}\f$ within the bin's cdf range,
+        after which the power-law inversion proceeds as described for the other function. */
+    double cdfLogLog(const Array& xv, const Array& pv, const Array& Pv, const AliasTable& alias);
+
+    //======================== Data Members ========================
+
+private:
+    int _series{0};  // the current series number for counter-based streams
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -14,6 +14,7 @@ void ResourceSED::setupSelfBefore()
 
     _table.open(this, resourceName(), "lambda(m)", "Llambda(W/m)", false);
     _Ltot = _table.cdf(_lambdav, _pv, _Pv, normalizationWavelengthRange());
+    _alias.initialize(_Pv);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -51,7 +52,7 @@ double ResourceSED::integratedLuminosity(const Range& wavelengthRange) const
 
 double ResourceSED::generateWavelength() const
 {
-    return random()->cdfLogLog(_lambdav, _pv, _Pv);
+    return random()->cdfLogLog(_lambdav, _pv, _Pv, _alias);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -6,6 +6,7 @@
 #ifndef RESOURCESED_HPP
 #define RESOURCESED_HPP
 
+#include "AliasTable.hpp"
 #include "Array.hpp"
 #include "SED.hpp"
 #include "StoredTable.hpp"
@@ -62,6 +63,7 @@ private:
     Array _lambdav;
     Array _pv;
     Array _Pv;
+    AliasTable _alias;
     double _Ltot{0};
 };
 
@@ -32,6 +32,15 @@ public:
         range, all luminosities are zero. */
     virtual Range intrinsicWavelengthRange() const = 0;
 
+    /** This function returns the power \f$p\f$ such that the luminosity of an %SED in the family
+        is proportional to \f$x_0^p\f$, where \f$x_0\f$ is the value of the first parameter listed
+        by the parameterInfo() function, when all other parameters are held fixed. This information
+        allows scaling a representative %SED to other values of the first parameter, for example
+        when using a library of SEDs binned in parameter space (see the ImportedSource class). The
+        default implementation returns one, which is appropriate for families where the first
+        parameter is a mass, a rate or a luminosity normalization. */
+    virtual double luminosityScalingPower() const { return 1.; }
+
     /** This function returns the specific luminosity \f$L_\lambda\f$ (i.e. radiative power per
         unit of wavelength) for the %SED with the specified parameters at the specified wavelength,
         or zero if the wavelength is outside of the %SED's intrinsic wavelength range. The number
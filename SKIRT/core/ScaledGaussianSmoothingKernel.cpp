@@ -48,7 +48,13 @@ double ScaledGaussianSmoothingKernel::density(double u) const
 
 double ScaledGaussianSmoothingKernel::generateRadius() const
 {
-    double X = random()->uniform();
+    return radiusForMassFraction(random()->uniform());
+}
+
+//////////////////////////////////////////////////////////////////////
+
+double ScaledGaussianSmoothingKernel::radiusForMassFraction(double X) const
+{
     int k = NR::locateClip(_Xv, X);
     double p = (X - _Xv[k]) / (_Xv[k + 1] - _Xv[k]);
     double u = (k + p) / Nu;
@@ -53,15 +53,20 @@ void SecondarySourceSystem::installLaunchCallBack(ProbePhotonPacketInterface* ca
 
 bool SecondarySourceSystem::prepareForLaunch(size_t numPackets)
 {
+    _numPreparations++;
     int numCells = _ms->numCells();
 
     // --------- luminosities 1 ---------
 
     // calculate the absorbed (and thus to be emitted) dust luminosity for each spatial cell
-    // this can be somewhat time-consuming, so we do this in parallel
+    // this can be somewhat time-consuming, so we do this in parallel;
+    // in data-parallel mode, each process handles the cells for which it holds the radiation field
     _Lv.resize(numCells);
-    find<ParallelFactory>()->parallelDistributed()->call(numCells, [this](size_t firstIndex, size_t numIndices) {
-        for (size_t m = firstIndex; m != firstIndex + numIndices; ++m)
+    auto parfac = find<ParallelFactory>();
+    auto parallel = _ms->isDataParallel() ? parfac->parallelLocal() : parfac->parallelDistributed();
+    size_t firstCell = _ms->firstLocalCell();
+    parallel->call(_ms->numLocalCells(), [this, firstCell](size_t firstIndex, size_t numIndices) {
+        for (size_t m = firstCell + firstIndex; m != firstCell + firstIndex + numIndices; ++m)
         {
             _Lv[m] = _ms->absorbedLuminosity(m, MaterialMix::MaterialType::Dust);
         }
@@ -74,10 +79,27 @@ bool SecondarySourceSystem::prepareForLaunch(size_t numPackets)
     // pass the cell luminosities to the library so it can avoid mapping zero-luminosity cells
     _nv = _config->cellLibrary()->mapping(_Lv);
 
-    // construct a list of spatial cell indices sorted so that cells belonging to the same entry are consecutive
+    // construct a list of spatial cell indices sorted so that cells belonging to the same entry are consecutive;
+    // in data-parallel mode, first sort on owning process so that the cells owned by each process are consecutive
     _mv.resize(numCells);
     for (int m = 0; m != numCells; ++m) _mv[m] = m;
-    std::sort(begin(_mv), end(_mv), [this](int m1, int m2) { return _nv[m1] < _nv[m2]; });
+    if (_ms->isDataParallel())
+    {
+        std::sort(begin(_mv), end(_mv), [this](int m1, int m2) {
+            int r1 = _ms->cellProcess(m1);
+            int r2 = _ms->cellProcess(m2);
+            return r1 < r2 || (r1 == r2 && _nv[m1] < _nv[m2]);
+        });
+        // processes own contiguous cell ranges in rank order, so the launch-order range equals the cell range
+        _firstLocalLaunch = _ms->firstLocalCell();
+        _endLocalLaunch = _firstLocalLaunch + _ms->numLocalCells();
+    }
+    else
+    {
+        std::sort(begin(_mv), end(_mv), [this](int m1, int m2) { return _nv[m1] < _nv[m2]; });
+        _firstLocalLaunch = 0;
+        _endLocalLaunch = numCells;
+    }
 
     // --------- luminosities 2 ---------
 
@@ -160,12 +182,95 @@ bool SecondarySourceSystem::prepareForLaunch(size_t numPackets)
                   + StringUtils::toString(static_cast<double>(totMappedCells) / usedEntries, 'f', 1));
     }
 
+    // --------- emission spectra ---------
+
+    if (_config->precalculateEmissionSpectra()) precalculateSpectra();
+
     // report success
     return true;
 }
 
 ////////////////////////////////////////////////////////////////////
 
+void SecondarySourceSystem::precalculateSpectra()
+{
+    int numEntries = _config->cellLibrary()->numEntries();
+    int numWavelengths = _config->dustEmissionWLG()->extlambdav().size();
+    vector<int> hv;  // the media indices for the media containing dust
+    for (int h = 0; h != _ms->numMedia(); ++h)
+        if (_ms->isDust(h)) hv.push_back(h);
+    int numMedia = hv.size();
+
+    // determine the first launch-order index and the number of mapped cells for each library entry,
+    // limited to the cells from which this process launches photon packets
+    vector<int> firstv(numEntries, -1);
+    vector<int> countv(numEntries, 0);
+    for (int p = _firstLocalLaunch; p != _endLocalLaunch; ++p)
+    {
+        int n = _nv[_mv[p]];
+        if (n >= 0)
+        {
+            if (firstv[n] < 0) firstv[n] = p;
+            countv[n]++;
+        }
+    }
+
+    // determine the layout of the table: a single spectrum for each used library entry, except for entries
+    // mapping multiple cells with multiple dust media, which need a separate spectrum for each medium
+    _spectrumIndexv.resize(numEntries + 1);
+    _spectrumIndexv[0] = 0;
+    for (int n = 0; n != numEntries; ++n)
+    {
+        size_t numSpectra = countv[n] == 0 ? 0 : (countv[n] == 1 ? 1 : numMedia);
+        _spectrumIndexv[n + 1] = _spectrumIndexv[n] + numSpectra * numWavelengths;
+    }
+    _spectrav.resize(_spectrumIndexv[numEntries]);  // also clears any previous contents
+
+    auto log = find<Log>();
+    log->info("Calculating emission spectra for library entries...");
+    log->info("  Allocated " + StringUtils::toMemSizeString(_spectrav.size() * sizeof(double)) + " of memory");
+
+    // calculate the spectra, distributing the library entries over threads and processes;
+    // in data-parallel mode, each process calculates the spectra for the cells it owns
+    log->infoSetElapsed(numEntries);
+    auto parfac = find<ParallelFactory>();
+    auto parallel = _ms->isDataParallel() ? parfac->parallelLocal() : parfac->parallelDistributed();
+    parallel->call(
+        numEntries, [this, log, &hv, &firstv, &countv, numWavelengths](size_t firstIndex, size_t numIndices) {
+            for (size_t n = firstIndex; n != firstIndex + numIndices; ++n)
+            {
+                int numMappedCells = countv[n];
+                if (numMappedCells)
+                {
+                    // use the average radiation field for all cells mapped to the library entry
+                    int p = firstv[n];
+                    int m = _mv[p];
+                    Array Jv = _ms->meanIntensity(m);
+                    for (int i = 1; i != numMappedCells; ++i) Jv += _ms->meanIntensity(_mv[p + i]);
+                    if (numMappedCells > 1) Jv /= numMappedCells;
+
+                    // store either a single spectrum or a separate spectrum for each dust medium; a single
+                    // spectrum for multiple media is weighted by the densities in the only mapped cell, while
+                    // a spectrum for a single medium is not weighted at all because it is normalized anyway
+                    // (the first cell mapped to the entry may not even contain any dust)
+                    double* spectrum = &_spectrav[_spectrumIndexv[n]];
+                    bool single = numMappedCells == 1 || hv.size() == 1;
+                    for (int h : hv)
+                    {
+                        Array ev = _ms->mix(m, h)->emissivity(Jv);
+                        double w = single && hv.size() > 1 ? _ms->numberDensity(m, h) : 1.;
+                        for (int ell = 0; ell != numWavelengths; ++ell) spectrum[ell] += w * ev[ell];
+                        if (!single) spectrum += numWavelengths;
+                    }
+                }
+            }
+            log->infoIfElapsed("Calculated emission spectra: ", numIndices);
+        });
+    if (!_ms->isDataParallel()) ProcessManager::sumToAll(_spectrav);
+}
+
+////////////////////////////////////////////////////////////////////
+
 namespace
 {
     // An instance of this class obtains and/or calculates the information needed to launch photon packets
@@ -183,9 +288,9 @@ namespace
         int _numWavelengths{0};      // the number of wavelengths in the dust emission wavelength grid
         vector<int> _hv;             // a list of the media indices for the media containing dust
         int _numMedia{0};            // the number of dust media in the system (and thus the size of hv)
-        int _numCells{0};            // the number of cells in the spatial grid (and thus the size of mv and nv)
 
         // information on a particular spatial cell, initialized by calculateIfNeeded()
+        size_t _preparation{0};    // serial number of the launch preparation for which the information is valid
         int _p{-1};                // spatial cell launch-order index
         int _n{-1};                // library entry index
         vector<Array> _evv;        // emissivity spectrum for each medium component, if applicable
@@ -196,19 +301,31 @@ namespace
         DustCellEmission() {}
 
         // calculates the emission information for the given cell if it is different from what's already stored
+        //   preparation: serial number of the launch preparation; the stored information is discarded if it differs
         //   p:  launch-order cell index (cells mapped to a given library entry have consecutive p indices)
+        //   endp: launch-order cell index beyond the last cell from which this process launches photon packets
         //   mv: map from launch-order cell index p to regular cell index m
         //   nv: map from regular cell index m to library entry index n
+        //   iv: map from library entry index n to index of first precalculated spectrum in sv
+        //   sv: precalculated spectra, or empty if the spectra must be calculated on the fly
         //   ms: medium system
         //   config: configuration object
-        void calculateIfNeeded(int p, const vector<int>& mv, const vector<int>& nv, MediumSystem* ms,
-                               Configuration* config)
+        void calculateIfNeeded(size_t preparation, int p, int endp, const vector<int>& mv, const vector<int>& nv,
+                               const vector<size_t>& iv, const Array& sv, MediumSystem* ms, Configuration* config)
         {
+            // the radiation field and thus the emission spectra may have changed since the previous preparation
+            if (preparation != _preparation)
+            {
+                _preparation = preparation;
+                _p = -1;
+                _n = -1;
+            }
+
             // if this photon packet is launched from the same cell as the previous one, we don't need to do anything
             if (p == _p) return;
 
             // when called for the first time, construct a list of dust media and cache some other info
-            if (_p == -1)
+            if (!_ms)
             {
                 _ms = ms;
                 auto wavelengthGrid = config->dustEmissionWLG();
@@ -218,7 +335,6 @@ namespace
                 for (int h = 0; h != ms->numMedia(); ++h)
                     if (ms->isDust(h)) _hv.push_back(h);
                 _numMedia = _hv.size();
-                _numCells = ms->numCells();
                 _evv.resize(ms->numMedia());
             }
 
@@ -235,12 +351,18 @@ namespace
 
                 // determine the number of cells mapped to this library entry (they are consecutive in p)
                 int pp = p + 1;
-                for (; pp != _numCells; ++pp)
+                for (; pp != endp; ++pp)
                     if (nv[mv[pp]] != n) break;
                 int numMappedCells = pp - p;
 
+                // if the spectra have been precalculated, simply retrieve the information for this library entry
+                if (sv.size())
+                {
+                    retrieveSpectrum(iv[n], iv[n + 1], sv, m);
+                }
+
                 // if only a single cell maps to the library entry, we can simply calculate its emission
-                if (numMappedCells == 1)
+                else if (numMappedCells == 1)
                 {
                     calculateSingleSpectrum(_ms->meanIntensity(m), m);
                 }
@@ -289,6 +411,27 @@ namespace
         }
 
     private:
+        // retrieve the precalculated spectrum or spectra stored in the specified index range of the specified table;
+        // if there is a spectrum for each dust medium, calculate the spectrum weighted by density for the specified
+        // cell, and store the result in the data members _lambdav, _pv, _Pv
+        void retrieveSpectrum(size_t first, size_t last, const Array& sv, int m)
+        {
+            if (last - first == static_cast<size_t>(_numWavelengths))
+            {
+                Array ev(&sv[first], _numWavelengths);
+                NR::cdf<NR::interpolateLogLog>(_lambdav, _pv, _Pv, _wavelengthGrid, ev, _wavelengthRange);
+            }
+            else
+            {
+                for (int h : _hv)
+                {
+                    _evv[h] = Array(&sv[first], _numWavelengths);
+                    first += _numWavelengths;
+                }
+                calculateWeightedSpectrum(m);
+            }
+        }
+
         // calculate the emission spectrum for the specified radiation field and the dust mixes of the specified cell,
         // and store the result in the data members _lambdav, _pv, _Pv
         void calculateSingleSpectrum(const Array& Jv, int m)
@@ -496,7 +639,8 @@ void SecondarySourceSystem::launch(PhotonPacket* pp, size_t historyIndex) const
     auto m = _mv[p];
 
     // calculate the emission spectrum and bulk velocity for this cell, if not already available
-    t_dustcell.calculateIfNeeded(p, _mv, _nv, _ms, _config);
+    t_dustcell.calculateIfNeeded(_numPreparations, p, _endLocalLaunch, _mv, _nv, _spectrumIndexv, _spectrav, _ms,
+                                 _config);
     t_dustcellpol.calculateIfNeeded(m, _ms, _config);
 
     // generate a random wavelength from the emission spectrum for the cell and/or from the bias distribution
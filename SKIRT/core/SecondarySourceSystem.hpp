@@ -121,7 +121,23 @@ class Random;
     result must be calculated and stored for each cell separately. If the medium system has only a
     single dust component, the above formula reduces to \f$j_{m,\ell} =\rho_m\,
     \varepsilon_{n,\ell}\f$, so that the normalized emission spectrum is identical for all spatial
-    cells that map to a certain library entry. */
+    cells that map to a certain library entry.
+
+    Data parallelization
+    --------------------
+
+    In data-parallel mode (see MediumSystem::isDataParallel()), each process stores the radiation
+    field only for the spatial cells it owns, so that emission spectra can be calculated only for
+    those cells. The prepareForLaunch() function therefore sorts the cells first on the rank of the
+    owning process and only then on library entry, so that the history indices allocated to the
+    cells owned by a given process form a single consecutive range. The MonteCarloSimulation
+    object then asks each process to launch exactly the photon packets in its own range, as
+    indicated by the firstLocalHistoryIndex() and numLocalHistories() functions, using all threads
+    in the process. Because the processes launch different photon packets, they draw their random
+    numbers from the arbitrary generators (unless the random streams are counter-based), avoiding
+    correlated noise between processes that would otherwise share the predictable sequence. The average
+    radiation field for a library entry is determined over the mapped cells owned by the launching
+    process. */
 class SecondarySourceSystem : public SimulationItem
 {
     //============= Construction - Setup - Destruction =============
@@ -154,6 +170,15 @@ public:
         launched), and true otherwise. */
     bool prepareForLaunch(size_t numPackets);
 
+    /** This function returns the first history index of the range of photon packets to be launched
+        by the calling process. Without data parallelization, the function returns zero. */
+    size_t firstLocalHistoryIndex() const { return _Iv[_firstLocalLaunch]; }
+
+    /** This function returns the number of photon packets to be launched by the calling process,
+        with consecutive history indices starting at firstLocalHistoryIndex(). Without data
+        parallelization, the function returns the total number of photon packets. */
+    size_t numLocalHistories() const { return _Iv[_endLocalLaunch] - _Iv[_firstLocalLaunch]; }
+
     /** This function causes the photon packet \em pp to be launched from one of the cells in the
         spatial grid using the given history index; see the description in the class header for
         more information. The photon packet's contents is fully (re-)initialized so that it is
@@ -175,6 +200,17 @@ public:
         limited to storing the information for only a single cell per execution thread, and the
         calculation is still performed only once per cell.
 
+        However, if several threads (or processes) handle photon packets launched from cells mapped
+        to the same library entry, the emission spectrum for that entry is calculated more than
+        once. If the configuration so requests, the prepareForLaunch() function therefore
+        calculates the emission spectra for all library entries in advance, distributing the work
+        over all execution threads and processes, and stores them in a table shared by all threads.
+        In that case, this function obtains the spectrum from the table, so that it merely needs to
+        construct the cumulative distribution before sampling wavelengths. The table holds a single
+        spectrum for each used library entry, except for entries mapping multiple cells in a
+        configuration with multiple dust media, for which it holds a separate spectrum for each
+        medium so that the relative density weights of each cell can be applied during launch.
+
         Once the emission spectrum for the current cell is known, the function randomly generates a
         wavelength either from this emission spectrum or from the configured bias wavelength
         distribution, adjusting the launch weight with the proper bias factor. It then generates a
@@ -186,6 +222,11 @@ public:
     //======================== Data Members ========================
 
 private:
+    /** This function calculates the emission spectra for all library entries used by the cell
+        library mapping and stores them in a table, as described for the launch() function. It is
+        called from prepareForLaunch() if the configuration so requests. */
+    void precalculateSpectra();
+
     // initialized by setupSelfBefore()
     Configuration* _config{nullptr};
     MediumSystem* _ms{nullptr};
@@ -195,6 +236,7 @@ private:
     ProbePhotonPacketInterface* _callback{nullptr};  // interface to be invoked for each packet launch if nonzero
 
     // initialized by prepareForLaunch()
+    size_t _numPreparations{0};  // the number of calls to prepareForLaunch(), used to invalidate thread-local caches
     double _L{0};        // the total bolometric luminosity of all spatial cells
     double _Lpp{0};      // the average luminosity contribution for each packet
     Array _Lv;           // the relative bolometric luminosity of each spatial cell (normalized to unity)
@@ -202,6 +244,12 @@ private:
     vector<int> _nv;     // the library entry index corresponding to each spatial cell (i.e. map from cells to entries)
     vector<int> _mv;     // the spatial cell indices sorted so that cells belonging to the same entry are consecutive
     vector<size_t> _Iv;  // first history index allocated to each spatial cell (with extra entry at the end)
+    int _firstLocalLaunch{0};  // index in _mv of the first cell owned by this process
+    int _endLocalLaunch{0};    // index in _mv beyond the last cell owned by this process
+
+    // initialized by precalculateSpectra(), if requested
+    vector<size_t> _spectrumIndexv;  // index in _spectrav of the first spectrum for each library entry (+ extra entry)
+    Array _spectrav;                 // emissivity spectra for all used library entries, or empty if not precalculated
 };
 
 ////////////////////////////////////////////////////////////////
@@ -58,3 +58,10 @@ ParallelFactory* Simulation::parallelFactory() const
 }
 
 ////////////////////////////////////////////////////////////////////
+
+OutputWriter* Simulation::outputWriter() const
+{
+    return _writer;
+}
+
+////////////////////////////////////////////////////////////////////
@@ -170,6 +170,7 @@
 #include "PseudoSersicGeometry.hpp"
 #include "QuasarSED.hpp"
 #include "RadialVectorField.hpp"
+#include "RadiationFieldOptions.hpp"
 #include "RadiationFieldPerCellProbe.hpp"
 #include "RadiationFieldWavelengthGridProbe.hpp"
 #include "Random.hpp"
@@ -449,6 +450,7 @@ SimulationItemRegistry::SimulationItemRegistry(string version, string format)
     ItemRegistry::add<ExtinctionOnlyOptions>();
     ItemRegistry::add<DustEmissionOptions>();
     ItemRegistry::add<DustSelfAbsorptionOptions>();
+    ItemRegistry::add<RadiationFieldOptions>();
 
     // material normalizations
     ItemRegistry::add<MaterialNormalization>();
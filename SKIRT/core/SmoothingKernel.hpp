@@ -40,6 +40,14 @@ public:
         function appropriately. */
     virtual double generateRadius() const = 0;
 
+    /** This pure virtual function returns the normalized radius \f$u\f$ of the sphere that
+        contains the specified fraction \f${\cal{X}}\f$ of the kernel mass, i.e. it solves the
+        equation \f[ {\cal{X}} = \int_0^u 4\pi\,W(u')\,u'^2\, {\text{d}}u' \f] for \f$u\f$. This
+        allows drawing radii from the kernel with a deterministic set of deviates, for example to
+        integrate the kernel mass over a spatial cell with a fixed quadrature. Subclasses must
+        implement this function appropriately. */
+    virtual double radiusForMassFraction(double X) const = 0;
+
 protected:
     /** This function returns the simulation's random generator as a service to subclasses. */
     Random* random() const { return _random; }
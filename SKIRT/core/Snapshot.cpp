@@ -6,6 +6,7 @@
 #include "Snapshot.hpp"
 #include "Log.hpp"
 #include "Random.hpp"
+#include "StringUtils.hpp"
 #include "TextInFile.hpp"
 #include "Units.hpp"
 
@@ -47,6 +48,36 @@ void Snapshot::setContext(const SimulationItem* item)
 
 ////////////////////////////////////////////////////////////////////
 
+void Snapshot::storeProperties(const Array& row)
+{
+    size_t numColumns = row.size();
+    if (_propv.size() < numColumns) _propv.resize(numColumns);
+    for (size_t i = 0; i != numColumns; ++i) _propv[i].push_back(row[i]);
+}
+
+////////////////////////////////////////////////////////////////////
+
+void Snapshot::finishStoringProperties()
+{
+    size_t allocatedBytes = 0;
+    for (auto& column : _propv)
+    {
+        column.shrink_to_fit();
+        allocatedBytes += column.capacity() * sizeof(double);
+    }
+    log()->info("  Allocated " + StringUtils::toMemSizeString(allocatedBytes) + " of memory for imported properties");
+}
+
+////////////////////////////////////////////////////////////////////
+
+void Snapshot::clearProperties()
+{
+    _propv.clear();
+    _propv.shrink_to_fit();
+}
+
+////////////////////////////////////////////////////////////////////
+
 void Snapshot::useColumns(string columns)
 {
     _infile->useColumns(columns);
@@ -99,6 +99,35 @@ protected:
         in subclasses. */
     Random* random() const { return _random; }
 
+    //========== Property storage ==========
+
+protected:
+    /** This function appends the specified row of imported property values, as read from the
+        input file, to the property storage offered by this base class, for use in subclasses. The
+        storage index of the new entity equals the number of entities stored before the call.
+
+        The property values are stored column by column, each column in a contiguous block of
+        memory. Compared to storing an array object per entity, this avoids the memory allocation
+        overhead per entity and keeps the values for a given property close together in memory. */
+    void storeProperties(const Array& row);
+
+    /** This function releases any excess capacity reserved while storing properties and logs the
+        amount of memory allocated for the stored properties. It is intended to be called by
+        subclasses after all rows have been stored. */
+    void finishStoringProperties();
+
+    /** This function discards all stored properties, for use in subclasses. */
+    void clearProperties();
+
+    /** This function returns the number of entities in the property storage, for use in
+        subclasses. */
+    size_t numStoredEntities() const { return _propv.empty() ? 0 : _propv[0].size(); }
+
+    /** This function returns the value of the imported property in column \em i for the entity
+        with storage index \em m, for use in subclasses. If either index is out of range, the
+        behavior is undefined. */
+    double property(size_t m, int i) const { return _propv[i][m]; }
+
     //========== Configuration ==========
 
 public:
@@ -370,6 +399,9 @@ private:
     Units* _units{nullptr};
     Random* _random{nullptr};
 
+    // imported properties, indexed on column index and then on storage index
+    vector<vector<double>> _propv;
+
     // column indices
     int _nextIndex{0};
     int _positionIndex{-1};
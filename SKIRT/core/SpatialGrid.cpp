@@ -5,6 +5,7 @@
 
 #include "SpatialGrid.hpp"
 #include "Random.hpp"
+#include "SpatialGridPath.hpp"
 #include "SpatialGridPlotFile.hpp"
 
 //////////////////////////////////////////////////////////////////////
@@ -25,6 +26,22 @@ double SpatialGrid::diagonal(int m) const
 
 //////////////////////////////////////////////////////////////////////
 
+bool SpatialGrid::hasCuboidalCells() const
+{
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void SpatialGrid::traversePath(SpatialGridPath* path, const SegmentVisitor& visit) const
+{
+    this->path(path);
+    for (const auto& segment : path->segments())
+        if (!visit(segment.m, segment.ds)) break;
+}
+
+//////////////////////////////////////////////////////////////////////
+
 void SpatialGrid::writeGridPlotFiles(const SimulationItem* probe) const
 {
     // For the xy plane (always)
@@ -9,6 +9,7 @@
 #include "Box.hpp"
 #include "Position.hpp"
 #include "SimulationItem.hpp"
+#include <functional>
 class Random;
 class SpatialGridPath;
 class SpatialGridPlotFile;
@@ -54,6 +55,11 @@ public:
         function to return the actual diagional for each cell. */
     virtual double diagonal(int m) const;
 
+    /** This function returns true if all cells in the grid are cuboids with faces perpendicular to
+        the coordinate axes, and false otherwise. The default implementation in this class returns
+        false. Grids that have such cuboidal cells should override this function to return true. */
+    virtual bool hasCuboidalCells() const;
+
     /** This function returns the index \f$m\f$ of the cell that contains the position
         \f${\bf{r}}\f$. */
     virtual int cellIndex(Position bfr) const = 0;
@@ -76,6 +82,26 @@ public:
     //================ Functions that may be implemented in subclasses ===============
 
 public:
+    /** The type of the function passed to the traversePath() function. The function receives the
+        cell index \f$m\f$ (or -1 for a segment outside of the grid) and the path length
+        \f$\Delta s\f$ covered in the cell for each segment along the path, and returns true if the
+        traversal should continue or false if it should be terminated. */
+    using SegmentVisitor = std::function<bool(int m, double ds)>;
+
+    /** This function calculates a path through the grid in the same way as the path() function,
+        but rather than storing the path segments into the SpatialGridPath object, it passes each
+        segment in turn to the specified visitor function. If the visitor function returns false,
+        the traversal is terminated immediately, so that the remainder of the path is not
+        calculated. The SpatialGridPath object passed as an argument specifies the starting
+        position and direction for the path; the segment information it holds after this function
+        returns is unspecified.
+
+        This function is intended for clients that need just a single value accumulated along the
+        path, such as the optical depth towards an observer. The default implementation in this
+        class calls the path() function and then passes the resulting segments to the visitor
+        function. Subclasses can override this function to avoid storing the path segments. */
+    virtual void traversePath(SpatialGridPath* path, const SegmentVisitor& visit) const;
+
     /** This function outputs text data files that allow plotting the structure of the spatial
         grid. The number of data files written depends on the dimension of the spatial grid: for
         spherical symmetry only the intersection with the xy plane is written, for axial symmetry
@@ -22,6 +22,7 @@ void TabulatedSED::setupSelfBefore()
 
     // construct the regular and cumulative distributions
     double norm = NR::cdf<NR::interpolateLogLog>(_lambdav, _pv, _Pv, _inlambdav, _inpv, normalizationWavelengthRange());
+    _alias.initialize(_Pv);
 
     // also normalize the intrinsic distribution
     _inpv /= norm;
@@ -61,7 +62,7 @@ double TabulatedSED::integratedLuminosity(const Range& wavelengthRange) const
 
 double TabulatedSED::generateWavelength() const
 {
-    return random()->cdfLogLog(_lambdav, _pv, _Pv);
+    return random()->cdfLogLog(_lambdav, _pv, _Pv, _alias);
 }
 
 //////////////////////////////////////////////////////////////////////
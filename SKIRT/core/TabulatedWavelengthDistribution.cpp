@@ -26,6 +26,7 @@ void TabulatedWavelengthDistribution::setupSelfBefore()
 
     // construct the regular and cumulative distributions in the intersected range
     NR::cdf<NR::interpolateLogLog>(_lambdav, _pv, _Pv, inlambdav, inpv, range);
+    _alias.initialize(_Pv);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -39,7 +40,7 @@ double TabulatedWavelengthDistribution::probability(double wavelength) const
 
 double TabulatedWavelengthDistribution::generateWavelength() const
 {
-    return random()->cdfLogLog(_lambdav, _pv, _Pv);
+    return random()->cdfLogLog(_lambdav, _pv, _Pv, _alias);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -6,6 +6,7 @@
 #ifndef TABULATEDWAVELENGTHDISTRIBUTION_HPP
 #define TABULATEDWAVELENGTHDISTRIBUTION_HPP
 
+#include "AliasTable.hpp"
 #include "Array.hpp"
 #include "WavelengthDistribution.hpp"
 
@@ -53,9 +54,10 @@ public:
 
 private:
     // data members initialized during setup
-    Array _lambdav;  // wavelengths
-    Array _pv;       // probability distribution, normalized to unity
-    Array _Pv;       // cumulative probability distribution
+    Array _lambdav;     // wavelengths
+    Array _pv;          // probability distribution, normalized to unity
+    Array _Pv;          // cumulative probability distribution
+    AliasTable _alias;  // alias table for sampling the cumulative distribution
 };
 
 ////////////////////////////////////////////////////////////////////
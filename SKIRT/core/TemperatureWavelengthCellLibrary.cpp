@@ -7,6 +7,7 @@
 #include "Configuration.hpp"
 #include "Log.hpp"
 #include "MediumSystem.hpp"
+#include "ProcessManager.hpp"
 #include "StringUtils.hpp"
 #include "Units.hpp"
 #include "WavelengthGrid.hpp"
@@ -53,18 +54,14 @@ vector<int> TemperatureWavelengthCellLibrary::mapping(const Array& bv) const
     auto ms = find<MediumSystem>();
     int numCells = ms->numCells();
 
-    // calculate the indicative temperature and wavelength for all spatial cells
-    // and track their minimum and maximum values
-    double Tmin = DBL_MAX;
-    double Tmax = 0.0;
-    double lambdamin = DBL_MAX;
-    double lambdamax = 0.0;
+    // calculate the indicative temperature and wavelength for all spatial cells;
+    // in data-parallel mode, each process handles the cells for which it holds the radiation field
     Array Tv(numCells);
     Array lambdav(numCells);
     for (int m = 0; m != numCells; ++m)
     {
         // ignore cells that won't be used by the caller
-        if (bv[m])
+        if (bv[m] && ms->isLocalCell(m))
         {
             double T = ms->indicativeDustTemperature(m);
             double lambda = indicativeDustWavelength(m, ms, wavelengthGrid);
@@ -74,14 +71,30 @@ vector<int> TemperatureWavelengthCellLibrary::mapping(const Array& bv) const
             {
                 Tv[m] = T;
                 lambdav[m] = lambda;
-
-                Tmin = min(Tmin, T);
-                Tmax = max(Tmax, T);
-                lambdamin = min(lambdamin, lambda);
-                lambdamax = max(lambdamax, lambda);
             }
         }
     }
+    if (ms->isDataParallel())
+    {
+        ProcessManager::sumToAll(Tv);
+        ProcessManager::sumToAll(lambdav);
+    }
+
+    // track the minimum and maximum values
+    double Tmin = DBL_MAX;
+    double Tmax = 0.0;
+    double lambdamin = DBL_MAX;
+    double lambdamax = 0.0;
+    for (int m = 0; m != numCells; ++m)
+    {
+        if (Tv[m] > 0. && lambdav[m] > 0.)
+        {
+            Tmin = min(Tmin, Tv[m]);
+            Tmax = max(Tmax, Tv[m]);
+            lambdamin = min(lambdamin, lambdav[m]);
+            lambdamax = max(lambdamax, lambdav[m]);
+        }
+    }
 
     // log the property ranges
     auto log = find<Log>();
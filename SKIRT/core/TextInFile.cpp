@@ -7,9 +7,13 @@
 #include "FatalError.hpp"
 #include "FilePaths.hpp"
 #include "Log.hpp"
+#include "Parallel.hpp"
+#include "ParallelFactory.hpp"
 #include "StringUtils.hpp"
 #include "System.hpp"
 #include "Units.hpp"
+#include <cctype>
+#include <cstring>
 #include <exception>
 #include <regex>
 #include <sstream>
@@ -54,6 +58,73 @@ namespace
             }
         }
     }
+
+    // the alternate interpretations for 8-byte items in the binary column format
+    union BinaryItem
+    {
+        double doubleType;
+        size_t sizeType;
+        char stringType[8];
+    };
+    const size_t itemSize = sizeof(BinaryItem);
+
+    static_assert((sizeof(size_t) == 8) & (sizeof(double) == 8) & (itemSize == 8),
+                  "Cannot properly declare union for items in binary column format");
+
+    // the tag and the byte order verification value at the start of a binary column file
+    const char* binaryTag = "SKIRT C\n";
+    const size_t binaryEndianness = 0x010203040A0BFEFF;
+
+    // returns the string stored in the binary column format at the specified item, and advances the item pointer
+    string readBinaryString(const BinaryItem*& currentItem)
+    {
+        size_t length = currentItem++->sizeType;
+        string result(currentItem->stringType, length);
+        currentItem += (length + itemSize - 1) / itemSize;
+        return result;
+    }
+
+    // writes the specified value to the specified stream as an 8-byte item
+    void writeBinaryItem(std::ofstream& out, size_t value)
+    {
+        BinaryItem item;
+        item.sizeType = value;
+        out.write(item.stringType, itemSize);
+    }
+
+    // writes the specified string to the specified stream in the binary column format
+    void writeBinaryString(std::ofstream& out, string value)
+    {
+        writeBinaryItem(out, value.size());
+        value.resize((value.size() + itemSize - 1) / itemSize * itemSize, ' ');
+        out.write(value.c_str(), value.size());
+    }
+
+    // the minimum size of the remainder of a column text file for it to be parsed in parallel
+    const size_t minParallelTextSize = 1 << 20;
+
+    // the approximate number of bytes in a block and in a chunk of text parsed in parallel
+    const size_t textBlockSize = 64 << 20;
+    const size_t textChunkSize = 1 << 20;
+
+    // returns the offset of the first character after the line containing the character at the specified offset
+    size_t nextLineStart(const char* text, size_t pos, size_t end)
+    {
+        if (pos >= end) return end;
+        auto eol = static_cast<const char*>(memchr(text + pos, '\n', end - pos));
+        return eol ? eol - text + 1 : end;
+    }
+
+    // returns true if the specified text, converted by strtod, holds a plain decimal number; this rejects the
+    // hexadecimal, infinity and NaN formats accepted by strtod but not by the stream extraction operator
+    bool isDecimalNumber(const char* begin, const char* end)
+    {
+        for (const char* ptr = begin; ptr != end; ++ptr)
+        {
+            if (!isdigit(static_cast<unsigned char>(*ptr)) && !strchr("+-.eE", *ptr)) return false;
+        }
+        return true;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -64,11 +135,25 @@ TextInFile::TextInFile(const SimulationItem* item, string filename, string descr
     string filepath = item->find<FilePaths>()->input(filename);
     _in = System::ifstream(filepath);
     if (!_in) throw FATALERROR("Could not open the " + description + " text file " + filepath);
+    _filePath = filepath;
 
     // remember the units system and the logger
     _units = item->find<Units>();
     _log = item->find<Log>();
 
+    // if the file starts with the binary column tag, read it through a memory map instead
+    char tag[itemSize];
+    _in.read(tag, itemSize);
+    if (_in.gcount() == static_cast<std::streamsize>(itemSize) && !memcmp(tag, binaryTag, itemSize))
+    {
+        _in.close();
+        openBinary(filepath);
+        _log->info(item->typeAndName() + " reads " + description + " from binary column file " + filepath + "...");
+        return;
+    }
+    _in.clear();
+    _in.seekg(0);
+
     // log "reading file" message
     _log->info(item->typeAndName() + " reads " + description + " from text file " + filepath + "...");
 
@@ -93,11 +178,62 @@ TextInFile::TextInFile(const SimulationItem* item, string filename, string descr
 
 ////////////////////////////////////////////////////////////////////
 
+void TextInFile::openBinary(string filepath)
+{
+    // acquire a memory map for the file; the function returns zeros if the memory map cannot be created
+    auto map = System::acquireMemoryMap(filepath);
+    if (!map.first) throw FATALERROR("Cannot acquire memory map for file: " + filepath);
+    _binary = true;
+    const BinaryItem* currentItem = static_cast<const BinaryItem*>(map.first);
+    const BinaryItem* endItem = currentItem + map.second / itemSize;
+
+    // verify the tag and the Endianness value, and get the number of columns and rows
+    if (map.second < 4 * itemSize || memcmp(binaryTag, currentItem++->stringType, itemSize)
+        || currentItem++->sizeType != binaryEndianness)
+        throw FATALERROR("File does not have binary column format: " + filepath);
+    _numBinaryCols = currentItem++->sizeType;
+    _numBinaryRows = currentItem++->sizeType;
+
+    // read the column information into a list of ColumnInfo records
+    vector<ColumnInfo> colv(_numBinaryCols);
+    for (size_t index = 0; index != _numBinaryCols; ++index)
+    {
+        colv[index].physColIndex = index + 1;
+        colv[index].title = readBinaryString(currentItem);
+        colv[index].unit = readBinaryString(currentItem);
+        if (!colv[index].title.empty() || !colv[index].unit.empty()) _hasFileInfo = true;
+        if (currentItem > endItem) throw FATALERROR("Binary column file header is truncated: " + filepath);
+    }
+    if (_hasFileInfo) _colv = colv;
+
+    // verify the size of the data section
+    _data = &currentItem->doubleType;
+    if (static_cast<size_t>(endItem - currentItem) < _numBinaryCols * _numBinaryRows)
+        throw FATALERROR("Binary column file data is truncated: " + filepath);
+}
+
+////////////////////////////////////////////////////////////////////
+
 void TextInFile::close()
 {
-    if (_in.is_open())
+    if (_in.is_open() || _data)
     {
-        _in.close();
+        if (_binary)
+        {
+            System::releaseMemoryMap(_filePath);
+            _data = nullptr;
+        }
+        else
+        {
+            if (_text)
+            {
+                System::releaseMemoryMap(_filePath);
+                _text = nullptr;
+                _blockValues.clear();
+                _blockValues.shrink_to_fit();
+            }
+            _in.close();
+        }
 
         // log "done" message, except if an exception has been thrown
         if (!std::uncaught_exception()) _log->info("Done reading");
@@ -283,6 +419,42 @@ bool TextInFile::readRow(Array& values)
 {
     if (!_hasProgInfo) throw FATALERROR("No columns were declared for column text file");
 
+    // for a binary file, simply copy and convert the values in the next row
+    if (_binary)
+    {
+        if (_logColIndices.size() > _numBinaryCols)
+            throw FATALERROR("One or more required column(s) are missing from binary column file");
+        if (!_data || _nextRow == _numBinaryRows) return false;
+
+        if (values.size() != _numLogCols) values.resize(_numLogCols);
+        size_t physIndex = 0;
+        for (size_t i : _logColIndices)  // i: zero-based logical index
+        {
+            if (i != ERROR_NO_INDEX)
+            {
+                const ColumnInfo& col = _colv[i];
+                double value = _data[physIndex * _numBinaryRows + _nextRow];
+                values[i] = value * (col.waveExponent ? pow(values[col.waveIndex], col.waveExponent) : col.convFactor);
+            }
+            physIndex++;
+        }
+        _nextRow++;
+        return true;
+    }
+
+    // for a large text file, return the next row from the block parsed in parallel
+    if (!_sequential && !_text) startParsing();
+    if (_text)
+    {
+        if (_nextBlockRow == _numBlockRows && !parseNextBlock()) return false;
+
+        if (values.size() != _numLogCols) values.resize(_numLogCols);
+        const double* row = _blockValues.data() + _nextBlockRow * _numLogCols;
+        for (size_t i = 0; i != _numLogCols; ++i) values[i] = row[i];
+        _nextBlockRow++;
+        return true;
+    }
+
     // read new line until it is non-empty and non-comment
     string line;
     while (_in.good())
@@ -323,8 +495,135 @@ bool TextInFile::readRow(Array& values)
 
 ////////////////////////////////////////////////////////////////////
 
+void TextInFile::startParsing()
+{
+    // determine the offset of the first line not yet read and the size of the file
+    _sequential = true;
+    auto pos = _in.tellg();
+    if (pos < 0) return;
+    _in.seekg(0, std::ios::end);
+    auto size = _in.tellg();
+    _in.seekg(pos);
+    if (size < 0 || static_cast<size_t>(size - pos) < minParallelTextSize) return;
+
+    // acquire a memory map on the file; if this fails, simply revert to sequential reading
+    auto map = System::acquireMemoryMap(_filePath);
+    if (!map.first) return;
+    _sequential = false;
+    _text = static_cast<const char*>(map.first);
+    _textSize = map.second;
+    _textPos = static_cast<size_t>(pos);
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool TextInFile::parseNextBlock()
+{
+    // the number of values to be stored for each row
+    size_t numLogCols = _numLogCols;
+
+    // parse blocks until at least one row has been found or the end of the file has been reached
+    _numBlockRows = 0;
+    _nextBlockRow = 0;
+    while (!_numBlockRows && _textPos < _textSize)
+    {
+        // determine the extent of the block, ending at a line boundary
+        size_t blockBegin = _textPos;
+        size_t blockEnd = nextLineStart(_text, min(blockBegin + textBlockSize, _textSize) - 1, _textSize);
+        _textPos = blockEnd;
+
+        // split the block into chunks at line boundaries
+        vector<size_t> chunkBegins;
+        for (size_t chunkBegin = blockBegin; chunkBegin < blockEnd;
+             chunkBegin = nextLineStart(_text, min(chunkBegin + textChunkSize, blockEnd) - 1, blockEnd))
+            chunkBegins.push_back(chunkBegin);
+        size_t numChunks = chunkBegins.size();
+        chunkBegins.push_back(blockEnd);
+
+        // parse the chunks in parallel, each into its own list of converted values in row order
+        vector<vector<double>> chunkValues(numChunks);
+        _log->find<ParallelFactory>()->parallelLocal()->call(
+            numChunks, [this, &chunkBegins, &chunkValues, numLogCols](size_t firstIndex, size_t numIndices) {
+                string lastLine;
+                for (size_t c = firstIndex; c != firstIndex + numIndices; ++c)
+                {
+                    vector<double>& values = chunkValues[c];
+                    size_t pos = chunkBegins[c];
+                    size_t end = chunkBegins[c + 1];
+                    while (pos < end)
+                    {
+                        // determine the extent of the line, excluding the line terminator
+                        size_t lineEnd = nextLineStart(_text, pos, end);
+                        const char* ptr = _text + pos;
+                        const char* endptr = _text + lineEnd;
+                        pos = lineEnd;
+
+                        // if the last line in the file is not terminated, copy it so that parsing
+                        // does not run beyond the end of the memory map
+                        if (endptr == _text + _textSize && endptr[-1] != '\n')
+                        {
+                            lastLine.assign(ptr, endptr);
+                            ptr = lastLine.c_str();
+                            endptr = ptr + lastLine.size();
+                        }
+
+                        // skip empty lines and comment lines
+                        while (ptr != endptr && (*ptr == ' ' || *ptr == '\t')) ptr++;
+                        if (ptr == endptr || *ptr == '\n' || *ptr == '\r' || *ptr == '#') continue;
+
+                        // convert values from line and store them in a new row
+                        size_t rowIndex = values.size();
+                        values.resize(rowIndex + numLogCols);
+                        double* row = values.data() + rowIndex;
+                        for (size_t i : _logColIndices)  // i: zero-based logical index
+                        {
+                            while (ptr != endptr && (*ptr == ' ' || *ptr == '\t')) ptr++;
+                            if (ptr == endptr || *ptr == '\n' || *ptr == '\r')
+                                throw FATALERROR("One or more required value(s) on text line are missing");
+
+                            // read the value as floating point
+                            char* valueEnd;
+                            double value = std::strtod(ptr, &valueEnd);
+                            if (valueEnd == ptr || !isDecimalNumber(ptr, valueEnd))
+                                throw FATALERROR("Input text is not formatted as a floating point number");
+                            ptr = valueEnd;
+
+                            // if mapped to a logical column, convert from input units to internal units
+                            if (i != ERROR_NO_INDEX)
+                            {
+                                const ColumnInfo& col = _colv[i];
+                                row[i] = value
+                                         * (col.waveExponent ? pow(row[col.waveIndex], col.waveExponent)
+                                                             : col.convFactor);
+                            }
+                        }
+                    }
+                }
+            });
+
+        // assemble the rows in the original order
+        size_t numValues = 0;
+        for (const auto& values : chunkValues) numValues += values.size();
+        _blockValues.resize(numValues);
+        auto output = _blockValues.begin();
+        for (auto& values : chunkValues)
+        {
+            output = std::copy(values.begin(), values.end(), output);
+            values = vector<double>();
+        }
+        _numBlockRows = numLogCols ? numValues / numLogCols : 0;
+    }
+    return _numBlockRows != 0;
+}
+
+////////////////////////////////////////////////////////////////////
+
 bool TextInFile::readNonLeaf(int& nx, int& ny, int& nz)
 {
+    if (_binary) throw FATALERROR("Binary column files cannot contain nonleaf node specifications");
+    if (_text) throw FATALERROR("Cannot read nonleaf node specifications after rows have been parsed in parallel");
+    _sequential = true;
+
     string line;
 
     while (true)
@@ -387,6 +686,34 @@ vector<Array> TextInFile::readAllRows()
 
 vector<Array> TextInFile::readAllColumns()
 {
+    // for a binary file, convert the remaining values column by column
+    if (_binary)
+    {
+        if (!_hasProgInfo) throw FATALERROR("No columns were declared for column text file");
+        if (_logColIndices.size() > _numBinaryCols)
+            throw FATALERROR("One or more required column(s) are missing from binary column file");
+        size_t nrows = _data ? _numBinaryRows - _nextRow : 0;
+
+        // process the columns in physical order so that any wavelength column is converted before it is used
+        vector<Array> columns(_numLogCols, Array(nrows));
+        size_t physIndex = 0;
+        for (size_t i : _logColIndices)  // i: zero-based logical index
+        {
+            if (i != ERROR_NO_INDEX && nrows)
+            {
+                const ColumnInfo& col = _colv[i];
+                Array input(_data + physIndex * _numBinaryRows + _nextRow, nrows);
+                if (col.waveExponent)
+                    columns[i] = input * pow(columns[col.waveIndex], static_cast<double>(col.waveExponent));
+                else
+                    columns[i] = input * col.convFactor;
+            }
+            physIndex++;
+        }
+        _nextRow += nrows;
+        return columns;
+    }
+
     // read the remainder of the file into rows
     const vector<Array>& rows = readAllRows();
     size_t nrows = rows.size();
@@ -401,3 +728,77 @@ vector<Array> TextInFile::readAllColumns()
 }
 
 ////////////////////////////////////////////////////////////////////
+
+size_t TextInFile::writeBinary(string inFilePath, string outFilePath)
+{
+    // open the text file
+    std::ifstream in = System::ifstream(inFilePath);
+    if (!in) throw FATALERROR("Could not open the text file " + inFilePath);
+
+    // read the structured header lines, if any
+    vector<string> titles;
+    vector<string> units;
+    size_t index;
+    string title;
+    string unit;
+    while (getNextInfoLine(in, index, title, unit))
+    {
+        if (index != titles.size() + 1)
+            throw FATALERROR("Incorrect column index in file header for column " + std::to_string(titles.size() + 1));
+        titles.push_back(title);
+        units.push_back(unit);
+    }
+
+    // read the data values into a list of columns
+    vector<vector<double>> columns(titles.size());
+    string line;
+    while (getline(in, line))
+    {
+        auto pos = line.find_first_not_of(" \t\r");
+        if (pos == string::npos || line[pos] == '#') continue;
+        if (line[pos] == '!') throw FATALERROR("Nonleaf node specifications cannot be converted to binary format");
+
+        // if there is no column information, use the number of values on the first data line
+        std::stringstream linestream(line);
+        if (columns.empty())
+        {
+            double value;
+            while (linestream >> value) columns.emplace_back();
+            if (columns.empty()) throw FATALERROR("Input text is not formatted as a floating point number");
+            titles.resize(columns.size());
+            units.resize(columns.size());
+            linestream = std::stringstream(line);
+        }
+
+        // convert values from line and add them to the columns
+        for (auto& column : columns)
+        {
+            if (linestream.eof()) throw FATALERROR("One or more required value(s) on text line are missing");
+            double value;
+            linestream >> value;
+            if (linestream.fail()) throw FATALERROR("Input text is not formatted as a floating point number");
+            column.push_back(value);
+        }
+    }
+    size_t numRows = columns.empty() ? 0 : columns[0].size();
+
+    // write the binary file
+    std::ofstream out = System::ofstream(outFilePath);
+    if (!out) throw FATALERROR("Could not open the binary column file " + outFilePath);
+    out.write(binaryTag, itemSize);
+    writeBinaryItem(out, binaryEndianness);
+    writeBinaryItem(out, columns.size());
+    writeBinaryItem(out, numRows);
+    for (size_t c = 0; c != columns.size(); ++c)
+    {
+        writeBinaryString(out, titles[c]);
+        writeBinaryString(out, units[c]);
+    }
+    for (const auto& column : columns)
+        out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(double));
+    out.close();
+    if (!out) throw FATALERROR("Could not write the binary column file " + outFilePath);
+    return numRows;
+}
+
+////////////////////////////////////////////////////////////////////
@@ -50,7 +50,33 @@ class Units;
     and after the column info lines.
 
     If there is no column information in the file (i.e. none of the header lines match the syntax
-    decribed above), the default units provided by the program are used. */
+    decribed above), the default units provided by the program are used.
+
+    <b>Binary column files</b>
+
+    As an alternative to the column text format, this class transparently supports a binary
+    column format, which can be read much faster because the values do not need to be parsed. The
+    format is recognized by the tag at the start of the file, regardless of the filename
+    extension. The file is accessed through a memory map, so that its contents are never copied
+    into memory as a whole. A binary column file can be created from a column text file using the
+    writeBinary() function, which is available to the user through the -c command line option of
+    SKIRT.
+
+    A binary column file is a sequence of 8-byte items, each representing a string of 8
+    characters, an unsigned 64-bit integer, or a 64-bit floating point number, in little-endian
+    byte order. The file contains the following information:
+      - the tag string "SKIRT C\n"
+      - the integer 0x010203040A0BFEFF, used to verify the byte order
+      - the number of columns \f$N_\mathrm{c}\f$ and the number of rows \f$N_\mathrm{r}\f$
+      - for each column: the number of characters in the column description, followed by the
+        description padded with spaces to a multiple of 8 characters; and the number of characters
+        in the unit string, followed by the unit string padded in the same way
+      - the \f$N_\mathrm{c}\times N_\mathrm{r}\f$ data values in the units specified for each
+        column, stored column after column.
+
+    If all column descriptions and unit strings are empty, the file is considered not to contain
+    column information, and the default units provided by the program are used. Binary column
+    files cannot hold the nonleaf node specifications used for adaptive mesh data. */
 class TextInFile
 {
     //=============== Construction - Destruction  ==================
@@ -155,7 +181,15 @@ public:
         converted input values are stored into it in column order, and the function returns true.
 
         If the end of the file is reached before a row can be read, the function returns false and
-        the size and contents of the \em values array are undefined. */
+        the size and contents of the \em values array are undefined.
+
+        For a large column text file, the first invocation of this function acquires a memory map
+        on the file. The remaining lines are then parsed in blocks of several tens of megabytes,
+        with each block split into chunks that are parsed concurrently by the available execution
+        threads, and subsequent invocations simply return the next row from the current block. The
+        values are converted without going through a stream, avoiding most of the parsing overhead.
+        This mechanism is transparent to the caller, except that errors in the input text may be
+        reported before all preceding rows have been returned. */
     bool readRow(Array& values);
 
     /** This is a specialy function intended for use by the AdaptiveMeshSnapshot class when
@@ -172,7 +206,11 @@ public:
         exclamation mark, the contents of the function arguments is undefined and the function
         returns false. In this case, the function has not consumed any information other than
         comments and white space. The file cursor is left just before the next regular line (i.e. a
-        line not starting with an exclamation mark), or at the end of the file. */
+        line not starting with an exclamation mark), or at the end of the file.
+
+        Because the nonleaf node specifications must be interleaved with regular rows, calling this
+        function causes the file to be read sequentially, i.e. disables the parallel parsing
+        mechanism described for the readRow() function. */
     bool readNonLeaf(int& nx, int& ny, int& nz);
 
     /** This variadic template function reads the next row from a column text file and stores the
@@ -205,6 +243,16 @@ public:
         like readRow(Array&). */
     vector<Array> readAllColumns();
 
+    /** This function converts the column text file at the specified path into a binary column
+        file (see the description of this class) with the specified path, and returns the number
+        of rows in the converted file. The column information and the units in the header of the
+        text file are copied to the binary file, and the values are stored as is, i.e. without unit
+        conversion. If the text file has no column information, the number of columns is
+        determined from the first data line. The complete data set is held in memory during the
+        conversion. If either of the files can't be opened, or if the text file is improperly
+        formatted, a FatalError is thrown. */
+    static size_t writeBinary(string inFilePath, string outFilePath);
+
     /** This function reads all rows from a column text file (from the current position until the
         end of the file), transposes the data repesentation from rows into columns, and stores the
         resulting column arrays in the variables passed to the function by reference. For each row,
@@ -228,6 +276,31 @@ private:
         the error value if there is no such column. */
     size_t waveIndexForSpecificQuantity() const;
 
+    //======================== Private helpers for binary files ========================
+
+private:
+    /** This function acquires a memory map on the binary column file with the specified path,
+        verifies the file format, and initializes the column information from the file header.
+        If the file can't be mapped or does not have the appropriate format, a FatalError is
+        thrown. */
+    void openBinary(string filepath);
+
+    /** This function is called by readRow() when it is invoked for the first time on a column
+        text file. If the remainder of the file is sufficiently large, and readNonLeaf() has not
+        been called, the function acquires a memory map on the file so that the remaining lines can
+        be parsed in parallel. Otherwise, the function marks the file for sequential reading
+        through the input stream. */
+    void startParsing();
+
+    /** This function parses the next block of lines in the memory-mapped column text file into
+        the internal row buffer. The block is split into chunks at line boundaries, and the chunks
+        are parsed concurrently by the execution threads of the calling process, even when there
+        are multiple processes. Values are converted with strtod(), but only plain decimal numbers
+        are accepted, consistent with sequential reading through the input stream. The rows are
+        assembled in the order in which they appear in the file. The function returns false if the
+        end of the file has been reached without finding any further rows, and true otherwise. */
+    bool parseNextBlock();
+
     //======================== Private helpers for reading ========================
 
 private:
@@ -277,6 +350,24 @@ private:
     size_t _numLogCols{0};     // number of logical columns, or number of program columns added so far
 
     vector<size_t> _logColIndices;  // zero-based index into _colv for each physical column to be read
+
+    string _filePath;  // the path of the input file, used to acquire and release memory maps
+
+    // binary column file, if applicable
+    bool _binary{false};           // true if the file has binary column format
+    const double* _data{nullptr};  // pointer to the first value of the first column in the memory map
+    size_t _numBinaryCols{0};      // number of physical columns in the binary file
+    size_t _numBinaryRows{0};      // number of rows in the binary file
+    size_t _nextRow{0};            // zero-based index of the next row to be read from the binary file
+
+    // parallel parsing of a large column text file, if applicable
+    bool _sequential{false};      // true if the text file must be read sequentially through the input stream
+    const char* _text{nullptr};   // pointer to the memory-mapped text file, or null if not (yet) mapped
+    size_t _textSize{0};          // number of bytes in the memory-mapped text file
+    size_t _textPos{0};           // offset in the memory-mapped text file of the first line not yet parsed
+    vector<double> _blockValues;  // converted values for the rows in the current block, in row order
+    size_t _numBlockRows{0};      // number of rows in the current block
+    size_t _nextBlockRow{0};      // zero-based index of the next row to be read from the current block
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -4,6 +4,7 @@
 ///////////////////////////////////////////////////////////////// */
 
 #include "TreeSpatialGrid.hpp"
+#include "FatalError.hpp"
 #include "Log.hpp"
 #include "Random.hpp"
 #include "SpatialGridPath.hpp"
@@ -13,13 +14,6 @@
 
 ////////////////////////////////////////////////////////////////////
 
-TreeSpatialGrid::~TreeSpatialGrid()
-{
-    for (auto node : _nodev) delete node;
-}
-
-////////////////////////////////////////////////////////////////////
-
 void TreeSpatialGrid::setupSelfAfter()
 {
     BoxSpatialGrid::setupSelfAfter();
@@ -30,35 +24,82 @@ void TreeSpatialGrid::setupSelfAfter()
     // make subclass construct the tree
     Log* log = find<Log>();
     log->info("Constructing the spatial tree grid...");
-    _nodev = constructTree();
+    vector<TreeNode*> nodev = constructTree();
 
-    // construct the vectors to help translating between node indices (leaf and nonleaf) and cell indices (leaf only)
+    // copy the tree into the flat representation, and construct the vectors to help translating
+    // between node indices (leaf and nonleaf) and cell indices (leaf only)
     //  _cellindexv : cell index m corresponding to each node in nodev; -1 for nonleaf nodes
     //  _idv;       : index in nodev for each cell (i.e. leaf node); corresponds to node ID
-    int numNodes = _nodev.size();
-    int m = 0;
+    size_t numNodes = nodev.size();
+    _xminv.resize(numNodes);
+    _yminv.resize(numNodes);
+    _zminv.resize(numNodes);
+    _xmaxv.resize(numNodes);
+    _ymaxv.resize(numNodes);
+    _zmaxv.resize(numNodes);
+    _childv.resize(numNodes, -1);
+    _splitv.resize(numNodes, 0);
+    _neighborbeginv.resize(6 * numNodes + 1);
     _cellindexv.resize(numNodes, -1);
-    for (int l = 0; l != numNodes; ++l)
+    size_t numNeighbors = 0;
+    int m = 0;
+    for (size_t l = 0; l != numNodes; ++l)
     {
-        if (_nodev[l]->isChildless())
+        TreeNode* node = nodev[l];
+        if (static_cast<size_t>(node->id()) != l) throw FATALERROR("Tree node ID does not match index in node list");
+        node->extent(_xminv[l], _yminv[l], _zminv[l], _xmaxv[l], _ymaxv[l], _zmaxv[l]);
+
+        if (node->isChildless())
         {
             _idv.push_back(l);
             _cellindexv[l] = m;
             m++;
         }
+        else
+        {
+            // verify that the children have consecutive IDs, and remember the axes along which the node is split
+            const auto& children = node->children();
+            int first = children[0]->id();
+            for (size_t c = 0; c != children.size(); ++c)
+                if (children[c]->id() != first + static_cast<int>(c))
+                    throw FATALERROR("Tree node children do not have consecutive IDs");
+            _childv[l] = first;
+            if (children[0]->xmax() < node->xmax()) _splitv[l] |= 1;
+            if (children[0]->ymax() < node->ymax()) _splitv[l] |= 2;
+            if (children[0]->zmax() < node->zmax()) _splitv[l] |= 4;
+        }
+
+        for (int wall = 0; wall != 6; ++wall)
+        {
+            _neighborbeginv[6 * l + wall] = numNeighbors;
+            numNeighbors += node->neighbors(static_cast<TreeNode::Wall>(wall)).size();
+        }
     }
+    if (numNeighbors > static_cast<size_t>(std::numeric_limits<int>::max()))
+        throw FATALERROR("The spatial tree grid has too many neighbor relations");
+    _neighborbeginv[6 * numNodes] = numNeighbors;
+
+    // copy the neighbor lists into the flat representation, preserving the order of each list
+    _neighborv.reserve(numNeighbors);
+    for (auto node : nodev)
+        for (int wall = 0; wall != 6; ++wall)
+            for (auto neighbor : node->neighbors(static_cast<TreeNode::Wall>(wall)))
+                _neighborv.push_back(neighbor->id());
+
+    // the original tree nodes are no longer needed
+    for (auto node : nodev) delete node;
+    nodev.clear();
 
     // determine the number of cells at each level in the tree hierarchy
     vector<int> countv;
-    int numCells = _idv.size();
-    for (int m = 0; m != numCells; ++m)
+    for (int level : cellLevels())
     {
-        int level = nodeForCellIndex(m)->level();
         if (level + 1 > static_cast<int>(countv.size())) countv.resize(level + 1);
         countv[level]++;
     }
 
     // log these statistics, including a basic histogram
+    int numCells = _idv.size();
     log->info("Finished construction of the spatial tree grid");
     log->info("Number of cells at each level in the tree hierarchy:");
     int numLevels = countv.size();
@@ -85,36 +126,43 @@ int TreeSpatialGrid::numCells() const
 
 double TreeSpatialGrid::volume(int m) const
 {
-    return nodeForCellIndex(m)->volume();
+    return cellExtent(m).volume();
 }
 
 ////////////////////////////////////////////////////////////////////
 
 double TreeSpatialGrid::diagonal(int m) const
 {
-    return nodeForCellIndex(m)->diagonal();
+    return cellExtent(m).diagonal();
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool TreeSpatialGrid::hasCuboidalCells() const
+{
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////////
 
 int TreeSpatialGrid::cellIndex(Position bfr) const
 {
-    const TreeNode* node = root()->leafChild(bfr);
-    return node ? cellIndexForNode(node) : -1;
+    int id = leafNodeId(bfr.x(), bfr.y(), bfr.z());
+    return id >= 0 ? _cellindexv[id] : -1;
 }
 
 ////////////////////////////////////////////////////////////////////
 
 Position TreeSpatialGrid::centralPositionInCell(int m) const
 {
-    return Position(nodeForCellIndex(m)->extent().center());
+    return Position(cellExtent(m).center());
 }
 
 ////////////////////////////////////////////////////////////////////
 
 Position TreeSpatialGrid::randomPositionInCell(int m) const
 {
-    return random()->position(nodeForCellIndex(m)->extent());
+    return random()->position(cellExtent(m));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -124,23 +172,48 @@ void TreeSpatialGrid::path(SpatialGridPath* path) const
     // if the photon packet starts outside the dust grid, move it into the first grid cell that it will pass
     Position bfr = path->moveInside(extent(), _eps);
 
-    // get the node containing the current location;
-    // if the position is not inside the grid, return an empty path
-    const TreeNode* node = root()->leafChild(bfr);
-    if (!node) return path->clear();
+    // store each segment in the path; if the position is not inside the grid, return an empty path
+    auto visit = [path](int m, double ds) {
+        path->addSegment(m, ds);
+        return true;
+    };
+    if (!traverse(bfr, path->direction(), visit)) path->clear();
+}
+
+////////////////////////////////////////////////////////////////////
+
+void TreeSpatialGrid::traversePath(SpatialGridPath* path, const SegmentVisitor& visit) const
+{
+    // if the photon packet starts outside the dust grid, move it into the first grid cell that it will pass
+    Position bfr = path->moveInside(extent(), _eps);
+    if (!contains(0, bfr.x(), bfr.y(), bfr.z())) return path->clear();
+
+    // pass the segments outside of the grid added while moving inside, and then the segments inside the grid
+    for (const auto& segment : path->segments())
+        if (!visit(segment.m, segment.ds)) return;
+    traverse(bfr, path->direction(), visit);
+}
+
+////////////////////////////////////////////////////////////////////
 
+template<class Visitor> bool TreeSpatialGrid::traverse(Position bfr, Direction bfk, Visitor& visit) const
+{
     // get the starting point and direction
     double x, y, z;
     bfr.cartesian(x, y, z);
     double kx, ky, kz;
-    path->direction().cartesian(kx, ky, kz);
+    bfk.cartesian(kx, ky, kz);
+
+    // get the node containing the current location
+    int id = leafNodeId(x, y, z);
+    if (id < 0) return false;
 
     // loop over nodes/path segments until we leave the grid
-    while (node)
+    while (id >= 0)
     {
-        double xnext = (kx < 0.0) ? node->xmin() : node->xmax();
-        double ynext = (ky < 0.0) ? node->ymin() : node->ymax();
-        double znext = (kz < 0.0) ? node->zmin() : node->zmax();
+        double xnext = (kx < 0.0) ? _xminv[id] : _xmaxv[id];
+        double ynext = (ky < 0.0) ? _yminv[id] : _ymaxv[id];
+        double znext = (kz < 0.0) ? _zminv[id] : _zmaxv[id];
         double dsx = (fabs(kx) > 1e-15) ? (xnext - x) / kx : DBL_MAX;
         double dsy = (fabs(ky) > 1e-15) ? (ynext - y) / ky : DBL_MAX;
         double dsz = (fabs(kz) > 1e-15) ? (znext - z) / kz : DBL_MAX;
@@ -162,7 +235,7 @@ void TreeSpatialGrid::path(SpatialGridPath* path) const
             ds = dsz;
             wall = (kz < 0.0) ? TreeNode::BOTTOM : TreeNode::TOP;
         }
-        path->addSegment(cellIndexForNode(node), ds);
+        if (!visit(_cellindexv[id], ds)) break;
         x += (ds + _eps) * kx;
         y += (ds + _eps) * ky;
         z += (ds + _eps) * kz;
@@ -171,30 +244,30 @@ void TreeSpatialGrid::path(SpatialGridPath* path) const
         // this should not fail unless the new location is outside the grid,
         // however on rare occasions it fails due to rounding errors (e.g. in a corner),
         // thus we use top-down search as a fall-back
-        const TreeNode* oldnode = node;
-        node = node->neighbor(wall, Vec(x, y, z));
-        if (!node) node = root()->leafChild(Vec(x, y, z));
+        int oldid = id;
+        id = neighborNodeId(id, wall, x, y, z);
+        if (id < 0) id = leafNodeId(x, y, z);
 
         // if we're stuck in the same node...
-        if (node == oldnode)
+        if (id == oldid)
         {
             // try to escape by advancing the position to the next representable coordinates
-            find<Log>()->warning("Photon packet seems stuck in spatial cell " + std::to_string(node->id())
-                                 + " -- escaping");
+            find<Log>()->warning("Photon packet seems stuck in spatial cell " + std::to_string(id) + " -- escaping");
             x = std::nextafter(x, (kx < 0.0) ? -DBL_MAX : DBL_MAX);
             y = std::nextafter(y, (ky < 0.0) ? -DBL_MAX : DBL_MAX);
             z = std::nextafter(z, (kz < 0.0) ? -DBL_MAX : DBL_MAX);
-            node = root()->leafChild(Vec(x, y, z));
+            id = leafNodeId(x, y, z);
 
             // if that didn't work, terminate the path
-            if (node == oldnode)
+            if (id == oldid)
             {
-                find<Log>()->warning("Photon packet is stuck in spatial cell " + std::to_string(node->id())
+                find<Log>()->warning("Photon packet is stuck in spatial cell " + std::to_string(id)
                                      + " -- terminating this path");
                 break;
             }
         }
     }
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -203,14 +276,14 @@ namespace
 {
     // this function writes a "0" for a leaf node or a "1" for a nonleaf node
     // followed by the recursive topological representation of its children
-    void writeTopologyForNode(TreeNode* node, TextOutFile* outfile)
+    void writeTopologyForNode(const vector<int>& childv, int id, int numChildren, TextOutFile* outfile)
     {
-        if (node->isChildless())
+        if (childv[id] < 0)
             outfile->writeLine("0");
         else
         {
             outfile->writeLine("1");
-            for (auto child : node->children()) writeTopologyForNode(child, outfile);
+            for (int c = 0; c != numChildren; ++c) writeTopologyForNode(childv, childv[id] + c, numChildren, outfile);
         }
     }
 }
@@ -219,9 +292,19 @@ namespace
 
 void TreeSpatialGrid::writeTopology(TextOutFile* outfile) const
 {
+    // the number of children for each nonleaf node is determined by the number of split axes
+    // (8 for an octtree, 2 for a binary tree, or 0 if the root node has not been subdivided)
+    int numChildren = 0;
+    if (_childv[0] >= 0)
+    {
+        numChildren = 1;
+        for (int axis = 0; axis != 3; ++axis)
+            if (_splitv[0] & (1 << axis)) numChildren *= 2;
+    }
+
     outfile->writeLine("# Topology for tree spatial grid with " + std::to_string(numCells()) + " cells");
-    outfile->writeLine(std::to_string(root()->children().size()));  // zero if the root node is not subdivided
-    writeTopologyForNode(root(), outfile);
+    outfile->writeLine(std::to_string(numChildren));
+    writeTopologyForNode(_childv, 0, numChildren, outfile);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -233,10 +316,10 @@ void TreeSpatialGrid::write_xy(SpatialGridPlotFile* outfile) const
     int nCells = numCells();
     for (int m = 0; m != nCells; ++m)
     {
-        TreeNode* node = nodeForCellIndex(m);
-        if (fabs(node->zmin()) < 1e-8 * extent().zwidth())
+        int id = _idv[m];
+        if (fabs(_zminv[id]) < 1e-8 * extent().zwidth())
         {
-            outfile->writeRectangle(node->xmin(), node->ymin(), node->xmax(), node->ymax());
+            outfile->writeRectangle(_xminv[id], _yminv[id], _xmaxv[id], _ymaxv[id]);
         }
     }
 }
@@ -250,10 +333,10 @@ void TreeSpatialGrid::write_xz(SpatialGridPlotFile* outfile) const
     int nCells = numCells();
     for (int m = 0; m != nCells; ++m)
     {
-        TreeNode* node = nodeForCellIndex(m);
-        if (fabs(node->ymin()) < 1e-8 * extent().ywidth())
+        int id = _idv[m];
+        if (fabs(_yminv[id]) < 1e-8 * extent().ywidth())
         {
-            outfile->writeRectangle(node->xmin(), node->zmin(), node->xmax(), node->zmax());
+            outfile->writeRectangle(_xminv[id], _zminv[id], _xmaxv[id], _zmaxv[id]);
         }
     }
 }
@@ -267,10 +350,10 @@ void TreeSpatialGrid::write_yz(SpatialGridPlotFile* outfile) const
     int nCells = numCells();
     for (int m = 0; m != nCells; ++m)
     {
-        TreeNode* node = nodeForCellIndex(m);
-        if (fabs(node->xmin()) < 1e-8 * extent().xwidth())
+        int id = _idv[m];
+        if (fabs(_xminv[id]) < 1e-8 * extent().xwidth())
         {
-            outfile->writeRectangle(node->ymin(), node->zmin(), node->ymax(), node->zmax());
+            outfile->writeRectangle(_yminv[id], _zminv[id], _ymaxv[id], _zmaxv[id]);
         }
     }
 }
@@ -280,11 +363,11 @@ void TreeSpatialGrid::write_yz(SpatialGridPlotFile* outfile) const
 void TreeSpatialGrid::write_xyz(SpatialGridPlotFile* outfile) const
 {
     // determine the number of cells at each level in the tree hierarchy
+    vector<int> levelv = cellLevels();
     vector<int> countv;
     int nCells = numCells();
-    for (int m = 0; m != nCells; ++m)
+    for (int level : levelv)
     {
-        int level = nodeForCellIndex(m)->level();
         if (level + 1 > static_cast<int>(countv.size())) countv.resize(level + 1);
         countv[level]++;
     }
@@ -307,31 +390,90 @@ void TreeSpatialGrid::write_xyz(SpatialGridPlotFile* outfile) const
     // output all leaf cells up to a certain level
     for (int m = 0; m != nCells; ++m)
     {
-        TreeNode* node = nodeForCellIndex(m);
-        if (node->level() <= highestWriteLevel)
-            outfile->writeCube(node->xmin(), node->ymin(), node->zmin(), node->xmax(), node->ymax(), node->zmax());
+        int id = _idv[m];
+        if (levelv[m] <= highestWriteLevel)
+            outfile->writeCube(_xminv[id], _yminv[id], _zminv[id], _xmaxv[id], _ymaxv[id], _zmaxv[id]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+int TreeSpatialGrid::leafNodeId(double x, double y, double z) const
+{
+    if (!contains(0, x, y, z)) return -1;
+
+    // descend the tree; the children of a node are ordered with the x-axis split varying fastest
+    int id = 0;
+    while (_childv[id] >= 0)
+    {
+        int first = _childv[id];
+        int split = _splitv[id];
+        int offset = 0;
+        int bit = 1;
+        if (split & 1)
+        {
+            if (x >= _xmaxv[first]) offset += bit;
+            bit <<= 1;
+        }
+        if (split & 2)
+        {
+            if (y >= _ymaxv[first]) offset += bit;
+            bit <<= 1;
+        }
+        if (split & 4)
+        {
+            if (z >= _zmaxv[first]) offset += bit;
+        }
+        id = first + offset;
     }
+    return id;
 }
 
 ////////////////////////////////////////////////////////////////////
 
-TreeNode* TreeSpatialGrid::root() const
+int TreeSpatialGrid::neighborNodeId(int id, int wall, double x, double y, double z) const
 {
-    return _nodev[0];
+    int begin = _neighborbeginv[6 * id + wall];
+    int end = _neighborbeginv[6 * id + wall + 1];
+    for (int i = begin; i != end; ++i)
+    {
+        int neighbor = _neighborv[i];
+        if (contains(neighbor, x, y, z)) return neighbor;
+    }
+    return -1;  // specified position is not inside any of the neighbors
 }
 
 ////////////////////////////////////////////////////////////////////
 
-TreeNode* TreeSpatialGrid::nodeForCellIndex(int m) const
+Box TreeSpatialGrid::cellExtent(int m) const
 {
-    return _nodev[_idv[m]];
+    int id = _idv[m];
+    return Box(_xminv[id], _yminv[id], _zminv[id], _xmaxv[id], _ymaxv[id], _zmaxv[id]);
 }
 
 ////////////////////////////////////////////////////////////////////
 
-int TreeSpatialGrid::cellIndexForNode(const TreeNode* node) const
+vector<int> TreeSpatialGrid::cellLevels() const
 {
-    return _cellindexv[node->id()];
+    // the children of a node always have higher IDs than the node itself,
+    // so we can determine the level of all nodes in a single pass
+    size_t numNodes = _childv.size();
+    vector<int> nodelevelv(numNodes, 0);
+    for (size_t id = 0; id != numNodes; ++id)
+    {
+        if (_childv[id] >= 0)
+        {
+            int numChildren = 1;
+            for (int axis = 0; axis != 3; ++axis)
+                if (_splitv[id] & (1 << axis)) numChildren *= 2;
+            for (int c = 0; c != numChildren; ++c) nodelevelv[_childv[id] + c] = nodelevelv[id] + 1;
+        }
+    }
+
+    int numCells = _idv.size();
+    vector<int> levelv(numCells);
+    for (int m = 0; m != numCells; ++m) levelv[m] = nodelevelv[_idv[m]];
+    return levelv;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -31,10 +31,6 @@ class TreeSpatialGrid : public BoxSpatialGrid
 
     //============= Construction - Setup - Destruction =============
 
-public:
-    /** The destructor deletes all tree nodes created during setup. */
-    ~TreeSpatialGrid();
-
 protected:
     /** This function invokes the constructTree() function, to be implemented by a subclass,
         causing the tree to be constructed. The subclass returns a list of all created nodes back
@@ -42,12 +38,19 @@ protected:
         this list. Ownership of the nodes resides in the list passed back to the base class (not in
         the subclass, and not in the node hierarchy itself).
 
-        After the subclass passes back the tree nodes, this function creates an extra vector that
-        contains the node IDs of all leaf nodes, i.e. all nodes corresponding to the actual spatial
-        cells. Conversely, the function also creates a vector with the cell indices of all the
+        After the subclass passes back the tree nodes, this function converts the tree into a
+        compact, immutable representation consisting of a number of flat arrays indexed on node
+        ID. For each node, these arrays hold the bounds of the node, the node ID of its first child
+        (the children of a node always have consecutive IDs), a bit mask indicating the coordinate
+        axes along which the node is split, and the node IDs of the neighbors at each of its six
+        walls (stored contiguously in the order of the original neighbor lists). The function also
+        creates a vector that contains the node IDs of all leaf nodes, i.e. all nodes corresponding
+        to the actual spatial cells, and conversely a vector with the cell indices of all the
         nodes, i.e. the rank \f$m\f$ of the node in the ID vector if the node is a leaf, and the
-        number -1 if the node is not a leaf (and hence not a spatial cell). Finally, the function
-        logs some details on the number of cells in the tree. */
+        number -1 if the node is not a leaf (and hence not a spatial cell). The original TreeNode
+        objects are then deleted, so that all further operations (including path traversal and
+        cell location) are performed on the flat arrays without pointer chasing or virtual function
+        calls. Finally, the function logs some details on the number of cells in the tree. */
     void setupSelfAfter() override;
 
     /** This function must be implemented in a subclass. It constructs the hierarchical tree and
@@ -84,6 +87,10 @@ public:
         + (\Delta y)^2 + (\Delta z)^2 }\f$. */
     double diagonal(int m) const override;
 
+    /** This function returns true because all cells in this grid are cuboids aligned with the
+        coordinate axes. */
+    bool hasCuboidalCells() const override;
+
     /** This function returns the index of the cell that contains the position \f${\bf{r}}\f$. For
         a tree grid, the search algorithm starts at the root node and selects the child node that
         contains the position. This procedure is repeated until the node is childless, i.e. until
@@ -121,9 +128,16 @@ public:
         repeat this exercise. This loop is terminated when the next position is outside the grid.
 
         To determine the cell index of the "next cell" in this algorithm, the function uses the
-        neighbor lists constructed for each tree node during setup. */
+        neighbor lists constructed for each tree node during setup, which are stored in a flat
+        array of node IDs. */
     void path(SpatialGridPath* path) const override;
 
+    /** This function calculates a path through the grid using the same algorithm as the path()
+        function, passing each segment to the specified visitor function rather than storing it
+        into the SpatialGridPath object, and terminating the traversal as soon as the visitor
+        function returns false. */
+    void traversePath(SpatialGridPath* path, const SegmentVisitor& visit) const override;
+
     /** This function writes the topology of the tree to the specified text file in a simple,
         proprietary format. After a brief descriptive header, it writes lines that each contain
         just a single integer number. The first line specifies the number of children for each
@@ -152,28 +166,59 @@ protected:
     void write_xyz(SpatialGridPlotFile* outfile) const override;
 
 private:
-    /** This function returns a pointer to the root node of the tree. */
-    TreeNode* root() const;
-
-    /** This function returns a pointer to the node corresponding to cell index \f$m\f$. It just
-        reads the node ID of the \f$m\f$'th leaf cell from the precalculated ID vector and returns
-        the corresponding pointer of the tree vector. */
-    TreeNode* nodeForCellIndex(int m) const;
-
-    /** This function returns the cell index \f$m\f$ of a node in the tree. It just obtains the
-        node ID from the node and determines the corresponding cell index from the precalculated
-        cell index vector. */
-    int cellIndexForNode(const TreeNode* node) const;
+    /** This function returns true if the node with ID \f$id\f$ contains the specified position,
+        and false otherwise. */
+    bool contains(int id, double x, double y, double z) const
+    {
+        return x >= _xminv[id] && x <= _xmaxv[id] && y >= _yminv[id] && y <= _ymaxv[id] && z >= _zminv[id]
+               && z <= _zmaxv[id];
+    }
+
+    /** This function returns the ID of the leaf node that contains the specified position, or -1
+        if the position is outside of the grid. The search starts at the root node and repeatedly
+        selects the child node that contains the position until a leaf node is reached. */
+    int leafNodeId(double x, double y, double z) const;
+
+    /** This function returns the ID of the neighbor of the node with ID \f$id\f$ at the
+        specified wall that contains the specified position, or -1 if none of the neighbors at that
+        wall contains the position. */
+    int neighborNodeId(int id, int wall, double x, double y, double z) const;
+
+    /** This template function implements the path traversal algorithm described for the path()
+        function, starting at the specified position (which must be inside the grid) and
+        proceeding in the specified direction. It passes each segment in turn to the specified
+        visitor, which returns true to continue and false to terminate the traversal. The function
+        returns false if the starting position is not inside the grid, and true otherwise. */
+    template<class Visitor> bool traverse(Position bfr, Direction bfk, Visitor& visit) const;
+
+    /** This function returns the extent of the node corresponding to cell index \f$m\f$. */
+    Box cellExtent(int m) const;
+
+    /** This function returns a list with the level in the tree hierarchy for each cell (i.e. leaf
+        node), indexed on cell index. The root node has level zero. */
+    vector<int> cellLevels() const;
 
     //======================== Data Members ========================
 
 private:
     // data members initialized during setup
-    double _eps{0.};           // a small fraction relative to the spatial extent of the grid
-    vector<TreeNode*> _nodev;  // list of all nodes in the tree; holds ownership; first item is root node
-                               // node id in each node corresponds to index in this vector
-    vector<int> _cellindexv;   // cell index m corresponding to each node in nodev; -1 for nonleaf nodes
-    vector<int> _idv;          // node id (or equivalently, index in nodev) for each cell (i.e. leaf node)
+    double _eps{0.};  // a small fraction relative to the spatial extent of the grid
+
+    // flat tree representation, indexed on node id (first node is the root node)
+    vector<double> _xminv;          // node bounds
+    vector<double> _yminv;          // ...
+    vector<double> _zminv;          // ...
+    vector<double> _xmaxv;          // ...
+    vector<double> _ymaxv;          // ...
+    vector<double> _zmaxv;          // ...
+    vector<int> _childv;            // node id of the first child; -1 for leaf nodes
+    vector<unsigned char> _splitv;  // bit mask for the split axes (bit 0 for x, bit 1 for y, bit 2 for z)
+    vector<int> _neighborbeginv;    // index in neighborv of the first neighbor for each node and wall (id*6+wall)
+    vector<int> _neighborv;         // node ids of the neighbors for all nodes and walls, stored contiguously
+
+    // translation between node ids and cell indices
+    vector<int> _cellindexv;  // cell index m corresponding to each node; -1 for nonleaf nodes
+    vector<int> _idv;         // node id for each cell (i.e. leaf node)
 };
 
 //////////////////////////////////////////////////////////////////////
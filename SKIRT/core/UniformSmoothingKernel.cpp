@@ -18,7 +18,13 @@ double UniformSmoothingKernel::density(double u) const
 
 double UniformSmoothingKernel::generateRadius() const
 {
-    double X = random()->uniform();
+    return radiusForMassFraction(random()->uniform());
+}
+
+//////////////////////////////////////////////////////////////////////
+
+double UniformSmoothingKernel::radiusForMassFraction(double X) const
+{
     return pow(X, 1.0 / 3.0);
 }
 
@@ -35,6 +35,11 @@ public:
         for \f$u\f$. For the uniform smoothing kernel, we obtain the simple expression \f$ u =
         \sqrt[3]{\cal{X}} \f$. */
     double generateRadius() const override;
+
+    /** This function returns the normalized radius \f$u\f$ of the sphere that contains the
+        specified fraction \f${\cal{X}}\f$ of the kernel mass. For the uniform smoothing kernel,
+        this is simply \f$ u = \sqrt[3]{\cal{X}} \f$. */
+    double radiusForMassFraction(double X) const override;
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -87,15 +87,15 @@ private:
     Vec _c;                  // centroid position
     double _volume{0.};      // volume
     vector<int> _neighbors;  // list of neighbor indices in _cells vector
-    Array _properties;       // user-defined properties, if any
+    int _index{-1};          // storage index of the user-defined properties, if any
 
 public:
     // constructor stores the specified site position; the other data members are set to zero or empty
     Cell(Vec r) : _r(r) {}
 
-    // constructor derives the site position from the first three property values and stores the user properties;
-    // the other data members are set to zero or empty
-    Cell(const Array& prop) : _r(prop[0], prop[1], prop[2]), _properties{prop} {}
+    // constructor derives the site position from the first three property values and stores the storage index
+    // of the user properties; the other data members are set to zero or empty
+    Cell(const Array& prop, int index) : _r(prop[0], prop[1], prop[2]), _index(index) {}
 
     // adjusts the site position with the specified offset
     void relax(double cx, double cy, double cz) { _r += Vec(cx, cy, cz); }
@@ -142,9 +142,6 @@ public:
     // returns the x coordinate of the cell's site position
     double x() const { return _r.x(); }
 
-    // returns the squared distance from the cell's site to the specified point
-    double squaredDistanceTo(Vec r) const { return (r - _r).norm2(); }
-
     // returns the central position in the cell
     Vec centroid() const { return _c; }
 
@@ -154,8 +151,11 @@ public:
     // returns a list of neighboring cell/site ids
     const vector<int>& neighbors() { return _neighbors; }
 
-    // returns the cell/site user properties, if any
-    const Array& properties() { return _properties; }
+    // releases the memory occupied by the list of neighboring cell/site ids
+    void releaseNeighbors() { vector<int>().swap(_neighbors); }
+
+    // returns the storage index of the cell/site user properties, or -1 if there are none
+    int index() const { return _index; }
 
     // writes the Voronoi cell geometry to the serialized data buffer, preceded by the specified cell index,
     // if the cell geometry has been calculated for this cell; otherwise does nothing
@@ -219,119 +219,16 @@ namespace
 
 ////////////////////////////////////////////////////////////////////
 
-// class to hold a node in the binary search tree (see en.wikipedia.org/wiki/Kd-tree)
-class VoronoiMeshSnapshot::Node
+namespace
 {
-private:
-    int _m;        // index in _cells to the site defining the split at this node
-    int _axis;     // split axis for this node (0,1,2)
-    Node* _up;     // ptr to the parent node
-    Node* _left;   // ptr to the left child node
-    Node* _right;  // ptr to the right child node
-
-    // returns the square of its argument
-    static double sqr(double x) { return x * x; }
-
-public:
-    // constructor stores the specified site index and child pointers (which may be null)
-    Node(int m, int depth, Node* left, Node* right) : _m(m), _axis(depth % 3), _up(0), _left(left), _right(right)
-    {
-        if (_left) _left->setParent(this);
-        if (_right) _right->setParent(this);
-    }
-
-    // destructor destroys the children
-    ~Node()
-    {
-        delete _left;
-        delete _right;
-    }
-
-    // sets parent pointer (called from parent's constructor)
-    void setParent(Node* up) { _up = up; }
-
-    // returns the corresponding data member
-    int m() const { return _m; }
-    Node* up() const { return _up; }
-    Node* left() const { return _left; }
-    Node* right() const { return _right; }
-
-    // returns the apropriate child for the specified query point
-    Node* child(Vec bfr, const vector<Cell*>& cells) const
-    {
-        return lessthan(bfr, cells[_m]->position(), _axis) ? _left : _right;
-    }
-
-    // returns the other child than the one that would be apropriate for the specified query point
-    Node* otherChild(Vec bfr, const vector<Cell*>& cells) const
-    {
-        return lessthan(bfr, cells[_m]->position(), _axis) ? _right : _left;
-    }
-
-    // returns the squared distance from the query point to the split plane
-    double squaredDistanceToSplitPlane(Vec bfr, const vector<Cell*>& cells) const
-    {
-        switch (_axis)
-        {
-            case 0:  // split on x
-                return sqr(cells[_m]->position().x() - bfr.x());
-            case 1:  // split on y
-                return sqr(cells[_m]->position().y() - bfr.y());
-            case 2:  // split on z
-                return sqr(cells[_m]->position().z() - bfr.z());
-            default:  // this should never happen
-                return 0;
-        }
-    }
-
-    // returns the node in this subtree that represents the site nearest to the query point
-    Node* nearest(Vec bfr, const vector<Cell*>& cells)
-    {
-        // recursively descend the tree until a leaf node is reached, going left or right depending on
-        // whether the specified point is less than or greater than the current node in the split dimension
-        Node* current = this;
-        while (Node* child = current->child(bfr, cells)) current = child;
-
-        // unwind the recursion, looking for the nearest node while climbing up
-        Node* best = current;
-        double bestSD = cells[best->m()]->squaredDistanceTo(bfr);
-        while (true)
-        {
-            // if the current node is closer than the current best, then it becomes the current best
-            double currentSD = cells[current->m()]->squaredDistanceTo(bfr);
-            if (currentSD < bestSD)
-            {
-                best = current;
-                bestSD = currentSD;
-            }
-
-            // if there could be points on the other side of the splitting plane for the current node
-            // that are closer to the search point than the current best, then ...
-            double splitSD = current->squaredDistanceToSplitPlane(bfr, cells);
-            if (splitSD < bestSD)
-            {
-                // move down the other branch of the tree from the current node looking for closer points,
-                // following the same recursive process as the entire search
-                Node* other = current->otherChild(bfr, cells);
-                if (other)
-                {
-                    Node* otherBest = other->nearest(bfr, cells);
-                    double otherBestSD = cells[otherBest->m()]->squaredDistanceTo(bfr);
-                    if (otherBestSD < bestSD)
-                    {
-                        best = otherBest;
-                        bestSD = otherBestSD;
-                    }
-                }
-            }
+    // the most recently located or sampled cell for each parallel execution thread, which serves as a starting point
+    // for locating nearby points; the snapshot is remembered as well because there may be multiple snapshots
+    thread_local const VoronoiMeshSnapshot* t_hintSnapshot{nullptr};
+    thread_local int t_hintCell{0};
 
-            // move up to the parent until we meet the top node
-            if (current == this) break;
-            current = current->up();
-        }
-        return best;
-    }
-};
+    // blocks with at least this number of cells are searched through an implicit binary search tree
+    const size_t minCellsForTree = 10;
+}
 
 ////////////////////////////////////////////////////////////////////
 
@@ -342,7 +239,6 @@ VoronoiMeshSnapshot::VoronoiMeshSnapshot() {}
 VoronoiMeshSnapshot::~VoronoiMeshSnapshot()
 {
     for (auto cell : _cells) delete cell;
-    for (auto tree : _blocktrees) delete tree;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -351,10 +247,15 @@ void VoronoiMeshSnapshot::readAndClose()
 {
     // read the site info into memory
     Array prop;
-    while (infile()->readRow(prop)) _cells.push_back(new Cell(prop));
+    while (infile()->readRow(prop))
+    {
+        _cells.push_back(new Cell(prop, numStoredEntities()));
+        storeProperties(prop);
+    }
 
     // close the file
     Snapshot::readAndClose();
+    finishStoringProperties();
 
     // calculate the Voronoi cells
     buildMesh(false);
@@ -379,17 +280,17 @@ void VoronoiMeshSnapshot::readAndClose()
         int numIgnored = 0;
         for (size_t m = 0; m != n; ++m)
         {
-            const Array& prop = _cells[m]->properties();
+            int p = _cells[m]->index();
 
             // original mass is zero if temperature is above cutoff or if imported mass/density is not positive
             double originalMass = 0.;
-            if (maxT && prop[temperatureIndex()] > maxT)
+            if (maxT && property(p, temperatureIndex()) > maxT)
                 numIgnored++;
             else
-                originalMass =
-                    max(0., massIndex() >= 0 ? prop[massIndex()] : prop[densityIndex()] * _cells[m]->volume());
+                originalMass = max(0., massIndex() >= 0 ? property(p, massIndex())
+                                                         : property(p, densityIndex()) * _cells[m]->volume());
 
-            double metallicMass = originalMass * (metallicityIndex() >= 0 ? prop[metallicityIndex()] : 1.);
+            double metallicMass = originalMass * (metallicityIndex() >= 0 ? property(p, metallicityIndex()) : 1.);
             double effectiveMass = metallicMass * multiplier();
 
             Mv[m] = effectiveMass;
@@ -660,14 +561,30 @@ void VoronoiMeshSnapshot::buildMesh(bool relax)
         ProcessManager::broadcastAllToAll(producer, consumer);
     }
 
+    // copy the site positions and the neighbor lists into compact arrays, releasing the lists in the cell objects
+    _sitev.resize(numCells);
+    _firstNeighborv.resize(numCells + 1);
+    _firstNeighborv[0] = 0;
+    for (int m = 0; m != numCells; ++m)
+    {
+        _sitev[m] = _cells[m]->position();
+        _firstNeighborv[m + 1] = _firstNeighborv[m] + _cells[m]->neighbors().size();
+    }
+    _neighborv.resize(_firstNeighborv[numCells]);
+    for (int m = 0; m != numCells; ++m)
+    {
+        const vector<int>& neighbors = _cells[m]->neighbors();
+        std::copy(neighbors.begin(), neighbors.end(), _neighborv.begin() + _firstNeighborv[m]);
+        _cells[m]->releaseNeighbors();
+    }
+
     // compile neighbor statistics
     int minNeighbors = INT_MAX;
     int maxNeighbors = 0;
-    int64_t totNeighbors = 0;
+    int64_t totNeighbors = _neighborv.size();
     for (int m = 0; m < numCells; m++)
     {
-        int ns = _cells[m]->neighbors().size();
-        totNeighbors += ns;
+        int ns = _firstNeighborv[m + 1] - _firstNeighborv[m];
         minNeighbors = min(minNeighbors, ns);
         maxNeighbors = max(maxNeighbors, ns);
     }
@@ -682,20 +599,55 @@ void VoronoiMeshSnapshot::buildMesh(bool relax)
 
 ////////////////////////////////////////////////////////////////////
 
-VoronoiMeshSnapshot::Node* VoronoiMeshSnapshot::buildTree(vector<int>::iterator first, vector<int>::iterator last,
-                                                          int depth) const
+void VoronoiMeshSnapshot::buildTree(vector<int>::iterator first, vector<int>::iterator last, int depth) const
 {
     auto length = last - first;
-    if (length > 0)
+    if (length > 1)
     {
         auto median = length >> 1;
         std::nth_element(first, first + median, last, [this, depth](int m1, int m2) {
-            return m1 != m2 && lessthan(_cells[m1]->position(), _cells[m2]->position(), depth % 3);
+            return m1 != m2 && lessthan(_sitev[m1], _sitev[m2], depth % 3);
         });
-        return new VoronoiMeshSnapshot::Node(*(first + median), depth, buildTree(first, first + median, depth + 1),
-                                             buildTree(first + median + 1, last, depth + 1));
+        buildTree(first, first + median, depth + 1);
+        buildTree(first + median + 1, last, depth + 1);
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void VoronoiMeshSnapshot::searchTree(const int* first, const int* last, int depth, Vec bfr, int& best,
+                                     double& bestSD) const
+{
+    if (first == last) return;
+
+    // if the site at the root node is closer than the current best, then it becomes the current best
+    const int* median = first + ((last - first) >> 1);
+    Vec p = _sitev[*median];
+    double sd = (bfr - p).norm2();
+    if (sd < bestSD)
+    {
+        best = *median;
+        bestSD = sd;
+    }
+
+    // search the subtree on the same side of the splitting plane as the query point
+    int axis = depth % 3;
+    bool left = lessthan(bfr, p, axis);
+    if (left)
+        searchTree(first, median, depth + 1, bfr, best, bestSD);
+    else
+        searchTree(median + 1, last, depth + 1, bfr, best, bestSD);
+
+    // if there could be points on the other side of the splitting plane that are closer to the query point
+    // than the current best, then also search the other subtree
+    double split = axis == 0 ? p.x() - bfr.x() : (axis == 1 ? p.y() - bfr.y() : p.z() - bfr.z());
+    if (split * split < bestSD)
+    {
+        if (left)
+            searchTree(median + 1, last, depth + 1, bfr, best, bestSD);
+        else
+            searchTree(first, median, depth + 1, bfr, best, bestSD);
     }
-    return nullptr;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -710,28 +662,42 @@ void VoronoiMeshSnapshot::buildSearch()
 
     // -------------  block lists  -------------
 
-    // initialize a vector of nb x nb x nb lists, each containing the cells overlapping a certain block in the domain
-    _blocklists.resize(_nb3);
+    // determine the range of blocks that may overlap each cell
+    auto blockRange = [this](int m, int& i1, int& j1, int& k1, int& i2, int& j2, int& k2) {
+        _extent.cellIndices(i1, j1, k1, _cells[m]->rmin() - Vec(_eps, _eps, _eps), _nb, _nb, _nb);
+        _extent.cellIndices(i2, j2, k2, _cells[m]->rmax() + Vec(_eps, _eps, _eps), _nb, _nb, _nb);
+    };
 
-    // add the cell object to the lists for all blocks it may overlap
+    // count the number of cells possibly overlapping each block, and convert these counts to offsets
+    _firstBlockCellv.assign(_nb3 + 1, 0);
     int i1, j1, k1, i2, j2, k2;
     for (int m = 0; m != numCells; ++m)
     {
-        _extent.cellIndices(i1, j1, k1, _cells[m]->rmin() - Vec(_eps, _eps, _eps), _nb, _nb, _nb);
-        _extent.cellIndices(i2, j2, k2, _cells[m]->rmax() + Vec(_eps, _eps, _eps), _nb, _nb, _nb);
+        blockRange(m, i1, j1, k1, i2, j2, k2);
+        for (int i = i1; i <= i2; i++)
+            for (int j = j1; j <= j2; j++)
+                for (int k = k1; k <= k2; k++) _firstBlockCellv[i * _nb2 + j * _nb + k + 1]++;
+    }
+    for (int b = 0; b != _nb3; ++b) _firstBlockCellv[b + 1] += _firstBlockCellv[b];
+
+    // add the cell index to the lists for all blocks it may overlap
+    _blockCellv.resize(_firstBlockCellv[_nb3]);
+    vector<size_t> nextv(_firstBlockCellv.begin(), _firstBlockCellv.end() - 1);
+    for (int m = 0; m != numCells; ++m)
+    {
+        blockRange(m, i1, j1, k1, i2, j2, k2);
         for (int i = i1; i <= i2; i++)
             for (int j = j1; j <= j2; j++)
-                for (int k = k1; k <= k2; k++) _blocklists[i * _nb2 + j * _nb + k].push_back(m);
+                for (int k = k1; k <= k2; k++) _blockCellv[nextv[i * _nb2 + j * _nb + k]++] = m;
     }
 
     // compile block list statistics
     int minRefsPerBlock = INT_MAX;
     int maxRefsPerBlock = 0;
-    int64_t totalBlockRefs = 0;
+    int64_t totalBlockRefs = _blockCellv.size();
     for (int b = 0; b < _nb3; b++)
     {
-        int refs = _blocklists[b].size();
-        totalBlockRefs += refs;
+        int refs = _firstBlockCellv[b + 1] - _firstBlockCellv[b];
         minRefsPerBlock = min(minRefsPerBlock, refs);
         maxRefsPerBlock = max(maxRefsPerBlock, refs);
     }
@@ -746,36 +712,106 @@ void VoronoiMeshSnapshot::buildSearch()
     // -------------  search trees  -------------
 
     // for each block that contains more than a predefined number of cells,
-    // construct a search tree on the site locations of the cells
-    _blocktrees.resize(_nb3);
+    // reorder the block list so that it represents a search tree on the site locations of the cells
+    int numTrees = 0;
     for (int b = 0; b < _nb3; b++)
     {
-        vector<int>& ids = _blocklists[b];
-        if (ids.size() > 9) _blocktrees[b] = buildTree(ids.begin(), ids.end(), 0);
+        if (_firstBlockCellv[b + 1] - _firstBlockCellv[b] >= minCellsForTree)
+        {
+            buildTree(_blockCellv.begin() + _firstBlockCellv[b], _blockCellv.begin() + _firstBlockCellv[b + 1], 0);
+            numTrees++;
+        }
     }
 
-    // compile and log search tree statistics
-    int numTrees = 0;
-    for (int b = 0; b < _nb3; b++)
-        if (_blocktrees[b]) numTrees++;
+    // log search tree statistics
     log()->info("  Number of search trees: " + std::to_string(numTrees) + " ("
                 + StringUtils::toString(100. * numTrees / _nb3, 'f', 1) + "% of blocks)");
 }
 
 ////////////////////////////////////////////////////////////////////
 
-bool VoronoiMeshSnapshot::isPointClosestTo(Vec r, int m, const vector<int>& ids) const
+bool VoronoiMeshSnapshot::isPointClosestTo(Vec r, int m) const
 {
-    double target = _cells[m]->squaredDistanceTo(r);
-    for (int id : ids)
+    double target = (r - _sitev[m]).norm2();
+    for (size_t i = _firstNeighborv[m]; i != _firstNeighborv[m + 1]; ++i)
     {
-        if (id >= 0 && _cells[id]->squaredDistanceTo(r) < target) return false;
+        int id = _neighborv[i];
+        if (id >= 0 && (r - _sitev[id]).norm2() < target) return false;
     }
     return true;
 }
 
 ////////////////////////////////////////////////////////////////////
 
+void VoronoiMeshSnapshot::storeFacePlanes()
+{
+    // do nothing if the planes have already been stored or if there are no cells
+    if (!_planev.empty() || _neighborv.empty()) return;
+
+    log()->info("Storing face planes for Voronoi tessellation with " + std::to_string(_neighborv.size()) + " faces");
+    _planev.resize(4 * _neighborv.size());
+    log()->info("  Allocated " + StringUtils::toMemSizeString(_planev.size() * sizeof(double)) + " of memory");
+
+    int numCells = _sitev.size();
+    for (int m = 0; m != numCells; ++m)
+    {
+        Vec pr = _sitev[m];
+        for (size_t i = _firstNeighborv[m]; i != _firstNeighborv[m + 1]; ++i)
+        {
+            int mi = _neighborv[i];
+
+            // determine the (unnormalized) normal pointing outward from the cell and a point on the plane
+            Vec n, p;
+            if (mi >= 0)
+            {
+                Vec pi = _sitev[mi];
+                n = pi - pr;
+                p = 0.5 * (pi + pr);
+            }
+            else
+            {
+                switch (mi)
+                {
+                    case -1:
+                        n = Vec(-1., 0., 0.);
+                        p = Vec(_extent.xmin(), 0., 0.);
+                        break;
+                    case -2:
+                        n = Vec(1., 0., 0.);
+                        p = Vec(_extent.xmax(), 0., 0.);
+                        break;
+                    case -3:
+                        n = Vec(0., -1., 0.);
+                        p = Vec(0., _extent.ymin(), 0.);
+                        break;
+                    case -4:
+                        n = Vec(0., 1., 0.);
+                        p = Vec(0., _extent.ymax(), 0.);
+                        break;
+                    case -5:
+                        n = Vec(0., 0., -1.);
+                        p = Vec(0., 0., _extent.zmin());
+                        break;
+                    case -6:
+                        n = Vec(0., 0., 1.);
+                        p = Vec(0., 0., _extent.zmax());
+                        break;
+                    default: throw FATALERROR("Invalid neighbor ID");
+                }
+            }
+
+            // store the normal and the offset of the plane
+            double* plane = &_planev[4 * i];
+            plane[0] = n.x();
+            plane[1] = n.y();
+            plane[2] = n.z();
+            plane[3] = Vec::dot(n, p);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
 void VoronoiMeshSnapshot::writeGridPlotFiles(const SimulationItem* probe) const
 {
     // create the plot files
@@ -873,8 +909,8 @@ Box VoronoiMeshSnapshot::extent(int m) const
 
 Vec VoronoiMeshSnapshot::velocity(int m) const
 {
-    const Array& prop = _cells[m]->properties();
-    return Vec(prop[velocityIndex() + 0], prop[velocityIndex() + 1], prop[velocityIndex() + 2]);
+    int p = _cells[m]->index();
+    return Vec(property(p, velocityIndex() + 0), property(p, velocityIndex() + 1), property(p, velocityIndex() + 2));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -889,8 +925,8 @@ Vec VoronoiMeshSnapshot::velocity(Position bfr) const
 
 double VoronoiMeshSnapshot::velocityDispersion(int m) const
 {
-    const Array& prop = _cells[m]->properties();
-    return prop[velocityDispersionIndex()];
+    int p = _cells[m]->index();
+    return property(p, velocityDispersionIndex());
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -905,8 +941,9 @@ double VoronoiMeshSnapshot::velocityDispersion(Position bfr) const
 
 Vec VoronoiMeshSnapshot::magneticField(int m) const
 {
-    const Array& prop = _cells[m]->properties();
-    return Vec(prop[magneticFieldIndex() + 0], prop[magneticFieldIndex() + 1], prop[magneticFieldIndex() + 2]);
+    int p = _cells[m]->index();
+    return Vec(property(p, magneticFieldIndex() + 0), property(p, magneticFieldIndex() + 1),
+               property(p, magneticFieldIndex() + 2));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -923,8 +960,8 @@ void VoronoiMeshSnapshot::parameters(int m, Array& params) const
 {
     int n = numParameters();
     params.resize(n);
-    const Array& prop = _cells[m]->properties();
-    for (int i = 0; i != n; ++i) params[i] = prop[parametersIndex() + i];
+    int p = _cells[m]->index();
+    for (int i = 0; i != n; ++i) params[i] = property(p, parametersIndex() + i);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -966,13 +1003,18 @@ Position VoronoiMeshSnapshot::generatePosition(int m) const
 {
     // get loop-invariant information about the cell
     const Box& box = _cells[m]->extent();
-    const vector<int>& neighbors = _cells[m]->neighbors();
 
     // generate random points in the enclosing box until one happens to be inside the cell
     for (int i = 0; i < 10000; i++)
     {
         Position r = random()->position(box);
-        if (isPointClosestTo(r, m, neighbors)) return r;
+        if (isPointClosestTo(r, m))
+        {
+            // remember the cell as a starting point for locating the generated position
+            t_hintSnapshot = this;
+            t_hintCell = m;
+            return r;
+        }
     }
     throw FATALERROR("Can't find random position in cell");
 }
@@ -997,34 +1039,85 @@ int VoronoiMeshSnapshot::cellIndex(Position bfr) const
     // make sure the position is inside the domain
     if (!_extent.contains(bfr)) return -1;
 
-    // determine the block in which the point falls
-    int i, j, k;
-    _extent.cellIndices(i, j, k, bfr, _nb, _nb, _nb);
-    int b = i * _nb2 + j * _nb + k;
-
-    // look for the closest site in this block, using the search tree if there is one
-    Node* tree = _blocktrees[b];
-    if (tree) return tree->nearest(bfr, _cells)->m();
-
-    // if there is no search tree, simply loop over the index list
-    const vector<int>& ids = _blocklists[b];
+    // if the point lies in the bounding box of the cell most recently handled by this thread, walk from that cell
     int m = -1;
-    double mdist = DBL_MAX;
-    int n = ids.size();
-    for (int i = 0; i < n; i++)
+    if (t_hintSnapshot == this && t_hintCell < numEntities() && _cells[t_hintCell]->contains(bfr))
+    {
+        m = cellIndex(bfr, t_hintCell);
+    }
+    else
     {
-        double idist = _cells[ids[i]]->squaredDistanceTo(bfr);
-        if (idist < mdist)
+        // determine the block in which the point falls
+        int i, j, k;
+        _extent.cellIndices(i, j, k, bfr, _nb, _nb, _nb);
+        int b = i * _nb2 + j * _nb + k;
+        const int* first = _blockCellv.data() + _firstBlockCellv[b];
+        const int* last = _blockCellv.data() + _firstBlockCellv[b + 1];
+
+        // look for the closest site in this block, using the search tree if there is one
+        double mdist = DBL_MAX;
+        if (static_cast<size_t>(last - first) >= minCellsForTree)
+        {
+            searchTree(first, last, 0, bfr, m, mdist);
+        }
+
+        // if there is no search tree, simply loop over the index list
+        else
         {
-            m = ids[i];
-            mdist = idist;
+            for (const int* id = first; id != last; ++id)
+            {
+                double idist = (bfr - _sitev[*id]).norm2();
+                if (idist < mdist)
+                {
+                    m = *id;
+                    mdist = idist;
+                }
+            }
         }
     }
+
+    // remember the cell as a starting point for locating the next point
+    if (m >= 0)
+    {
+        t_hintSnapshot = this;
+        t_hintCell = m;
+    }
     return m;
 }
 
 ////////////////////////////////////////////////////////////////////
 
+int VoronoiMeshSnapshot::cellIndex(Position bfr, int hint) const
+{
+    // make sure the position is inside the domain
+    if (!_extent.contains(bfr)) return -1;
+
+    // move to the nearest neighbor that is closer to the point than the current cell until there is none
+    int m = hint;
+    double mdist = (bfr - _sitev[m]).norm2();
+    while (true)
+    {
+        int next = m;
+        for (size_t i = _firstNeighborv[m]; i != _firstNeighborv[m + 1]; ++i)
+        {
+            int id = _neighborv[i];
+            if (id >= 0)
+            {
+                double idist = (bfr - _sitev[id]).norm2();
+                if (idist < mdist)
+                {
+                    next = id;
+                    mdist = idist;
+                }
+            }
+        }
+        if (next == m) return m;
+        m = next;
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
 void VoronoiMeshSnapshot::path(SpatialGridPath* path) const
 {
     // Initialize the path
@@ -1038,11 +1131,14 @@ void VoronoiMeshSnapshot::path(SpatialGridPath* path) const
     int mr = cellIndex(r);
     if (mr < 0) return path->clear();
 
+    // Determine whether the face planes have been precomputed
+    bool hasPlanes = !_planev.empty();
+
     // Start the loop over cells/path segments until we leave the grid
     while (mr >= 0)
     {
         // get the site position for this cell
-        Vec pr = _cells[mr]->position();
+        Vec pr = _sitev[mr];
 
         // initialize the smallest nonnegative intersection distance and corresponding index
         double sq = DBL_MAX;       // very large, but not infinity (so that infinite si values are discarded)
@@ -1050,20 +1146,31 @@ void VoronoiMeshSnapshot::path(SpatialGridPath* path) const
         int mq = NO_INDEX;
 
         // loop over the list of neighbor indices
-        const vector<int>& mv = _cells[mr]->neighbors();
-        int n = mv.size();
-        for (int i = 0; i < n; i++)
+        size_t last = _firstNeighborv[mr + 1];
+        for (size_t i = _firstNeighborv[mr]; i != last; ++i)
         {
-            int mi = mv[i];
+            int mi = _neighborv[i];
 
             // declare the intersection distance for this neighbor (init to a value that will be rejected)
             double si = 0;
 
+            // --- intersection with precomputed plane for neighboring cell or domain wall
+            if (hasPlanes)
+            {
+                const double* plane = &_planev[4 * i];
+
+                // calculate the denominator of the intersection quotient
+                double ndotk = plane[0] * bfk.x() + plane[1] * bfk.y() + plane[2] * bfk.z();
+
+                // if the denominator is negative the intersection distance is negative, so don't calculate it
+                if (ndotk > 0) si = (plane[3] - plane[0] * r.x() - plane[1] * r.y() - plane[2] * r.z()) / ndotk;
+            }
+
             // --- intersection with neighboring cell
-            if (mi >= 0)
+            else if (mi >= 0)
             {
                 // get the site position for this neighbor
-                Vec pi = _cells[mi]->position();
+                Vec pi = _sitev[mi];
 
                 // calculate the (unnormalized) normal on the bisecting plane
                 Vec n = pi - pr;
@@ -1109,7 +1216,7 @@ void VoronoiMeshSnapshot::path(SpatialGridPath* path) const
         if (mq == NO_INDEX)
         {
             r += bfk * _eps;
-            mr = cellIndex(r);
+            mr = cellIndex(r, mr);
         }
         // otherwise add a path segment and set the current point to the exit point
         else
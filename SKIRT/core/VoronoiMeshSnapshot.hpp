@@ -138,10 +138,6 @@ private:
         paths and densities; see the buildMesh() function. */
     class Cell;
 
-    /** Private class to hold a node in the internal binary search tree; see the buildTree()
-        and buildSearch() functions. */
-    class Node;
-
     /** Given a list of generating sites (represented as partially initialized Cell
         objects), this private function builds the Voronoi tessellation and stores the
         corresponding cell information, including any properties relevant for supporting the
@@ -162,12 +158,31 @@ private:
         by the centroid (mass center) of the corresponding cell. The final tessellation is then
         constructed with these adjusted site positions, which are distributed more uniformly,
         thereby avoiding overly elongated cells in the Voronoi tessellation. Relaxation can be
-        quite time-consuming because the Voronoi tessellation must be constructed twice. */
+        quite time-consuming because the Voronoi tessellation must be constructed twice.
+
+        Once the tessellation has been constructed, the function copies the site positions into a
+        contiguous array, and the neighbor lists of all cells into a single array in compressed
+        sparse row format (i.e. a list of neighbor indices for all cells plus an offset into that
+        list for each cell). The neighbor lists held by the individual Cell objects are then
+        released. This compact representation avoids the memory overhead of a separate heap
+        allocation per cell and causes the path() function to access just a few contiguous cache
+        lines per cell. */
     void buildMesh(bool relax);
 
-    /** Private function to recursively build a binary search tree (see
-        en.wikipedia.org/wiki/Kd-tree) */
-    Node* buildTree(vector<int>::iterator first, vector<int>::iterator last, int depth) const;
+    /** Private function to recursively reorder the specified range of cell indices so that it
+        represents an implicit binary search tree on the corresponding site positions (see
+        en.wikipedia.org/wiki/Kd-tree). The root node of the tree for a given range is the median
+        element of the range, i.e. the element with index \f$N/2\f$ (rounded down) where \f$N\f$
+        is the number of elements in the range. The elements before and after the median form the
+        left and right subtrees, respectively, which are organized in the same way. The split axis
+        cycles through x, y and z with increasing depth. */
+    void buildTree(vector<int>::iterator first, vector<int>::iterator last, int depth) const;
+
+    /** Private function to recursively search the implicit binary search tree represented by the
+        specified range of cell indices (see the buildTree() function) for the site nearest to the
+        given point. If a site nearer than the specified best squared distance is found, the
+        function updates the best cell index and the corresponding squared distance. */
+    void searchTree(const int* first, const int* last, int depth, Vec bfr, int& best, double& bestSD) const;
 
     /** This private function builds data structures that allow accelerating the operation of the
         cellIndex() function.
@@ -179,16 +194,35 @@ private:
         trivial since the grid is linear). The current implementation uses a Voronoi cell's
         enclosing cuboid to test for intersection with a block. Performing a precise intersection
         test is \em really slow and the shortened block lists don't substantially accelerate the
-        cellIndex() function.
+        cellIndex() function. The lists for all blocks are stored consecutively in a single array,
+        with an offset into that array for each block.
 
         To further reduce the search time within blocks that overlap with a large number of cells,
-        the function builds a binary search tree on the cell sites for those blocks (see for example
-        <a href="http://en.wikipedia.org/wiki/Kd-tree">en.wikipedia.org/wiki/Kd-tree</a>). */
+        the function reorders the list for those blocks so that it represents an implicit binary
+        search tree on the cell sites (see for example <a
+        href="http://en.wikipedia.org/wiki/Kd-tree">en.wikipedia.org/wiki/Kd-tree</a>). Because
+        the tree is implicit, it requires no memory beyond the block list itself, and searching the
+        tree accesses a contiguous range of memory. */
     void buildSearch();
 
     /** This private function returns true if the given point is closer to the site with index m
-        than to the sites with indices ids. */
-    bool isPointClosestTo(Vec r, int m, const vector<int>& ids) const;
+        than to the sites of all neighbors of cell m. */
+    bool isPointClosestTo(Vec r, int m) const;
+
+    //=========== Path construction acceleration ==========
+
+public:
+    /** This function calculates and stores the normal and the offset of the plane corresponding
+        to each face of each cell in the mesh, i.e. the plane bisecting the sites of the cell and
+        of the neighbor across the face, or the domain wall. The path() function then uses these
+        precomputed values instead of deriving the plane from the site positions of the cell and
+        the neighbor for each face it considers. This substantially reduces the amount of memory
+        accessed while constructing a path, at the cost of storing four extra double values for
+        each face, which is more than the memory consumed by the mesh itself. Hence the client
+        should call this function only if sufficient memory is available. The function should be
+        called after construction has completed but before the path() function is invoked for the
+        first time; calling it more than once has no further effect. */
+    void storeFacePlanes();
 
     //====================== Output =====================
 
@@ -305,20 +339,44 @@ public:
         returns -1. By definition of a Voronoi tesselation, the closest site position determines
         the Voronoi cell containing the specified point.
 
-        The function uses the search data structures created by the private BuildSearch() function
-        to accelerate its operation. It computes the appropriate block index from the coordinates
-        of the specified point, which provides a list of Voronoi cells possibly overlapping the
-        point. If there is a search tree for this block, the function uses it to locate the nearest
-        point in \f${\cal{O}}(\log N)\f$ time. Otherwise it calculates the distance from the
-        specified point to the site positions for each of the possibly overlapping cells,
-        determining the nearest one in linear time. For a small number of cells this is more
-        efficient than using the search tree.
+        Each execution thread remembers the cell most recently located by this function or sampled
+        by the generatePosition(int) function. If the specified point lies within the bounding box
+        of that cell, the function locates the point by walking the neighbor graph starting from
+        that cell, as described for the cellIndex(Position, int) function. Because the walk
+        usually ends after inspecting the neighbors of just one or two cells, successive queries
+        for nearby points (such as multiple density samples within the same cell, or the launch
+        position of a photon packet emitted from a given cell) are resolved in nearly constant
+        time.
+
+        Otherwise, the function uses the search data structures created by the private
+        BuildSearch() function to accelerate its operation. It computes the appropriate block
+        index from the coordinates of the specified point, which provides a list of Voronoi cells
+        possibly overlapping the point. If this list represents a search tree, the function uses
+        it to locate the nearest point in \f${\cal{O}}(\log N)\f$ time. Otherwise it calculates
+        the distance from the specified point to the site positions for each of the possibly
+        overlapping cells, determining the nearest one in linear time. For a small number of cells
+        this is more efficient than using the search tree.
 
         If the search data structures were not created during construction (which happens when
         using the default constructor without configuring a mass density policy), invoking the
         cellIndex() function causes undefined behavior. */
     int cellIndex(Position bfr) const;
 
+    /** This function returns the cell index \f$0\le m \le N_{cells}-1\f$ for the cell containing
+        the specified point \f${\bf{r}}\f$, starting the search from the cell with the specified
+        index \f$m_h\f$, which should preferably be located near the point. If the point is
+        outside the domain, the function returns -1. If the hint index is out of range, the
+        behavior is undefined.
+
+        The function walks the neighbor graph of the mesh: as long as one of the neighbors of the
+        current cell has a site that is closer to the specified point than the site of the current
+        cell, it moves to the nearest such neighbor. When none of the neighbors is closer, the
+        current cell contains the point. Indeed, if the site of the current cell is not the nearest
+        one, the line segment from that site to the point must cross a face of the cell, and the
+        site of the neighbor across that face is closer to the point. The number of steps is
+        proportional to the distance between the hint cell and the point, measured in cells. */
+    int cellIndex(Position bfr, int hint) const;
+
     //====================== Path construction =====================
 
 public:
@@ -392,7 +450,10 @@ public:
         \f[s_i=\frac{\mathbf{n}\cdot(\mathbf{p}-\mathbf{r})}{\mathbf{n}\cdot\mathbf{k}}.\f]
         If \f$\mathbf{n}\cdot\mathbf{k}=0\f$ the line and the plane are parallel and there
         is no intersection. In that case no \f$s_i\f$ is added to the set of candidate
-        exit points.
+        exit points. If the face planes have been precomputed by the storeFacePlanes() function,
+        the normal \f$\mathbf{n}\f$ and the offset \f$d=\mathbf{n}\cdot\mathbf{p}\f$ are
+        simply retrieved, and the intersection distance is calculated as
+        \f$s_i=(d-\mathbf{n}\cdot\mathbf{r})/(\mathbf{n}\cdot\mathbf{k})\f$.
 
         To calculate \f$s_i\f$ for a wall \f$m_i<0\f$, substitute the appropriate normal and
         position vectors for the wall plane in this last formula. For example, for the left wall
@@ -411,6 +472,14 @@ private:
     // data members initialized when processing snapshot input and further completed by BuildMesh()
     vector<Cell*> _cells;  // cell objects, indexed on m
 
+    // data members initialized by BuildMesh() after constructing the tessellation
+    vector<Vec> _sitev;              // site position for each cell, indexed on m
+    vector<size_t> _firstNeighborv;  // index in _neighborv of first neighbor for each cell, indexed on m (size N+1)
+    vector<int> _neighborv;          // neighbor cell indices or domain wall IDs for all cells, in order of cell index
+
+    // data members initialized by storeFacePlanes(), if it is called
+    vector<double> _planev;  // normal (x,y,z) and offset for each face, indexed on 4*i with i the index in _neighborv
+
     // data members initialized when processing snapshot input, but only if a density policy has been set
     Array _rhov;       // density for each cell (not normalized)
     Array _cumrhov;    // normalized cumulative density distribution for cells
@@ -420,8 +489,8 @@ private:
     int _nb{0};                       // number of blocks in each dimension (limit for indices i,j,k)
     int _nb2{0};                      // nb*nb
     int _nb3{0};                      // nb*nb*nb
-    vector<vector<int>> _blocklists;  // list of cell indices per block, indexed on i*_nb2+j*_nb+k
-    vector<Node*> _blocktrees;        // root node of search tree or null for each block, indexed on i*_nb2+j*_nb+k
+    vector<size_t> _firstBlockCellv;  // index in _blockCellv of first cell for each block, indexed on b (size nb3+1)
+    vector<int> _blockCellv;          // cell indices for all blocks, in order of block index b=i*_nb2+j*_nb+k
 };
 
 ////////////////////////////////////////////////////////////////////
@@ -141,6 +141,9 @@ void VoronoiMeshSpatialGrid::setupSelfBefore()
             break;
         }
     }
+
+    // if requested, precompute the face planes to accelerate path calculation
+    if (_storeFacePlanes) _mesh->storeFacePlanes();
 }
 
 //////////////////////////////////////////////////////////////////////
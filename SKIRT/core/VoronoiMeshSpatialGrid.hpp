@@ -22,7 +22,12 @@ class VoronoiMeshSnapshot;
     the positions can be copied from the sites in the imported distribution(s).
 
     Furthermore, the user can opt to perform a relaxation step on the site positions to avoid
-    overly elongated cells. */
+    overly elongated cells.
+
+    Finally, the user can request to precompute and store the plane corresponding to each face of
+    each Voronoi cell. This accelerates the calculation of paths through the grid, but consumes an
+    amount of memory that is substantially larger than the memory needed for the mesh itself. See
+    the VoronoiMeshSnapshot::storeFacePlanes() function for more information. */
 class VoronoiMeshSpatialGrid : public BoxSpatialGrid, public DensityInCellInterface
 {
     /** The enumeration type indicating the policy for determining the positions of the sites. */
@@ -56,6 +61,10 @@ class VoronoiMeshSpatialGrid : public BoxSpatialGrid, public DensityInCellInterf
         ATTRIBUTE_DEFAULT_VALUE(relaxSites, "false")
         ATTRIBUTE_RELEVANT_IF(relaxSites, "!policyImportedMesh")
 
+        PROPERTY_BOOL(storeFacePlanes, "precompute and store the cell face planes to accelerate path calculation")
+        ATTRIBUTE_DEFAULT_VALUE(storeFacePlanes, "false")
+        ATTRIBUTE_DISPLAYED_IF(storeFacePlanes, "Level3")
+
     ITEM_END()
 
     //============= Construction - Setup - Destruction =============
@@ -68,7 +77,8 @@ protected:
     /** This function verifies that the attributes have been appropriately set, generates or
         retrieves the site positions for constructing the Voronoi tessellation according to the
         configured policy, and finally constructs the Voronoi tessellation through an instance of
-        the VoronoiMeshSnapshot class. */
+        the VoronoiMeshSnapshot class. If so requested, it also asks the mesh to store the face
+        planes. */
     void setupSelfBefore() override;
 
     //======================== Other Functions =======================
@@ -19,6 +19,7 @@
 #include "StopWatch.hpp"
 #include "StringUtils.hpp"
 #include "System.hpp"
+#include "TextInFile.hpp"
 #include "TimeLogger.hpp"
 #include "XmlHierarchyCreator.hpp"
 #include "XmlHierarchyWriter.hpp"
@@ -28,7 +29,7 @@
 namespace
 {
     // the allowed options list, in the format consumed by the CommandLineArguments constructor
-    static const char* allowedOptions = "-t* -s* -d -b -v -m -e -k -i* -o* -r -x";
+    static const char* allowedOptions = "-t* -s* -d -w* -z* -p -u -b -v -m -e -k -i* -o* -r -c -x";
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -51,10 +52,12 @@ int SkirtCommandLineHandler::perform()
     try
     {
         // if there are no arguments at all --> interactive mode
+        // if the -c option is present with at least one file path argument --> convert column text files
         // if there is at least one file path argument --> batch mode
         // if the -x option is present --> export smile schema (undocumented option)
         // otherwise --> error
         if (_args.isValid() && !_args.hasOptions() && !_args.hasFilepaths()) return doInteractive();
+        if (_args.isPresent("-c") && _args.hasFilepaths()) return doConvert();
         if (_args.hasFilepaths()) return doBatch();
         if (_args.isPresent("-x")) return doSmileSchema();
         _console.error("Invalid command line arguments");
@@ -191,6 +194,21 @@ int SkirtCommandLineHandler::doBatch()
 
 ////////////////////////////////////////////////////////////////////
 
+int SkirtCommandLineHandler::doConvert()
+{
+    for (string inpath : _args.filepaths())
+    {
+        string outpath =
+            StringUtils::joinPaths(StringUtils::dirPath(inpath), StringUtils::filenameBase(inpath) + ".scol");
+        _console.info("Converting column text file '" + inpath + "'...");
+        size_t numRows = TextInFile::writeBinary(inpath, outpath);
+        _console.info("Created binary column file '" + outpath + "' with " + std::to_string(numRows) + " rows");
+    }
+    return EXIT_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////
+
 int SkirtCommandLineHandler::doSmileSchema()
 {
     auto schema = SimulationItemRegistry::getSchemaDef();
@@ -294,11 +312,25 @@ void SkirtCommandLineHandler::doSimulation(size_t index)
         if (_args.intValue("-t") > 0) simulation->parallelFactory()->setMaxThreadCount(_args.intValue("-t"));
 
         //  - the activation of data parallelization
-        if (_args.isPresent("-d") && ProcessManager::isMultiProc())
+        if (_args.isPresent("-d") && ProcessManager::isMultiProc()) simulation->config()->setDataParallel();
+
+        //  - the output writer
+        if (_args.intValue("-w") >= 0) simulation->outputWriter()->setNumThreads(_args.intValue("-w"));
+        if (_args.isPresent("-z"))
         {
-            throw FATALERROR("Data parallelization (-d option) is not supported at this time");
+            string compression = StringUtils::toLower(_args.value("-z"));
+            if (compression == "gzip")
+                simulation->outputWriter()->setFITSCompression(FITSInOut::Compression::Gzip);
+            else if (compression == "rice")
+                simulation->outputWriter()->setFITSCompression(FITSInOut::Compression::Rice);
+            else if (compression != "none")
+                throw FATALERROR("Unknown FITS compression type: " + _args.value("-z"));
         }
 
+        //  - the checkpointing mechanism
+        if (_args.isPresent("-p")) simulation->config()->setCheckpointing();
+        if (_args.isPresent("-u")) simulation->config()->setRestart();
+
         //  - the logging mechanisms
         FileLog* log = new FileLog();
         simulation->log()->setLinkedLog(log);
@@ -391,13 +423,19 @@ void SkirtCommandLineHandler::printHelp()
     _console.warning("To run a simulation with default options:  skirt <ski-filename>");
     _console.warning("");
     _console.warning("  skirt [-t <threads>] [-s <simulations>] [-d]");
+    _console.warning("        [-w <threads>] [-z <compression>] [-p] [-u]");
     _console.warning("        [-b] [-v] [-m] [-e]");
     _console.warning("        [-k] [-i <dirpath>] [-o <dirpath>]");
     _console.warning("        [-r] {<filepath>}*");
+    _console.warning("  skirt -c {<filepath>}*");
     _console.warning("");
     _console.warning("  -t <threads> : the number of parallel threads for each simulation");
     _console.warning("  -s <simulations> : the number of parallel simulations per process");
     _console.warning("  -d : enable data parallelization mode for multiple processes");
+    _console.warning("  -w <threads> : the number of background threads for writing FITS output files");
+    _console.warning("  -z <compression> : the compression type for FITS output files (none, gzip or rice)");
+    _console.warning("  -p : write a checkpoint of the simulation state after each emission segment");
+    _console.warning("  -u : resume the simulation from the last checkpoint written with the -p option");
     _console.warning("  -b : force brief console logging");
     _console.warning("  -v : force verbose logging for multiple processes");
     _console.warning("  -m : state the amount of used memory at the start of each log message");
@@ -408,6 +446,7 @@ void SkirtCommandLineHandler::printHelp()
     _console.warning("  -r : cause recursive directory descent for all specified ski file paths");
     _console.warning("  <filepath> : the relative or absolute file path for a ski file");
     _console.warning("               (the filename may contain ? and * wildcards)");
+    _console.warning("  -c : convert the specified column text files to binary column files (.scol)");
     _console.warning("");
 }
 
@@ -21,6 +21,7 @@ simulations in the ski files specified on the command line according to the foll
 
 \verbatim
  skirt [-t <threads>] [-s <simulations>] [-d]
+       [-w <threads>] [-z <compression>] [-p] [-u]
        [-b] [-v] [-m] [-e]
        [-k] [-i <dirpath>] [-o <dirpath>]
        [-r] {<filepath>}*
@@ -31,7 +32,27 @@ simulations in the ski files specified on the command line according to the foll
 
 - The -s option specifies the number of simulations to be executed in parallel. The default value is one.
 
-- The -d option enables data parallelization mode for multiple processes.
+- The -d option enables data parallelization mode for multiple processes. In this mode, the radiation field is
+  partitioned over the processes rather than being replicated in each process, and each process launches secondary
+  photon packets only from the spatial cells it owns. Probes that output the radiation field or related quantities for
+  all spatial cells are not supported in this mode. The option has no effect if there is only a single process.
+
+- The -w option specifies the number of background threads for writing FITS output files, so that independent files
+  are written in parallel while the simulation continues producing output. A value of zero causes each file to be
+  written synchronously. The default value is the number of parallel threads for the simulation (see the -t option).
+
+- The -z option specifies the compression type for FITS output files: "none" (the default), "gzip" for lossless
+  tile compression, or "rice" for faster and more effective tile compression after quantizing the floating point
+  values. A compressed image is stored in the first extension of the FITS file rather than in the primary data unit.
+
+- The -p option causes the simulation to write a checkpoint of its state to the output directory after each emission
+  segment, i.e. after primary emission, after each dust self-absorption iteration, and after secondary emission. Each
+  process writes its own checkpoint file, replacing the checkpoint of the previous segment.
+
+- The -u option resumes the simulation from the last checkpoint written with the -p option to the output directory,
+  skipping the emission segments that had been completed, and implies the -p option. The simulation must be resumed
+  with the same configuration and number of processes, and it reproduces the results of an uninterrupted run only if
+  it uses the "Counter" random number streams.
 
 - The -b option forces brief console logging, i.e. only success and error messages are shown rather than all progress
   messages. If there are multiple parallel simulations (see the -s option), the -b option is turned on automatically
@@ -67,6 +88,18 @@ other words, if the filepath may match multiple files) the ".ski" filename exten
 Furthermore, filepaths containing wildcards should be enclosed in quotes on the command
 line to avoid expansion of the wildcard pattern by the shell.
 
+Alternatively, the -c option causes SKIRT to convert each of the column text files specified by
+the \<filepath\> arguments to the binary column format described for the TextInFile class,
+without performing any simulations:
+
+\verbatim
+ skirt -c {<filepath>}*
+\endverbatim
+
+The binary file is placed next to the text file, with the same name but the ".scol" filename
+extension. It can be specified in the ski file instead of the text file for any imported source
+or medium, allowing large snapshots to be read through a memory map rather than being parsed.
+
 For example, to process all "test" ski files inside the "geometry" directory hierarchy, one
 could specify:
 
@@ -96,6 +129,11 @@ private:
         returns an appropriate application exit value. */
     int doBatch();
 
+    /** This function converts each of the column text files specified on the command line to the
+        binary column format, placing the output next to the input file with the ".scol" filename
+        extension. The function returns an appropriate application exit value. */
+    int doConvert();
+
     /** This function exports a smile schema. This is an undocumented option. */
     int doSmileSchema();
 
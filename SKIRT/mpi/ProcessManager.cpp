@@ -10,6 +10,7 @@
 #ifdef BUILD_WITH_MPI
 #    include <mpi.h>
 #    include <chrono>
+#    include <list>
 #    include <thread>
 #endif
 
@@ -108,6 +109,59 @@ bool ProcessManager::requestChunk(size_t& firstIndex, size_t& numIndices)
 
 //////////////////////////////////////////////////////////////////////
 
+#ifdef BUILD_WITH_MPI
+namespace
+{
+    // The state of the outstanding asynchronous chunk request, if any; the buffers must remain valid
+    // until the request completes, and are only accessed from the main thread
+    bool pendingRequest = false;
+    std::array<MPI_Request, 2> pendingHandles;
+    std::array<int, 1> pendingSendbuf{{0}};
+    std::array<size_t, 2> pendingRecvbuf{{0, 0}};
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////
+
+void ProcessManager::postChunkRequest()
+{
+#ifdef BUILD_WITH_MPI
+    if (isRoot() || pendingRequest) throwInvalidChunkInvocation();
+
+    // post the receive before the send so that the response can be stored directly into our buffer
+    pendingSendbuf[0] = _rank;  // we pass our rank so that the receiver can ignore MPI status
+    pendingRecvbuf = {{0, 0}};
+    MPI_Irecv(pendingRecvbuf.begin(), pendingRecvbuf.size(), MPI_UNSIGNED_LONG, 0, 1, MPI_COMM_WORLD,
+              &pendingHandles[0]);
+    MPI_Isend(pendingSendbuf.begin(), pendingSendbuf.size(), MPI_INT, 0, 1, MPI_COMM_WORLD, &pendingHandles[1]);
+    pendingRequest = true;
+#else
+    throwInvalidChunkInvocation();
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool ProcessManager::completeChunkRequest(size_t& firstIndex, size_t& numIndices)
+{
+#ifdef BUILD_WITH_MPI
+    if (isRoot() || !pendingRequest) throwInvalidChunkInvocation();
+
+    MPI_Waitall(pendingHandles.size(), pendingHandles.begin(), MPI_STATUSES_IGNORE);
+    pendingRequest = false;
+    firstIndex = pendingRecvbuf[0];
+    numIndices = pendingRecvbuf[1];
+    return numIndices > 0;
+#else
+    (void)firstIndex;
+    (void)numIndices;
+    throwInvalidChunkInvocation();
+    return false;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+
 int ProcessManager::waitForChunkRequest()
 {
 #ifdef BUILD_WITH_MPI
@@ -150,6 +204,105 @@ void ProcessManager::serveChunkRequest(int rank, size_t firstIndex, size_t numIn
 
 //////////////////////////////////////////////////////////////////////
 
+#ifdef BUILD_WITH_MPI
+namespace
+{
+    // The tag used for point-to-point messages (chunk requests use tag 1)
+    const int messageTag = 2;
+
+    // The messages posted by this process that may not yet have been delivered, with their send requests;
+    // the buffers must remain valid until the send completes, and are only accessed from the main thread
+    std::list<std::pair<MPI_Request, vector<double>>> postedMessages;
+
+    // Releases the posted messages that have been delivered
+    void releaseDeliveredMessages()
+    {
+        for (auto message = postedMessages.begin(); message != postedMessages.end();)
+        {
+            int flag;
+            MPI_Test(&message->first, &flag, MPI_STATUS_IGNORE);
+            if (flag)
+                message = postedMessages.erase(message);
+            else
+                ++message;
+        }
+    }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    void throwInvalidMessageInvocation()
+    {
+        throw FATALERROR("Point-to-point message function called in single-process environment");
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void ProcessManager::postMessage(int rank, vector<double>&& data)
+{
+#ifdef BUILD_WITH_MPI
+    if (!isMultiProc()) throwInvalidMessageInvocation();
+    if (data.size() > maxMessageSize) throw FATALERROR("Point-to-point message is too large");
+
+    releaseDeliveredMessages();
+    postedMessages.emplace_back(MPI_REQUEST_NULL, std::move(data));
+    auto& message = postedMessages.back();
+    MPI_Isend(message.second.data(), message.second.size(), MPI_DOUBLE, rank, messageTag, MPI_COMM_WORLD,
+              &message.first);
+#else
+    (void)rank;
+    (void)data;
+    throwInvalidMessageInvocation();
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool ProcessManager::receiveMessage(vector<double>& data, bool wait)
+{
+#ifdef BUILD_WITH_MPI
+    if (!isMultiProc()) throwInvalidMessageInvocation();
+
+    // probe for a message, avoiding the use of CPU while waiting
+    MPI_Status status;
+    while (true)
+    {
+        int flag;
+        MPI_Iprobe(MPI_ANY_SOURCE, messageTag, MPI_COMM_WORLD, &flag, &status);
+        if (flag) break;
+        if (!wait) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    int count;
+    MPI_Get_count(&status, MPI_DOUBLE, &count);
+    data.resize(count);
+    MPI_Recv(data.data(), count, MPI_DOUBLE, status.MPI_SOURCE, messageTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    return true;
+#else
+    (void)data;
+    (void)wait;
+    throwInvalidMessageInvocation();
+    return false;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void ProcessManager::completeMessages()
+{
+#ifdef BUILD_WITH_MPI
+    for (auto& message : postedMessages) MPI_Wait(&message.first, MPI_STATUS_IGNORE);
+    postedMessages.clear();
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+
 void ProcessManager::wait()
 {
 #ifdef BUILD_WITH_MPI
@@ -184,6 +337,31 @@ void ProcessManager::sumToAll(Array& arr)
 
 //////////////////////////////////////////////////////////////////////
 
+void ProcessManager::sumToAll(vector<float>& v)
+{
+#ifdef BUILD_WITH_MPI
+    if (isMultiProc())
+    {
+        float* data = v.data();
+        size_t remaining = v.size();
+        while (remaining > maxMessageSize)
+        {
+            MPI_Allreduce(MPI_IN_PLACE, data, maxMessageSize, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+            data += maxMessageSize;
+            remaining -= maxMessageSize;
+        }
+        if (remaining)
+        {
+            MPI_Allreduce(MPI_IN_PLACE, data, remaining, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+        }
+    }
+#else
+    (void)v;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+
 void ProcessManager::sumToRoot(Array& arr)
 {
 #ifdef BUILD_WITH_MPI
@@ -92,6 +92,25 @@ public:
         function is invoked from the root process, a fatal error is thrown. */
     static bool requestChunk(size_t& firstIndex, size_t& numIndices);
 
+    /** This function is part of the mechanism for dynamically allocating chunks of parallel
+        tasks across multiple processes. It posts a request for the next available chunk to the
+        root process and returns immediately, without waiting for a response. The response must be
+        retrieved through the completeChunkRequest() function before a new request can be posted,
+        so that there is at most one outstanding request per process. The caller can thus perform
+        the work for the current chunk while the request for the next chunk is in flight. If there
+        is only one process, or if the function is invoked from the root process, a fatal error is
+        thrown. */
+    static void postChunkRequest();
+
+    /** This function is part of the mechanism for dynamically allocating chunks of parallel
+        tasks across multiple processes. It waits for the response to the request previously
+        posted by the postChunkRequest() function. When successful, the function places a chunk
+        index range in its arguments and returns true. If no more chunks are available, the
+        function returns false (and the output arguments are both set to zero). If there is only
+        one process, if the function is invoked from the root process, or if there is no
+        outstanding request, a fatal error is thrown. */
+    static bool completeChunkRequest(size_t& firstIndex, size_t& numIndices);
+
     /** This function is part of the mechanism for dynamically allocating chunks of parallel
         tasks across multiple processes. It waits for a chunk request from any of the processes in
         the MPI group and returns the rank of the requesting process. If there is only one process,
@@ -106,6 +125,32 @@ public:
         fatal error is thrown. */
     static void serveChunkRequest(int rank, size_t firstIndex, size_t numIndices);
 
+    //======== Point-to-point Communication  ===========
+
+    /** This function is part of the mechanism for sending messages holding a sequence of floating
+        point values from one process to another, without requiring the processes to synchronize.
+        It posts a nonblocking send of the specified data to the process with the specified rank and
+        returns immediately. The function takes ownership of the data and releases it after the
+        message has been delivered. The receiving process must retrieve the message through the
+        receiveMessage() function. The message size is limited to about 250 million values. If
+        there is only one process, a fatal error is thrown. */
+    static void postMessage(int rank, vector<double>&& data);
+
+    /** This function is part of the mechanism for sending messages holding a sequence of floating
+        point values from one process to another. If a message posted by another process through
+        the postMessage() function is available, the function stores its contents in the specified
+        vector and returns true. If no message is available and the \em wait flag is false, the
+        function returns false immediately; if the \em wait flag is true, the function waits until
+        a message arrives. Messages from a given process are received in the order in which they
+        were posted. If there is only one process, a fatal error is thrown. */
+    static bool receiveMessage(vector<double>& data, bool wait);
+
+    /** This function is part of the mechanism for sending messages holding a sequence of floating
+        point values from one process to another. It waits until all messages posted by the calling
+        process have been delivered and releases the corresponding data. If there is only one
+        process, the function does nothing. */
+    static void completeMessages();
+
     //======== Collective Communication  ===========
 
     /** This function causes the calling process to block until all other processes have invoked it
@@ -119,6 +164,12 @@ public:
         nothing. */
     static void sumToAll(Array& arr);
 
+    /** This function adds the single-precision floating point values of a vector element-wise
+        across the different processes, and stores the resulting sums in the same vector on each
+        individual process. Apart from the element type, it behaves just like the sumToAll(Array&)
+        function. */
+    static void sumToAll(vector<float>& v);
+
     /** This function adds the floating point values of an array element-wise across the different
         processes. The resulting sums are then stored in the same Array passed to this function on
         the root process. The arrays on the other processes are left untouched. All processes must
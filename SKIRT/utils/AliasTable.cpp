@@ -0,0 +1,45 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#include "AliasTable.hpp"
+
+//////////////////////////////////////////////////////////////////////
+
+void AliasTable::initialize(const Array& Pv)
+{
+    int n = Pv.size() - 1;
+    _entries.resize(n);
+
+    // scale the bin probabilities so that their average is one, and split the bins into two work lists
+    double norm = n / (Pv[n] - Pv[0]);
+    vector<double> qv(n);
+    vector<int> small, large;
+    for (int i = 0; i != n; ++i)
+    {
+        qv[i] = (Pv[i + 1] - Pv[i]) * norm;
+        (qv[i] < 1. ? small : large).push_back(i);
+    }
+
+    // repeatedly fill up a small bin with the excess probability of a large bin
+    while (!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        _entries[s] = {qv[s], l};
+        qv[l] -= 1. - qv[s];
+        if (qv[l] < 1.)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // the remaining bins have a probability of one up to rounding errors, so they never need an alias
+    for (int i : large) _entries[i] = {1., i};
+    for (int i : small) _entries[i] = {1., i};
+}
+
+//////////////////////////////////////////////////////////////////////
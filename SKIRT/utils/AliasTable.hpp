@@ -0,0 +1,76 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#ifndef ALIASTABLE_HPP
+#define ALIASTABLE_HPP
+
+#include "Array.hpp"
+
+//////////////////////////////////////////////////////////////////////
+
+/** AliasTable is a low-level class for selecting a bin from a discrete probability distribution
+    in constant time, using the alias method of Walker (1977) with the construction procedure
+    described by Vose (1991). This is faster than locating the bin in the cumulative distribution
+    through a binary search, especially for distributions with many bins, at the cost of some
+    additional memory and an initialization procedure proportional to the number of bins.
+
+    The table is constructed from a normalized cumulative distribution \f$P_i\f$ with
+    \f$i=0,\ldots,n\f$, \f$P_0=0\f$ and \f$P_n=1\f$, such as produced by the NR::cdf() functions,
+    so that bin \f$i\f$ has probability \f$P_{i+1}-P_i\f$. For each bin \f$i\f$, the table holds
+    a threshold \f$q_i\f$ and an alias index \f$a_i\f$. Given a uniform deviate \f$X\f$, the
+    sample() function determines the bin \f$i=\lfloor nX \rfloor\f$ and the fraction
+    \f$f=nX-i\f$, and returns bin \f$i\f$ if \f$f<q_i\f$ or bin \f$a_i\f$ otherwise. The fraction
+    is rescaled to a new uniform deviate that can be used to locate a position inside the
+    selected bin, so that a single random number suffices to sample a piecewise continuous
+    distribution. */
+class AliasTable
+{
+public:
+    /** The default constructor creates an empty table. */
+    AliasTable() {}
+
+    /** This function initializes the table for the specified normalized cumulative distribution,
+        which must have at least two entries. Any previous contents is discarded. */
+    void initialize(const Array& Pv);
+
+    /** This function returns true if the table has not been initialized. */
+    bool empty() const { return _entries.empty(); }
+
+    /** This function returns the approximate number of bytes occupied by the table contents. */
+    size_t bytes() const { return _entries.size() * sizeof(Entry); }
+
+    /** This function returns the index of a bin selected according to the distribution
+        represented by the table, given a uniform deviate \em X in the interval [0,1]. It also
+        stores a new uniform deviate in \em t, which can be used for locating a position inside the
+        selected bin. */
+    int sample(double X, double& t) const
+    {
+        int n = _entries.size();
+        double u = X * n;
+        int i = std::min(static_cast<int>(u), n - 1);
+        double f = u - i;
+        const Entry& entry = _entries[i];
+        if (f < entry.threshold)
+        {
+            t = f / entry.threshold;
+            return i;
+        }
+        t = (f - entry.threshold) / (1. - entry.threshold);
+        return entry.alias;
+    }
+
+private:
+    // the threshold and alias index for a bin, stored together so that sampling touches a single location
+    struct Entry
+    {
+        double threshold;
+        int alias;
+    };
+    vector<Entry> _entries;
+};
+
+//////////////////////////////////////////////////////////////////////
+
+#endif
@@ -13,9 +13,12 @@ ChunkMaker::ChunkMaker() {}
 
 void ChunkMaker::initialize(size_t maxIndex, int numThreads, int numProcs)
 {
-    // Determine the chunk size
-    const size_t numChunksPerThread = 8;  // empirical multiplicator to achieve acceptable load balancing
-    _chunkSize = max(static_cast<size_t>(1), maxIndex / (numThreads * numProcs * numChunksPerThread));
+    // Determine the parameters of the guided chunk sizes
+    const size_t numChunksPerThread = 8;     // empirical multiplicator to achieve acceptable load balancing
+    const size_t smallChunksPerThread = 64;  // empirical divisor determining the minimum chunk size
+    size_t numWorkers = numThreads * numProcs;
+    _divisor = numWorkers * numChunksPerThread;
+    _minChunkSize = max(static_cast<size_t>(1), maxIndex / (numWorkers * smallChunksPerThread));
 
     // Initialize the other data members
     _maxIndex = maxIndex;
@@ -26,12 +29,17 @@ void ChunkMaker::initialize(size_t maxIndex, int numThreads, int numProcs)
 
 bool ChunkMaker::next(size_t& firstIndex, size_t& numIndices)
 {
-    size_t first = _nextIndex.fetch_add(_chunkSize);
-    if (first < _maxIndex)
+    size_t first = _nextIndex.load();
+    while (first < _maxIndex)
     {
-        firstIndex = first;
-        numIndices = min(_chunkSize, _maxIndex - first);
-        return true;
+        size_t remaining = _maxIndex - first;
+        size_t size = min(remaining, max(_minChunkSize, remaining / _divisor));
+        if (_nextIndex.compare_exchange_weak(first, first + size))
+        {
+            firstIndex = first;
+            numIndices = size;
+            return true;
+        }
     }
     return false;
 }
@@ -40,10 +48,10 @@ bool ChunkMaker::next(size_t& firstIndex, size_t& numIndices)
 
 bool ChunkMaker::callForNext(const std::function<void(size_t, size_t)>& target)
 {
-    size_t first = _nextIndex.fetch_add(_chunkSize);
-    if (first < _maxIndex)
+    size_t firstIndex, numIndices;
+    if (next(firstIndex, numIndices))
     {
-        target(first, min(_chunkSize, _maxIndex - first));
+        target(firstIndex, numIndices);
         return true;
     }
     return false;
@@ -20,7 +20,14 @@
     chunk and the number of indices in the chunk, and it is expected to iterate over the specified
     index range. The chunk sizes are determined by the heuristic in the ChunkMaker object to
     achieve optimal load balancing given the available parallel resources, while still maximally
-    reducing the overhead of handing out the chunks. */
+    reducing the overhead of handing out the chunks.
+
+    Because the cost of the tasks may vary substantially (e.g., some photon packets scatter many
+    more times than others), the chunk maker uses \em guided scheduling: the size of each chunk is
+    proportional to the number of indices that have not yet been handed out, so that the chunks
+    become gradually smaller towards the end of the range, with a lower limit to avoid excessive
+    overhead. As a result, the execution threads and/or processes tend to finish at approximately
+    the same time even when the cost of the tasks varies. */
 class ChunkMaker
 {
 public:
@@ -48,7 +55,8 @@ public:
     bool callForNext(const std::function<void(size_t firstIndex, size_t numIndices)>& target);
 
 private:
-    size_t _chunkSize{0};               // the number of indices in all but the last chunk
+    size_t _divisor{1};                 // the number of remaining indices is divided by this value
+    size_t _minChunkSize{1};            // the minimum number of indices in a chunk (except the last one)
     size_t _maxIndex{0};                // the maximum index (i.e. limiting the last chunk)
     std::atomic<size_t> _nextIndex{0};  // the first index of the next available chunk
 };
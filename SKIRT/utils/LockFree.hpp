@@ -35,6 +35,17 @@ namespace LockFree
         {
         }
     }
+
+    /** This function adds the specified float value to the specified target variable in a
+        thread-safe manner, using the same mechanism as the function for double values. */
+    inline void add(float& target, float value)
+    {
+        std::atomic<float>* atom = new (&target) std::atomic<float>;
+        float old = *atom;
+        while (!atom->compare_exchange_weak(old, old + value))
+        {
+        }
+    }
 }
 
 ////////////////////////////////////////////////////////////////////
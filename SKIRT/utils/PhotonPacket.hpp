@@ -238,6 +238,34 @@ public:
         direction can avoid recalculating the optical depth. */
     double observedOpticalDepth() const { return _observedOpticalDepth; }
 
+    // ------- Caching material wavelength indices -------
+
+    /** This function returns true if material wavelength indices have been stored for the current
+        wavelength of the photon packet through the storeMaterialIndices() function, and false
+        otherwise. Because the indices depend only on the wavelength, they remain valid until the
+        wavelength of the packet changes, even across launches. */
+    bool hasMaterialIndices() const { return _materialIndexWavelength == _lambda; }
+
+    /** If hasMaterialIndices() returns true, this function returns a pointer to the material
+        wavelength indices stored for the current wavelength of the photon packet. Otherwise, the
+        returned pointer is meaningless. */
+    const int* materialIndices() const { return _materialIndexv.data(); }
+
+    /** This function marks the material wavelength indices as valid for the current wavelength of
+        the photon packet, and returns a pointer to storage for the specified number of indices, so
+        that the caller can fill in the values. This capability is offered so that the wavelength
+        of a photon packet needs to be looked up in the wavelength grid of each material mix only
+        once, rather than for every path segment or interaction. The meaning of the indices is
+        determined by the caller (see MediumSystem::wavelengthIndices()). Because the indices
+        represent cached information rather than physical state, they can be stored in a const
+        photon packet. */
+    int* storeMaterialIndices(size_t numIndices) const
+    {
+        _materialIndexv.resize(numIndices);
+        _materialIndexWavelength = _lambda;
+        return _materialIndexv.data();
+    }
+
     // ------- Data members -------
 
 private:
@@ -262,6 +290,10 @@ private:
     // observed optical depth
     double _observedOpticalDepth{0.};      // optical depth calculated for peel-off to an instrument
     bool _hasObservedOpticalDepth{false};  // true if the above field holds a valid value for this packet
+
+    // cached material wavelength indices
+    mutable vector<int> _materialIndexv;          // index of the wavelength in the grid of each material mix
+    mutable double _materialIndexWavelength{-1.};  // the wavelength for which the above indices are valid
 };
 
 ////////////////////////////////////////////////////////////////////
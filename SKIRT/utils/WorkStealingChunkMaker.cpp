@@ -0,0 +1,105 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#include "WorkStealingChunkMaker.hpp"
+
+//////////////////////////////////////////////////////////////////////
+
+WorkStealingChunkMaker::WorkStealingChunkMaker() {}
+
+//////////////////////////////////////////////////////////////////////
+
+void WorkStealingChunkMaker::initialize(size_t maxIndex, int numThreads)
+{
+    // Determine the parameters of the guided chunk sizes (see also ChunkMaker)
+    const size_t numChunksPerThread = 8;     // empirical multiplicator to achieve acceptable load balancing
+    const size_t smallChunksPerThread = 64;  // empirical divisor determining the minimum chunk size
+    _divisor = numChunksPerThread;
+    _minChunkSize = max(static_cast<size_t>(1), maxIndex / (numThreads * smallChunksPerThread));
+
+    // Allocate the parts if needed
+    if (numThreads != _numThreads)
+    {
+        _numThreads = numThreads;
+        _partv.reset(new Part[numThreads]);
+    }
+
+    // Divide the range in equal parts
+    for (int t = 0; t != numThreads; ++t)
+    {
+        _partv[t].begin = maxIndex * t / numThreads;
+        _partv[t].end = maxIndex * (t + 1) / numThreads;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool WorkStealingChunkMaker::next(int threadIndex, size_t& firstIndex, size_t& numIndices)
+{
+    Part& part = _partv[threadIndex];
+    while (true)
+    {
+        // take a chunk from the front of our own part, if possible
+        {
+            std::unique_lock<std::mutex> lock(part.mutex);
+            if (part.begin < part.end)
+            {
+                size_t remaining = part.end - part.begin;
+                size_t size = min(remaining, max(_minChunkSize, remaining / _divisor));
+                firstIndex = part.begin;
+                numIndices = size;
+                part.begin += size;
+                return true;
+            }
+        }
+
+        // otherwise, steal some work from another thread and try again
+        if (!steal(threadIndex)) return false;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool WorkStealingChunkMaker::callForNext(int threadIndex, const std::function<void(size_t, size_t)>& target)
+{
+    size_t firstIndex, numIndices;
+    if (next(threadIndex, firstIndex, numIndices))
+    {
+        target(firstIndex, numIndices);
+        return true;
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool WorkStealingChunkMaker::steal(int threadIndex)
+{
+    // visit the other threads in a fixed order starting with our neighbor, so that thieves spread out
+    for (int offset = 1; offset < _numThreads; ++offset)
+    {
+        // remove the back half of the remaining range from the victim, if any
+        Part& victim = _partv[(threadIndex + offset) % _numThreads];
+        size_t begin, end;
+        {
+            std::unique_lock<std::mutex> lock(victim.mutex);
+            size_t remaining = victim.end - victim.begin;
+            if (!remaining) continue;
+            end = victim.end;
+            begin = end - (remaining - remaining / 2);
+            victim.end = begin;
+        }
+
+        // assign the stolen range to our own (empty) part
+        Part& part = _partv[threadIndex];
+        std::unique_lock<std::mutex> lock(part.mutex);
+        part.begin = begin;
+        part.end = end;
+        return true;
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////
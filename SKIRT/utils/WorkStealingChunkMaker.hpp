@@ -0,0 +1,80 @@
+/*//////////////////////////////////////////////////////////////////
+////     The SKIRT project -- advanced radiative transfer       ////
+////       © Astronomical Observatory, Ghent University         ////
+///////////////////////////////////////////////////////////////// */
+
+#ifndef WORKSTEALINGCHUNKMAKER_HPP
+#define WORKSTEALINGCHUNKMAKER_HPP
+
+#include "Basics.hpp"
+#include <functional>
+#include <mutex>
+
+//////////////////////////////////////////////////////////////////////
+
+/** The WorkStealingChunkMaker class chops a range of indices from zero to \f$N-1\f$ into smaller
+    ranges of consecutive indices called \em chunks, much like the ChunkMaker class, but it is
+    specialized for distributing tasks over the execution threads in a single process.
+
+    Rather than handing out all chunks from a single shared counter, the index range is initially
+    divided into equal contiguous parts, one for each thread. Each thread takes chunks from the
+    front of its own part, using guided chunk sizes that are proportional to the number of indices
+    remaining in the part, so that the chunks become gradually smaller as the part is depleted.
+    When a thread runs out of work, it steals the back half of the remaining indices from another
+    thread that still has work, and continues with those. The threads thus rarely contend for the
+    same memory locations, and all threads remain busy until nearly the end of the range, even
+    when the cost of the tasks varies by orders of magnitude.
+
+    The part of each thread is protected by its own mutex. Because a lock is acquired only once per
+    chunk, and because thieves are relatively rare, the locking overhead is negligible. */
+class WorkStealingChunkMaker
+{
+public:
+    /** The default constructor initializes the WorkStealingChunkMaker object to an empty range. */
+    WorkStealingChunkMaker();
+
+    /** This function initializes the WorkStealingChunkMaker object to the specified range (from
+        zero to \f$N-1\f$), dividing it over the specified number of threads. It should not be
+        called while other threads are retrieving chunks. */
+    void initialize(size_t maxIndex, int numThreads);
+
+    /** This function gets the next chunk for the thread with the specified index (in the range
+        from zero to the number of threads minus one), in the form of the first index and the
+        number of indices in the chunk. If a chunk is still available, either in the thread's own
+        part of the range or by stealing from another thread, the function places a chunk index
+        range in its arguments and returns true. If no more chunks are available, the output
+        arguments remain unchanged and the function returns false. The function can safely be
+        called from multiple concurrent execution threads, as long as each thread specifies a
+        different thread index. */
+    bool next(int threadIndex, size_t& firstIndex, size_t& numIndices);
+
+    /** This function gets the next chunk for the thread with the specified index as described for
+        the next() function, and if one is available, it calls the specified target with the
+        corresponding first index and number of indices, and returns true. If no more chunks are
+        available, the target is not invoked and this function returns false. */
+    bool callForNext(int threadIndex, const std::function<void(size_t firstIndex, size_t numIndices)>& target);
+
+private:
+    /** This function moves the back half of the remaining range of another thread, if any, to the
+        empty range of the specified thread, and returns true. If no other thread has remaining
+        work, the function returns false. */
+    bool steal(int threadIndex);
+
+    // the part of the index range currently assigned to a thread; padded to avoid false sharing
+    struct Part
+    {
+        std::mutex mutex;
+        size_t begin{0};
+        size_t end{0};
+        char padding[64];
+    };
+
+    int _numThreads{0};              // the number of threads
+    size_t _divisor{1};              // the number of indices remaining in a part is divided by this value
+    size_t _minChunkSize{1};         // the minimum number of indices in a chunk (except the last one)
+    std::unique_ptr<Part[]> _partv;  // the part for each thread
+};
+
+//////////////////////////////////////////////////////////////////////
+
+#endif